@@ -0,0 +1,155 @@
+// load_api_keys 基准测试：对比逐行正则实现与内存映射+向量化扫描实现
+// 用法: load-keys-bench [文件大小MB=1024] [文件路径=bench_keys.txt]
+#include "file_utils.h"
+#include "key_scanner.h"
+#include "mapped_file.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace api_checker;
+
+namespace {
+
+// 原始实现：整体读入、getline分行、逐行 regex_search，只支持旧的 sk- 格式
+std::vector<std::string> load_api_keys_regex(const std::string& file_path) {
+    std::vector<std::string> keys;
+
+    auto content = FileUtils::read_file(file_path);
+    if (!content) {
+        return keys;
+    }
+
+    std::istringstream stream(*content);
+    std::string line;
+    std::regex sk_pattern(R"(sk-[a-zA-Z0-9]{48,})");
+
+    while (std::getline(stream, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::smatch match;
+        if (std::regex_search(line, match, sk_pattern)) {
+            keys.push_back(match.str());
+        }
+    }
+
+    return keys;
+}
+
+// 生成混合内容的测试文件：有效key、注释、过短key、带噪声的行、CRLF和空行
+// 只包含旧的 sk- 格式且每行至多一个key，多格式扫描器的结果应与正则实现一致
+void generate_file(const std::string& path, size_t target_bytes) {
+    static const char alnum[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::mt19937_64 rng(42);
+    std::ofstream out(path, std::ios::binary);
+
+    auto random_body = [&](size_t len) {
+        std::string s;
+        s.reserve(len);
+        for (size_t i = 0; i < len; ++i) {
+            s.push_back(alnum[rng() % (sizeof(alnum) - 1)]);
+        }
+        return s;
+    };
+
+    size_t written = 0;
+    std::string line;
+    while (written < target_bytes) {
+        switch (rng() % 10) {
+            case 0:
+                line = "# sk-" + random_body(50) + "\n";
+                break;
+            case 1:
+                line = "sk-" + random_body(20 + rng() % 20) + "\n";
+                break;
+            case 2:
+                line = "key=" + random_body(8) + " sk-" + random_body(48 + rng() % 20) + " tail\r\n";
+                break;
+            case 3:
+                line = "\n";
+                break;
+            case 4:
+                line = "  \tsk-" + random_body(10) + "-sk-" + random_body(56) + "\n";
+                break;
+            default:
+                line = "sk-" + random_body(48 + rng() % 16) + "\n";
+                break;
+        }
+        out << line;
+        written += line.size();
+    }
+}
+
+template <typename Fn>
+double time_secs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    std::string path = argc > 2 ? argv[2] : "bench_keys.txt";
+    size_t target_bytes = size_mb << 20;
+
+    auto existing = FileUtils::get_file_size(path);
+    if (!existing || *existing < target_bytes) {
+        std::cout << "生成测试文件 " << path << " (" << size_mb << " MB)..." << std::endl;
+        generate_file(path, target_bytes);
+    }
+    double file_mb = static_cast<double>(*FileUtils::get_file_size(path)) / (1 << 20);
+
+    std::cout << "扫描器指令集: " << KeyScanner::simd_backend() << std::endl;
+
+    std::vector<std::string> regex_keys, mapped_keys, streamed_keys, chunked_keys;
+    double regex_secs = time_secs([&] { regex_keys = load_api_keys_regex(path); });
+    double mapped_secs = time_secs([&] { mapped_keys = FileUtils::load_api_keys(path); });
+    double streamed_secs = time_secs([&] {
+        FileUtils::for_each_api_key(path, [&](std::string key) {
+            streamed_keys.push_back(std::move(key));
+            return true;
+        });
+    });
+
+    // 固定8个分块，在核心数较少的机器上也能校验分块拼接的正确性
+    double chunked_secs = time_secs([&] {
+        MappedFile mapped;
+        if (mapped.open(path)) {
+            KeyScanner::scan_parallel(mapped.view(), chunked_keys, 8);
+        }
+    });
+
+    auto report = [&](const char* name, double secs, size_t count) {
+        std::cout << name << ": " << secs << " 秒, " << file_mb / secs << " MB/s, "
+                  << count << " 个key" << std::endl;
+    };
+    report("regex   ", regex_secs, regex_keys.size());
+    report("mmap    ", mapped_secs, mapped_keys.size());
+    report("stream  ", streamed_secs, streamed_keys.size());
+    report("chunk x8", chunked_secs, chunked_keys.size());
+    std::cout << "加速比: " << regex_secs / mapped_secs << "x" << std::endl;
+
+    if (mapped_keys != regex_keys || streamed_keys != regex_keys || chunked_keys != regex_keys) {
+        std::cerr << "❌ 结果不一致" << std::endl;
+        return 1;
+    }
+
+    std::cout << "✅ 结果一致" << std::endl;
+    return 0;
+}
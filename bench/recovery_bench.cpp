@@ -0,0 +1,220 @@
+// 崩溃恢复基准测试：对比旧版JSON进度文件与进度日志在崩溃后的恢复耗时，
+// 以及不同成组提交策略下的写入吞吐
+// 用法: recovery-bench [key数量=1000000] [工作目录=bench_recovery]
+#include "api_checker.h"
+#include "completion_bitmap.h"
+#include "file_utils.h"
+#include "progress_journal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace api_checker;
+
+namespace {
+
+std::vector<std::string> generate_keys(size_t count) {
+    static const char alnum[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::mt19937_64 rng(42);
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string key = "sk-";
+        for (int j = 0; j < 48; ++j) {
+            key.push_back(alnum[rng() % (sizeof(alnum) - 1)]);
+        }
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+KeyResult make_result(const std::string& key, size_t i) {
+    KeyResult result;
+    result.key = key;
+    result.status = i % 7 == 0 ? KeyStatus::Valid : KeyStatus::Invalid;
+    result.message_code = i % 7 == 0 ? MessageCode::Valid : MessageCode::AuthFailed;
+    result.http_status = i % 7 == 0 ? 200 : 401;
+    result.message = KeyResult::describe(result.message_code, result.http_status);
+    result.response_time = std::chrono::milliseconds(50 + static_cast<int64_t>(i % 100));
+    result.checked_at = std::chrono::system_clock::now();
+    return result;
+}
+
+// 模拟崩溃时写了一半的文件末尾
+void append_garbage(const std::string& path, size_t bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    std::string garbage(bytes, '\x5a');
+    std::fwrite(garbage.data(), 1, garbage.size(), file);
+    std::fclose(file);
+}
+
+template <typename Fn>
+double time_secs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+double file_mb(const std::string& path) {
+    return static_cast<double>(FileUtils::get_file_size(path).value_or(0)) / (1 << 20);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t key_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string dir = argc > 2 ? argv[2] : "bench_recovery";
+    std::filesystem::create_directories(dir);
+
+    // 90% 的key已完成，其中最后1%在日志中重复出现（重试后的结果）
+    auto keys = generate_keys(key_count);
+    size_t completed = key_count / 10 * 9;
+    std::cout << "key数量: " << key_count << ", 已完成: " << completed << std::endl;
+
+    // 旧版JSON：每次保存整体重写，崩溃时文件被截断后无法恢复
+    std::string json_path = dir + "/progress_legacy.json";
+    {
+        CheckProgress progress;
+        progress.session_id = "session_bench";
+        progress.input_file = "bench_keys.txt";
+        progress.all_keys = keys;
+        for (size_t i = 0; i < completed; ++i) {
+            progress.completed_results.push_back(make_result(keys[i], i));
+        }
+        progress.last_save_time = std::chrono::system_clock::now();
+        FileUtils::write_file(json_path, progress.to_json().dump(2));
+    }
+
+    size_t json_completed = 0;
+    double json_secs = time_secs([&] {
+        if (auto progress = APIKeyChecker::load_progress(json_path)) {
+            json_completed = progress->completed_results.size();
+        }
+    });
+    std::cout << "JSON      : " << json_secs << " 秒, " << file_mb(json_path) << " MB, 恢复 "
+              << json_completed << " 条" << std::endl;
+
+    std::filesystem::resize_file(json_path, std::filesystem::file_size(json_path) / 2);
+    bool torn_json_ok = APIKeyChecker::load_progress(json_path).has_value();
+    std::cout << "JSON写了一半: " << (torn_json_ok ? "可以恢复" : "无法恢复，全部进度丢失") << std::endl;
+
+    // 进度日志：只追加，崩溃后丢弃末尾半条记录
+    std::string journal_path = dir + "/progress_bench.journal";
+    JournalHeader header;
+    header.session_id = "session_bench";
+    header.input_file = "bench_keys.txt";
+    header.keys = keys;
+    header.key_count = keys.size();
+    header.fingerprint = ProgressJournal::fingerprint(keys);
+    header.created_at = std::chrono::system_clock::now();
+    {
+        JournalOptions options;
+        options.sync = false;
+        ProgressJournal journal;
+        journal.create(journal_path, header, options);
+        for (size_t i = 0; i < completed; ++i) {
+            journal.append(JournalRecord::from_result(static_cast<uint32_t>(i), make_result(keys[i], i)));
+        }
+        for (size_t i = completed - completed / 100; i < completed; ++i) {
+            journal.append(JournalRecord::from_result(static_cast<uint32_t>(i), make_result(keys[i], i)));
+        }
+    }
+    append_garbage(journal_path, 13);
+
+    // 恢复流程：截掉残缺记录、压缩去重、回放日志并重建完成位图
+    size_t journal_completed = 0;
+    size_t pending = 0;
+    double open_secs = time_secs([&] {
+        ProgressJournal journal;
+        journal.open(journal_path);
+    });
+    double compact_secs = time_secs([&] { ProgressJournal::compact(journal_path); });
+    double replay_secs = time_secs([&] {
+        auto state = ProgressJournal::replay(journal_path);
+        if (!state) {
+            return;
+        }
+        CompletionBitmap bitmap(state->header.keys.size());
+        for (const auto& record : state->records) {
+            bitmap.set(record.ordinal);
+        }
+        journal_completed = bitmap.count();
+        pending = bitmap.unset_positions().size();
+    });
+    std::cout << "日志      : 截断 " << open_secs << " 秒 + 压缩 " << compact_secs << " 秒 + 回放 "
+              << replay_secs << " 秒, " << file_mb(journal_path) << " MB, 恢复 " << journal_completed
+              << " 条, 待处理 " << pending << " 条" << std::endl;
+
+    // 有位图侧文件时只回放其后追加的记录
+    {
+        auto state = ProgressJournal::replay(journal_path, false);
+        CompletionSidecar sidecar;
+        sidecar.bitmap.resize(key_count);
+        for (const auto& record : state->records) {
+            sidecar.bitmap.set(record.ordinal);
+        }
+        sidecar.fingerprint = header.fingerprint;
+        sidecar.journal_bytes = std::filesystem::file_size(journal_path);
+        sidecar.save(ProgressJournal::sidecar_path(journal_path));
+    }
+    size_t sidecar_completed = 0;
+    double sidecar_secs = time_secs([&] {
+        auto sidecar = CompletionSidecar::load(ProgressJournal::sidecar_path(journal_path));
+        auto state = ProgressJournal::replay(journal_path, true, sidecar ? sidecar->journal_bytes : 0);
+        if (!sidecar || !state) {
+            return;
+        }
+        for (const auto& record : state->records) {
+            sidecar->bitmap.set(record.ordinal);
+        }
+        sidecar_completed = sidecar->bitmap.count();
+    });
+    std::cout << "日志+位图 : " << sidecar_secs << " 秒, 恢复 " << sidecar_completed << " 条" << std::endl;
+    std::cout << "恢复加速比: " << json_secs / (open_secs + compact_secs + replay_secs) << "x (无位图), "
+              << json_secs / sidecar_secs << "x (有位图)" << std::endl;
+
+    // 成组提交策略：每条记录同步一次与默认策略的写入吞吐
+    auto bench_policy = [&](const char* name, size_t records, JournalOptions options) {
+        std::string path = dir + "/progress_policy.journal";
+        JournalHeader small = header;
+        small.keys.assign(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(records));
+        small.key_count = records;
+        small.fingerprint = ProgressJournal::fingerprint(small.keys);
+
+        double secs = time_secs([&] {
+            ProgressJournal journal;
+            journal.create(path, small, options);
+            for (size_t i = 0; i < records; ++i) {
+                journal.append(JournalRecord::from_result(static_cast<uint32_t>(i), make_result(keys[i], i)));
+                if (options.group_commit_records == 1) {
+                    journal.commit();
+                }
+            }
+        });
+        std::cout << name << ": " << records << " 条, " << secs << " 秒, "
+                  << static_cast<double>(records) / secs << " 条/秒" << std::endl;
+        std::filesystem::remove(path);
+    };
+
+    JournalOptions per_record;
+    per_record.group_commit_records = 1;
+    per_record.min_sync_interval = std::chrono::milliseconds(0);
+    bench_policy("逐条同步  ", std::min<size_t>(key_count, 2000), per_record);
+    bench_policy("成组提交  ", std::min<size_t>(key_count, 200000), JournalOptions{});
+
+    if (journal_completed != completed || sidecar_completed != completed ||
+        json_completed != completed) {
+        std::cerr << "❌ 恢复结果不一致" << std::endl;
+        return 1;
+    }
+
+    std::cout << "✅ 恢复结果一致" << std::endl;
+    return 0;
+}
@@ -0,0 +1,447 @@
+// 命令行版本：从文件或stdin流式读取key，检测结果以NDJSON逐行写到stdout
+// 提示信息和统计写到stderr，便于在管道中使用，例如:
+//   cat keys.txt | api-checker-cli --only-valid | jq -r .key
+#include "check_session.h"
+#include "config_manager.h"
+#include "file_utils.h"
+#include "key_scanner.h"
+#include "progress_index.h"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace api_checker;
+
+namespace {
+
+constexpr size_t STDIN_CHUNK = 1 << 20;
+
+struct CliOptions {
+    std::vector<std::string> inputs;  // 文件路径，"-" 表示stdin
+    std::string directory;
+    std::string follow;
+    std::string config_file;
+    std::string store_file;
+    size_t concurrent = 0;
+    size_t timeout = 0;
+    size_t connect_timeout = 0;
+    size_t capacity = APIKeyChecker::DEFAULT_CHANNEL_CAPACITY;
+    bool only_valid = false;
+    bool merge_progress = false;
+    bool quiet = false;
+};
+
+std::atomic<CheckSession*> g_session{nullptr};
+std::atomic<bool> g_interrupted{false};
+
+#ifndef _WIN32
+// 信号处理函数写入的自管道：读取stdin时同时等待它，stdin没有数据时中断也能立即结束读取
+int g_signal_pipe[2] = {-1, -1};
+
+void open_signal_pipe() {
+    if (::pipe(g_signal_pipe) != 0) {
+        g_signal_pipe[0] = g_signal_pipe[1] = -1;
+        return;
+    }
+    for (int fd : g_signal_pipe) {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+#endif
+
+void handle_signal(int sig) {
+    // 第一次中断时停止检测并输出已有结果，再次中断直接退出
+    g_interrupted.store(true);
+    if (auto* session = g_session.load()) {
+        session->stop();
+    }
+#ifndef _WIN32
+    if (g_signal_pipe[1] >= 0) {
+        const char byte = 1;
+        ssize_t written = ::write(g_signal_pipe[1], &byte, 1);
+        (void)written;
+    }
+#endif
+    std::signal(sig, SIG_DFL);
+}
+
+void print_usage(const char* program) {
+    std::cerr << "用法: " << program << " [选项] [文件...]\n"
+              << "\n"
+              << "从文件或标准输入读取API Keys，检测结果以NDJSON（每行一个JSON）写到标准输出。\n"
+              << "未指定文件时读取标准输入，文件名 - 也表示标准输入。\n"
+              << "\n"
+              << "选项:\n"
+              << "  -d, --dir <目录>          并行遍历目录提取key，结果带有 路径:行号 出处\n"
+              << "  -f, --follow <路径>       跟随文件或目录，持续检测新追加的key（Ctrl+C结束）\n"
+              << "  -c, --concurrent <数量>   并发数（默认取配置文件）\n"
+              << "  -t, --timeout <秒>        请求超时（默认取配置文件）\n"
+              << "      --connect-timeout <秒> 连接超时（默认取配置文件）\n"
+              << "      --capacity <数量>     待检测队列容量（默认 " << APIKeyChecker::DEFAULT_CHANNEL_CAPACITY << "）\n"
+              << "      --config <文件>       配置文件（默认 " << ConfigManager::get_default_config_path() << "，不存在时使用内置默认值）\n"
+              << "      --only-valid          只输出有效的key\n"
+              << "      --store <文件>        同时把全部结果写入列式结果文件（.apcr），可在图形界面中直接打开\n"
+              << "      --merge-progress      合并进度文件（文件参数为进度文件，不指定时合并当前目录中\n"
+              << "                            同一输入的全部进度文件），并按配置只保留最近的进度文件\n"
+              << "  -q, --quiet               不输出统计信息\n"
+              << "  -h, --help                显示帮助\n"
+              << "\n"
+              << "退出码: 0 完成, 1 运行错误, 2 参数错误\n";
+}
+
+std::optional<size_t> parse_count(const std::string& value) {
+    try {
+        size_t pos = 0;
+        unsigned long long n = std::stoull(value, &pos);
+        if (pos != value.size() || n == 0) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(n);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+// 解析命令行参数，出错时打印原因并返回空
+std::optional<CliOptions> parse_args(int argc, char* argv[], bool& show_help) {
+    CliOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        auto next_value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                std::cerr << "选项 " << arg << " 需要参数" << std::endl;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        auto next_count = [&](size_t& out) {
+            std::string value;
+            if (!next_value(value)) {
+                return false;
+            }
+            auto n = parse_count(value);
+            if (!n) {
+                std::cerr << "选项 " << arg << " 需要正整数: " << value << std::endl;
+                return false;
+            }
+            out = *n;
+            return true;
+        };
+
+        bool ok = true;
+        if (arg == "-h" || arg == "--help") {
+            show_help = true;
+            return options;
+        } else if (arg == "-d" || arg == "--dir") {
+            ok = next_value(options.directory);
+        } else if (arg == "-f" || arg == "--follow") {
+            ok = next_value(options.follow);
+        } else if (arg == "-c" || arg == "--concurrent") {
+            ok = next_count(options.concurrent);
+        } else if (arg == "-t" || arg == "--timeout") {
+            ok = next_count(options.timeout);
+        } else if (arg == "--connect-timeout") {
+            ok = next_count(options.connect_timeout);
+        } else if (arg == "--capacity") {
+            ok = next_count(options.capacity);
+        } else if (arg == "--config") {
+            ok = next_value(options.config_file);
+        } else if (arg == "--store") {
+            ok = next_value(options.store_file);
+        } else if (arg == "--only-valid") {
+            options.only_valid = true;
+        } else if (arg == "--merge-progress") {
+            options.merge_progress = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "未知选项: " << arg << std::endl;
+            ok = false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+
+        if (!ok) {
+            return std::nullopt;
+        }
+    }
+
+    if (options.merge_progress) {
+        if (!options.directory.empty() || !options.follow.empty()) {
+            std::cerr << "--merge-progress 不能与 --dir 或 --follow 同时使用" << std::endl;
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    int modes = (!options.directory.empty() ? 1 : 0) + (!options.follow.empty() ? 1 : 0) +
+                (!options.inputs.empty() ? 1 : 0);
+    if (modes > 1) {
+        std::cerr << "文件、--dir 和 --follow 只能选择一种输入方式" << std::endl;
+        return std::nullopt;
+    }
+    if (modes == 0) {
+        options.inputs.push_back("-");
+    }
+    return options;
+}
+
+// 返回读到的字节数，0表示输入结束，-1表示出错或收到中断
+long read_stdin(char* buffer, size_t size) {
+#ifdef _WIN32
+    return _read(0, buffer, static_cast<unsigned>(size));
+#else
+    // 信号处理函数可能在其他线程上执行，且signal()安装的处理函数会自动重启read，
+    // 所以不能依赖EINTR，先同时等待stdin和自管道
+    pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {g_signal_pipe[0], POLLIN, 0}};
+    const nfds_t nfds = g_signal_pipe[0] >= 0 ? 2 : 1;
+    while (true) {
+        if (g_interrupted.load()) {
+            return -1;
+        }
+        int ready = ::poll(fds, nfds, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (nfds == 2 && fds[1].revents != 0) {
+            return -1;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+    }
+
+    // 用read而不是fread：管道中有数据就返回，不必等缓冲区填满，上游边写这边边检测
+    ssize_t n;
+    do {
+        n = ::read(STDIN_FILENO, buffer, size);
+    } while (n < 0 && errno == EINTR && !g_interrupted.load());
+    return static_cast<long>(n);
+#endif
+}
+
+// 从stdin分块读取，只扫描以换行结尾的完整行，剩余部分留到下一块
+void produce_from_stdin(BoundedChannel<KeyItem>& channel) {
+#ifdef _WIN32
+    _setmode(0, _O_BINARY);
+#endif
+    std::string buffer;
+    std::vector<std::string> keys;
+    std::vector<char> chunk(STDIN_CHUNK);
+
+    auto flush_keys = [&]() {
+        for (auto& key : keys) {
+            if (!channel.push({std::move(key), "stdin"})) {
+                return false;
+            }
+        }
+        keys.clear();
+        return true;
+    };
+
+    while (true) {
+        long n = read_stdin(chunk.data(), chunk.size());
+        if (n <= 0) {
+            // 被中断时不再送出剩余的不完整行
+            if (g_interrupted.load()) {
+                return;
+            }
+            break;
+        }
+        buffer.append(chunk.data(), static_cast<size_t>(n));
+
+        size_t complete = KeyScanner::complete_lines_length(buffer);
+        if (complete == 0) {
+            continue;
+        }
+        KeyScanner::scan(std::string_view(buffer).substr(0, complete), keys);
+        buffer.erase(0, complete);
+        if (!flush_keys()) {
+            return;
+        }
+    }
+
+    // 最后一行可能没有换行
+    KeyScanner::scan(buffer, keys);
+    flush_keys();
+}
+
+// 依次读取每个输入，文件流式解析，"-" 读取stdin
+KeyProducer make_input_producer(const std::vector<std::string>& inputs) {
+    return [&inputs](BoundedChannel<KeyItem>& channel) {
+        for (const auto& input : inputs) {
+            if (input == "-") {
+                produce_from_stdin(channel);
+            } else if (!FileUtils::file_exists(input)) {
+                std::cerr << "无法打开输入文件: " << input << std::endl;
+            } else {
+                FileUtils::for_each_api_key(input, [&](std::string key) {
+                    return channel.push({std::move(key), input});
+                });
+            }
+            if (channel.is_closed()) {
+                return;
+            }
+        }
+    };
+}
+
+// 合并进度文件：未指定文件时按key列表指纹把当前目录的进度文件分组，每组合并为一个
+int merge_progress(const CliOptions& options, size_t max_progress_files) {
+    std::vector<std::vector<std::string>> groups;
+    if (!options.inputs.empty()) {
+        groups.push_back(options.inputs);
+    } else {
+        std::map<std::pair<uint64_t, size_t>, std::vector<std::string>> by_input;
+        for (const auto& session : ProgressIndex::refresh(".")) {
+            by_input[{session.fingerprint, session.total}].push_back(session.file);
+        }
+        for (auto& [input, files] : by_input) {
+            if (files.size() > 1) {
+                std::sort(files.begin(), files.end());
+                groups.push_back(std::move(files));
+            }
+        }
+        if (groups.empty() && !options.quiet) {
+            std::cerr << "没有需要合并的进度文件" << std::endl;
+        }
+    }
+
+    bool ok = true;
+    for (const auto& files : groups) {
+        auto merged = APIKeyChecker::merge_progress_files(files);
+        if (!merged) {
+            ok = false;
+        } else if (!options.quiet) {
+            std::cerr << "✅ 已合并 " << files.size() << " 个进度文件 -> " << *merged << std::endl;
+        }
+    }
+
+    size_t removed = APIKeyChecker::prune_progress_files(max_progress_files);
+    if (removed > 0 && !options.quiet) {
+        std::cerr << "按保留策略删除了 " << removed << " 个旧进度文件（最多保留 "
+                  << max_progress_files << " 个）" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    bool show_help = false;
+    auto parsed = parse_args(argc, argv, show_help);
+    if (show_help) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    if (!parsed) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    CliOptions options = *parsed;
+
+    // 命令行版本只读取已有的配置文件，不在当前目录生成默认配置
+    ConfigManager config_manager;
+    std::string config_file = options.config_file.empty()
+        ? ConfigManager::get_default_config_path() : options.config_file;
+    if (FileUtils::file_exists(config_file)) {
+        if (!config_manager.load_config(config_file)) {
+            std::cerr << "加载配置文件失败: " << config_file << std::endl;
+            return 1;
+        }
+    } else if (!options.config_file.empty()) {
+        std::cerr << "配置文件不存在: " << config_file << std::endl;
+        return 2;
+    }
+    if (options.merge_progress) {
+        return merge_progress(options, config_manager.get_config().max_progress_files);
+    }
+
+    SessionOptions session_options = SessionOptions::from_config(config_manager.get_config());
+    if (options.concurrent) {
+        session_options.concurrent = options.concurrent;
+    }
+    if (options.timeout) {
+        session_options.timeout_secs = options.timeout;
+    }
+    if (options.connect_timeout) {
+        session_options.connect_timeout_secs = options.connect_timeout;
+    }
+    session_options.channel_capacity = options.capacity;
+
+    CheckSession session(session_options);
+    NdjsonSink sink(std::cout, options.only_valid);
+    session.add_sink(sink);
+
+    std::optional<ResultStoreSink> store_sink;
+    if (!options.store_file.empty()) {
+        store_sink.emplace(options.store_file);
+        if (!store_sink->is_open()) {
+            return 1;
+        }
+        session.add_sink(*store_sink);
+    }
+
+    g_session.store(&session);
+#ifndef _WIN32
+    open_signal_pipe();
+#endif
+    std::signal(SIGINT, handle_signal);
+#ifdef SIGTERM
+    std::signal(SIGTERM, handle_signal);
+#endif
+
+    CheckStats stats;
+    try {
+        if (!options.directory.empty()) {
+            stats = session.run_directory(options.directory);
+        } else if (!options.follow.empty()) {
+            if (!options.quiet) {
+                std::cerr << "👀 跟随 " << options.follow << "，按Ctrl+C结束" << std::endl;
+            }
+            stats = session.run_following(options.follow);
+        } else {
+            stats = session.run(make_input_producer(options.inputs));
+        }
+    } catch (const std::exception& e) {
+        g_session.store(nullptr);
+        std::cerr << "检测失败: " << e.what() << std::endl;
+        return 1;
+    }
+    g_session.store(nullptr);
+
+    if (!options.quiet) {
+        std::cerr << "检测完成: 共 " << stats.checked.load()
+                  << " | 🟢" << stats.valid.load()
+                  << " | 🔴" << stats.invalid.load()
+                  << " | ⚠️" << stats.error.load()
+                  << " | 用时 " << stats.duration_secs << " 秒" << std::endl;
+    }
+
+    return 0;
+}
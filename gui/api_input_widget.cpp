@@ -4,11 +4,31 @@
 #include <QFormLayout>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QRegularExpression>
 #include <QSplitter>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QSettings>
+#include <QDebug>
+#include <mutex>
+#include "file_utils.h"
+#include "key_harvester.h"
+#include "key_scanner.h"
+#include "progress_journal.h"
+
+namespace {
+
+// 后台加载文件的结果，error 非空时 keys 为空
+struct LoadedKeys {
+    QStringList keys;
+    QString error;
+};
+
+} // namespace
 
 ApiInputWidget::ApiInputWidget(QWidget *parent)
-    : QWidget(parent), m_isRunning(false)
+    : QWidget(parent), m_checkerThread(nullptr), m_resultWriter(nullptr), m_isRunning(false)
 {
     setupUi();
     connectSignals();
@@ -25,8 +45,10 @@ void ApiInputWidget::setupUi()
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     m_loadFileButton = new QPushButton("📁 从文件加载", this);
+    m_loadDirButton = new QPushButton("📂 从目录提取", this);
     m_clearButton = new QPushButton("🗑️ 清空", this);
     buttonLayout->addWidget(m_loadFileButton);
+    buttonLayout->addWidget(m_loadDirButton);
     buttonLayout->addStretch();
     buttonLayout->addWidget(m_clearButton);
 
@@ -69,7 +91,7 @@ void ApiInputWidget::setupUi()
     m_timeoutSpin->setSuffix(" 秒");
 
     m_saveProgressCheck = new QCheckBox("自动保存进度", this);
-    m_saveProgressCheck->setChecked(true);
+    m_saveProgressCheck->setChecked(QSettings().value("progress/auto_save", true).toBool());
 
     configLayout->addRow("API端点:", m_endpointInput);
     configLayout->addRow("HTTP方法:", m_methodCombo);
@@ -108,6 +130,7 @@ void ApiInputWidget::setupUi()
 void ApiInputWidget::connectSignals()
 {
     connect(m_loadFileButton, &QPushButton::clicked, this, &ApiInputWidget::onLoadFromFile);
+    connect(m_loadDirButton, &QPushButton::clicked, this, &ApiInputWidget::onLoadFromDirectory);
     connect(m_clearButton, &QPushButton::clicked, this, &ApiInputWidget::onClearInput);
     connect(m_startButton, &QPushButton::clicked, this, &ApiInputWidget::onStartDetection);
     connect(m_stopButton, &QPushButton::clicked, this, &ApiInputWidget::onStopDetection);
@@ -129,16 +152,15 @@ void ApiInputWidget::clearInput()
 
 QStringList ApiInputWidget::getApiKeys() const
 {
+    // 与从文件加载使用同一个扫描器，支持所有已注册的key格式
+    const std::string text = m_apiInput->toPlainText().toStdString();
+    std::vector<std::string> found;
+    api_checker::KeyScanner::scan(text, found);
+
     QStringList keys;
-    QString text = m_apiInput->toPlainText();
-    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
-
-    QRegularExpression regex("^\\s*sk-");
-    for (const QString &line : lines) {
-        QString trimmed = line.trimmed();
-        if (!trimmed.isEmpty() && regex.match(trimmed).hasMatch()) {
-            keys.append(trimmed);
-        }
+    keys.reserve(static_cast<qsizetype>(found.size()));
+    for (const auto &key : found) {
+        keys.append(QString::fromStdString(key));
     }
 
     return keys;
@@ -177,17 +199,98 @@ QString ApiInputWidget::getRequestBody() const
 void ApiInputWidget::onLoadFromFile()
 {
     QString fileName = QFileDialog::getOpenFileName(this, "选择API文件",
-        "", "文本文件 (*.txt);;所有文件 (*.*)");
-
-    if (!fileName.isEmpty()) {
-        QFile file(fileName);
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            m_apiInput->setPlainText(in.readAll());
-            file.close();
-            m_statusLabel->setText(QString("已加载: %1").arg(QFileInfo(fileName).fileName()));
+        "", "文本文件 (*.txt);;压缩文件 (*.gz *.zst);;所有文件 (*.*)");
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    m_loadFileButton->setEnabled(false);
+    m_statusLabel->setText(QString("正在加载: %1").arg(QFileInfo(fileName).fileName()));
+
+    // 在后台线程用内存映射+多核分块扫描解析文件，避免大文件阻塞界面
+    auto *watcher = new QFutureWatcher<LoadedKeys>(this);
+    connect(watcher, &QFutureWatcher<LoadedKeys>::finished, this, [this, watcher, fileName]() {
+        LoadedKeys loaded = watcher->result();
+        watcher->deleteLater();
+
+        m_loadFileButton->setEnabled(!m_isRunning);
+        // 读取或解压失败时保留原有输入，不用空列表覆盖
+        if (!loaded.error.isEmpty()) {
+            m_statusLabel->setText(QString("加载失败: %1").arg(QFileInfo(fileName).fileName()));
+            QMessageBox::warning(this, "加载失败",
+                QString("无法读取 %1:\n%2").arg(QFileInfo(fileName).fileName(), loaded.error));
+            return;
+        }
+
+        m_apiInput->setPlainText(loaded.keys.join('\n'));
+        m_statusLabel->setText(QString("已加载: %1 (%2 个)")
+            .arg(QFileInfo(fileName).fileName()).arg(loaded.keys.size()));
+    });
+
+    const std::string path = QFile::encodeName(fileName).toStdString();
+    watcher->setFuture(QtConcurrent::run([path]() {
+        std::string errorMessage;
+        std::vector<std::string> keys = api_checker::FileUtils::load_api_keys(path, &errorMessage);
+
+        LoadedKeys result;
+        result.error = QString::fromStdString(errorMessage);
+        result.keys.reserve(static_cast<qsizetype>(keys.size()));
+        for (const auto &key : keys) {
+            result.keys.append(QString::fromStdString(key));
         }
+        return result;
+    }));
+}
+
+void ApiInputWidget::onLoadFromDirectory()
+{
+    QString dirName = QFileDialog::getExistingDirectory(this, "选择要扫描的目录");
+
+    if (dirName.isEmpty()) {
+        return;
     }
+
+    m_loadDirButton->setEnabled(false);
+    m_statusLabel->setText(QString("正在扫描: %1").arg(QFileInfo(dirName).fileName()));
+
+    struct HarvestResult {
+        QStringList keys;
+        api_checker::HarvestStats stats;
+    };
+
+    // 在后台线程并行遍历目录树，避免大目录阻塞界面
+    auto *watcher = new QFutureWatcher<HarvestResult>(this);
+    connect(watcher, &QFutureWatcher<HarvestResult>::finished, this, [this, watcher]() {
+        HarvestResult result = watcher->result();
+        watcher->deleteLater();
+
+        m_apiInput->setPlainText(result.keys.join('\n'));
+        m_loadDirButton->setEnabled(!m_isRunning);
+        m_statusLabel->setText(QString("已扫描 %1 个文件，跳过 %2 个，提取 %3 个key")
+            .arg(result.stats.files_scanned)
+            .arg(result.stats.files_skipped)
+            .arg(result.keys.size()));
+    });
+
+    const std::string root = QFile::encodeName(dirName).toStdString();
+    watcher->setFuture(QtConcurrent::run([root]() {
+        std::mutex mutex;
+        std::vector<std::string> keys;
+        HarvestResult result;
+        result.stats = api_checker::KeyHarvester::harvest(root, {},
+            [&](const api_checker::HarvestedKey &key) {
+                std::lock_guard<std::mutex> lock(mutex);
+                keys.push_back(key.key);
+                return true;
+            });
+
+        result.keys.reserve(static_cast<qsizetype>(keys.size()));
+        for (const auto &key : keys) {
+            result.keys.append(QString::fromStdString(key));
+        }
+        return result;
+    }));
 }
 
 void ApiInputWidget::onClearInput()
@@ -206,7 +309,7 @@ void ApiInputWidget::updateValidationStatus()
     QStringList keys = getApiKeys();
 
     if (keys.isEmpty()) {
-        m_validationLabel->setText("⚠️ 请输入API（以sk-开头）");
+        m_validationLabel->setText("⚠️ 请输入API（支持 OpenAI、Anthropic、Google 等格式）");
         m_validationLabel->setStyleSheet("color: orange;");
         m_startButton->setEnabled(false);
     } else {
@@ -225,7 +328,7 @@ bool ApiInputWidget::validateInput()
 
     QStringList keys = getApiKeys();
     if (keys.isEmpty()) {
-        QMessageBox::warning(this, "格式错误", "未找到有效的API（必须以sk-开头）");
+        QMessageBox::warning(this, "格式错误", "未找到支持格式的API");
         return false;
     }
 
@@ -244,28 +347,95 @@ void ApiInputWidget::onStartDetection()
     }
 
     QStringList keys = getApiKeys();
+
+    auto *thread = new CheckerThread(this);
+    thread->setApiKeys(keys);
+    thread->setCheckpointEnabled(m_saveProgressCheck->isChecked());
+    startChecker(thread, keys.size(), "图形界面输入");
+}
+
+void ApiInputWidget::resumeDetection(const QString &progressFile)
+{
+    if (m_isRunning) {
+        QMessageBox::warning(this, "无法恢复", "请等待当前检测结束后再恢复");
+        return;
+    }
+
+    auto header = api_checker::ProgressJournal::read_header(progressFile.toStdString());
+    if (!header) {
+        QMessageBox::critical(this, "恢复失败", "不是有效的进度文件: " + progressFile);
+        return;
+    }
+
+    // 沿用创建进度时的请求设置，剩余的key与已完成的key按同样的请求检测
+    if (header->request) {
+        m_endpointInput->setText(QString::fromStdString(header->request->endpoint));
+        m_methodCombo->setCurrentText(QString::fromStdString(header->request->method));
+        m_headersInput->setText(QString::fromStdString(header->request->headers));
+        m_requestBodyInput->setPlainText(QString::fromStdString(header->request->body));
+    } else if (m_endpointInput->text().trimmed().isEmpty()) {
+        QMessageBox::warning(this, "配置错误", "请输入API端点URL");
+        return;
+    }
+
+    // 沿用创建进度时的并发和超时设置
+    m_concurrentSpin->setValue(static_cast<int>(header->concurrent));
+    m_timeoutSpin->setValue(static_cast<int>(header->timeout));
+
+    auto *thread = new CheckerThread(this);
+    thread->setResumeFile(progressFile);
+    startChecker(thread, static_cast<int>(header->key_count), progressFile);
+}
+
+void ApiInputWidget::startChecker(CheckerThread *thread, int total, const QString &inputFile)
+{
     m_isRunning = true;
     m_startButton->setEnabled(false);
     m_stopButton->setEnabled(true);
     m_loadFileButton->setEnabled(false);
+    m_loadDirButton->setEnabled(false);
     m_clearButton->setEnabled(false);
 
     m_progressBar->setVisible(true);
-    m_progressBar->setRange(0, keys.size());
+    m_progressBar->setRange(0, total);
     m_progressBar->setValue(0);
 
     m_statusLabel->setText("正在初始化...");
 
-    emit detectionStarted(keys.size());
+    emit detectionStarted(total);
 
-    m_checkerThread = new CheckerThread(this);
-    m_checkerThread->setApiKeys(keys);
+    m_checkerThread = thread;
     m_checkerThread->setEndpoint(getApiEndpoint());
     m_checkerThread->setMethod(getHttpMethod());
     m_checkerThread->setHeaders(getHeaders());
     m_checkerThread->setRequestBody(getRequestBody());
     m_checkerThread->setConcurrent(getConcurrent());
     m_checkerThread->setTimeout(getTimeout());
+    m_checkerThread->setSaveInterval(QSettings().value("progress/save_interval", 30).toInt());
+
+    // 历史记录先以初值创建，检测结束后再更新汇总
+    HistoryRecord run{};
+    run.id = -1;
+    run.startTime = QDateTime::currentDateTime();
+    run.endTime = run.startTime;
+    run.inputFile = inputFile;
+    run.totalKeys = total;
+    run.apiEndpoint = getApiEndpoint();
+    m_runStartTime = run.startTime;
+
+    ResultDbWriter *writer = new ResultDbWriter(run, this);
+    connect(writer, &ResultDbWriter::runFinished, this, [this, writer](qint64 runId) {
+        writer->deleteLater();
+        if (runId >= 0) {
+            emit historyRecorded(runId);
+        }
+    });
+    connect(writer, &ResultDbWriter::error, this, [](const QString &errorMessage) {
+        qWarning() << errorMessage;
+    });
+    writer->start();
+    m_resultWriter = writer;
+    m_checkerThread->setResultWriter(writer);
 
     connect(m_checkerThread, &CheckerThread::progress, this, &ApiInputWidget::onCheckerProgress);
     connect(m_checkerThread, &CheckerThread::finished, this, &ApiInputWidget::onCheckerFinished);
@@ -297,10 +467,19 @@ void ApiInputWidget::onCheckerFinished()
     m_startButton->setEnabled(true);
     m_stopButton->setEnabled(false);
     m_loadFileButton->setEnabled(true);
+    m_loadDirButton->setEnabled(true);
     m_clearButton->setEnabled(true);
 
-    m_progressBar->setValue(m_progressBar->maximum());
-    m_statusLabel->setText("检测完成");
+    // 中途停止且保存了进度时提示可以恢复
+    QString progressFile = m_checkerThread->progressFile();
+    if (m_progressBar->value() < m_progressBar->maximum() && !progressFile.isEmpty()) {
+        m_statusLabel->setText("检测已停止，进度已保存到 " + progressFile + "，可在历史记录中恢复");
+    } else {
+        m_progressBar->setValue(m_progressBar->maximum());
+        m_statusLabel->setText("检测完成");
+    }
+
+    finishHistoryRun();
 
     m_checkerThread->deleteLater();
     m_checkerThread = nullptr;
@@ -314,13 +493,43 @@ void ApiInputWidget::onCheckerError(const QString &error)
     m_startButton->setEnabled(true);
     m_stopButton->setEnabled(false);
     m_loadFileButton->setEnabled(true);
+    m_loadDirButton->setEnabled(true);
     m_clearButton->setEnabled(true);
 
     m_progressBar->setVisible(false);
     m_statusLabel->setText("检测失败");
 
+    finishHistoryRun();
+
     m_checkerThread->deleteLater();
     m_checkerThread = nullptr;
 
     emit detectionError(error);
 }
+
+void ApiInputWidget::finishHistoryRun()
+{
+    if (!m_resultWriter) {
+        return;
+    }
+
+    HistoryRecord summary{};
+    summary.startTime = m_runStartTime;
+    summary.endTime = QDateTime::currentDateTime();
+    for (const auto &result : m_checkerThread->getResults()) {
+        if (result.isValid()) {
+            ++summary.validKeys;
+        } else if (result.isInvalid()) {
+            ++summary.invalidKeys;
+        } else {
+            ++summary.errorKeys;
+        }
+    }
+    summary.totalKeys = summary.validKeys + summary.invalidKeys + summary.errorKeys;
+    summary.duration = m_runStartTime.msecsTo(summary.endTime) / 1000.0;
+    summary.avgSpeed = summary.duration > 0 ? summary.totalKeys / summary.duration : 0.0;
+
+    // 写入线程写完剩余结果后自行结束并释放
+    m_resultWriter->finishRun(summary);
+    m_resultWriter = nullptr;
+}
@@ -11,6 +11,7 @@
 #include <QGroupBox>
 #include <QCheckBox>
 #include "checker_thread.h"
+#include "result_db_writer.h"
 
 class ApiInputWidget : public QWidget
 {
@@ -28,16 +29,22 @@ public:
     QString getHeaders() const;
     QString getRequestBody() const;
 
+    // 从进度日志恢复检测，只检测其中尚未完成的key
+    void resumeDetection(const QString &progressFile);
+
 signals:
     void detectionStarted(int total);
     void detectionProgress(int current, int valid, int invalid, int error);
     void detectionFinished();
     void detectionError(const QString &error);
+    // 本次检测的汇总和每个key的结果已写入历史数据库
+    void historyRecorded(qint64 runId);
 
 private slots:
     void onStartDetection();
     void onStopDetection();
     void onLoadFromFile();
+    void onLoadFromDirectory();
     void onClearInput();
     void onValidationChanged();
     void onCheckerProgress(int current, int valid, int invalid, int error);
@@ -49,6 +56,10 @@ private:
     void connectSignals();
     bool validateInput();
     void updateValidationStatus();
+    // 按当前配置启动检测线程和历史写入线程，total为进度条的总数
+    void startChecker(CheckerThread *thread, int total, const QString &inputFile);
+    // 统计检测线程的结果，交给历史写入线程更新汇总后结束
+    void finishHistoryRun();
 
     QGroupBox *m_inputGroup;
     QGroupBox *m_configGroup;
@@ -57,6 +68,7 @@ private:
     QTextEdit *m_apiInput;
     QLabel *m_validationLabel;
     QPushButton *m_loadFileButton;
+    QPushButton *m_loadDirButton;
     QPushButton *m_clearButton;
 
     QLineEdit *m_endpointInput;
@@ -75,5 +87,7 @@ private:
     QProgressBar *m_progressBar;
 
     CheckerThread *m_checkerThread;
+    ResultDbWriter *m_resultWriter;
+    QDateTime m_runStartTime;
     bool m_isRunning;
 };
@@ -1,4 +1,5 @@
 #include "checker_thread.h"
+#include "result_db_writer.h"
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -10,11 +11,59 @@
 #include <QElapsedTimer>
 #include <QSemaphore>
 #include <QtConcurrent>
+#include <QDebug>
+#include <QFile>
+#include <algorithm>
+#include "completion_bitmap.h"
+
+using namespace api_checker;
+
+namespace {
+
+// 图形界面的key来自输入框，进度日志中内嵌key列表，输入文件一栏只作说明
+const char *const GUI_INPUT_LABEL = "图形界面输入";
+
+} // namespace
+
+ApiCheckResult ApiCheckResult::fromKeyResult(const KeyResult &result)
+{
+    ApiCheckResult converted;
+    converted.key = QString::fromStdString(result.key);
+    converted.status = result.status == KeyStatus::Valid ? "valid" :
+                       result.status == KeyStatus::Invalid ? "invalid" : "error";
+    converted.message = QString::fromStdString(result.message);
+    converted.responseTime = result.response_time ? result.response_time->count() : 0;
+    converted.checkedAt = QDateTime::fromMSecsSinceEpoch(
+        std::chrono::duration_cast<std::chrono::milliseconds>(result.checked_at.time_since_epoch()).count());
+    converted.httpStatus = result.http_status;
+    converted.messageCode = result.message_code;
+    return converted;
+}
+
+KeyResult ApiCheckResult::toKeyResult() const
+{
+    KeyResult result;
+    result.key = key.toStdString();
+    result.status = isValid() ? KeyStatus::Valid : isInvalid() ? KeyStatus::Invalid : KeyStatus::Error;
+    result.message = message.toStdString();
+    result.checked_at = std::chrono::system_clock::time_point(
+        std::chrono::milliseconds(checkedAt.toMSecsSinceEpoch()));
+    result.response_time = std::chrono::milliseconds(responseTime);
+    result.message_code = messageCode;
+    result.http_status = static_cast<uint16_t>(httpStatus);
+    return result;
+}
 
 CheckerThread::CheckerThread(QObject *parent)
     : QThread(parent)
     , m_concurrent(1000)
     , m_timeout(10)
+    , m_checkpointEnabled(false)
+    , m_saveInterval(30)
+    , m_resultWriter(nullptr)
+    , m_restoredValid(0)
+    , m_restoredInvalid(0)
+    , m_restoredError(0)
     , m_shouldStop(0)
 {
 }
@@ -60,6 +109,31 @@ void CheckerThread::setTimeout(int timeout)
     m_timeout = timeout;
 }
 
+void CheckerThread::setCheckpointEnabled(bool enabled)
+{
+    m_checkpointEnabled = enabled;
+}
+
+void CheckerThread::setSaveInterval(int seconds)
+{
+    m_saveInterval = std::max(1, seconds);
+}
+
+void CheckerThread::setResumeFile(const QString &progressFile)
+{
+    m_resumeFile = progressFile;
+}
+
+QString CheckerThread::progressFile() const
+{
+    return m_progressFile;
+}
+
+void CheckerThread::setResultWriter(ResultDbWriter *writer)
+{
+    m_resultWriter = writer;
+}
+
 void CheckerThread::stop()
 {
     m_shouldStop.storeRelaxed(1);
@@ -91,11 +165,141 @@ void CheckerThread::run()
     m_shouldStop.storeRelaxed(0);
     m_results.clear();
 
+    if (!prepareCheckpoint()) {
+        return;
+    }
+
     checkApiKeys();
 
+    if (m_journal) {
+        m_journal->close();
+        m_journal.reset();
+        const std::string path = m_progressFile.toStdString();
+        if (m_shouldStop.loadRelaxed()) {
+            // 已完成的记录在关闭时全部落盘，再压缩为快照，恢复时无需去重
+            ProgressJournal::compact(path);
+        } else {
+            // 全部检测完成，结果已写入历史数据库，进度日志和位图侧文件不再需要
+            QFile::remove(m_progressFile);
+            QFile::remove(QString::fromStdString(ProgressJournal::sidecar_path(path)));
+            m_progressFile.clear();
+        }
+    }
+
     emit finished();
 }
 
+bool CheckerThread::prepareCheckpoint()
+{
+    m_ordinals.clear();
+    m_restoredValid = m_restoredInvalid = m_restoredError = 0;
+    m_progressFile.clear();
+
+    if (!m_resumeFile.isEmpty()) {
+        return restoreCheckpoint();
+    }
+
+    for (int i = 0; i < m_apiKeys.size(); ++i) {
+        m_ordinals.append(static_cast<quint32>(i));
+    }
+
+    if (!m_checkpointEnabled || m_apiKeys.isEmpty()) {
+        return true;
+    }
+
+    JournalHeader header;
+    header.session_id = "session_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss").toStdString();
+    header.input_file = GUI_INPUT_LABEL;
+    header.keys.reserve(m_apiKeys.size());
+    for (const QString &key : m_apiKeys) {
+        header.keys.push_back(key.toStdString());
+    }
+    header.key_count = header.keys.size();
+    header.fingerprint = ProgressJournal::fingerprint(header.keys);
+    header.concurrent = static_cast<size_t>(m_concurrent);
+    header.timeout = static_cast<size_t>(m_timeout);
+    header.request = JournalRequest{m_endpoint.toStdString(), m_method.toStdString(),
+                                    m_headers.toStdString(), m_requestBody.toStdString()};
+    header.created_at = std::chrono::system_clock::now();
+
+    JournalOptions options;
+    options.group_commit_interval = std::chrono::seconds(m_saveInterval);
+
+    QString path = QString::fromStdString("progress_" + header.session_id + ".journal");
+    m_journal = std::make_unique<ProgressJournal>();
+    if (!m_journal->create(path.toStdString(), header, options)) {
+        // 无法保存进度时照常检测，只是中断后不能恢复
+        m_journal.reset();
+        qWarning() << "无法创建进度文件:" << path;
+        return true;
+    }
+
+    m_progressFile = path;
+    return true;
+}
+
+bool CheckerThread::restoreCheckpoint()
+{
+    std::string path = m_resumeFile.toStdString();
+
+    // 先压缩去重，回放结果中每个序号只有一条记录
+    ProgressJournal::compact(path);
+    auto state = ProgressJournal::replay(path);
+    if (!state) {
+        emit error("无法加载进度文件: " + m_resumeFile);
+        return false;
+    }
+
+    // 剩余的key按创建进度时的请求继续检测，不使用界面上当前的设置；
+    // 旧版进度日志没有记录请求设置，只能沿用当前设置
+    if (const auto &request = state->header.request) {
+        m_endpoint = QString::fromStdString(request->endpoint);
+        m_method = QString::fromStdString(request->method);
+        m_headers = QString::fromStdString(request->headers);
+        m_requestBody = QString::fromStdString(request->body);
+    }
+
+    const auto &keys = state->header.keys;
+    CompletionBitmap completed(keys.size());
+    for (const auto &record : state->records) {
+        if (!completed.set(record.ordinal)) {
+            continue;
+        }
+
+        ApiCheckResult result = ApiCheckResult::fromKeyResult(record.to_result(keys[record.ordinal]));
+        if (result.isValid()) {
+            ++m_restoredValid;
+        } else if (result.isInvalid()) {
+            ++m_restoredInvalid;
+        } else {
+            ++m_restoredError;
+        }
+        if (m_resultWriter) {
+            m_resultWriter->enqueue(result);
+        }
+        m_results.append(result);
+    }
+
+    m_apiKeys.clear();
+    for (uint32_t ordinal : completed.unset_positions()) {
+        m_apiKeys.append(QString::fromStdString(keys[ordinal]));
+        m_ordinals.append(static_cast<quint32>(ordinal));
+    }
+
+    JournalOptions options;
+    options.group_commit_interval = std::chrono::seconds(m_saveInterval);
+
+    m_journal = std::make_unique<ProgressJournal>();
+    if (!m_journal->open(path, options)) {
+        m_journal.reset();
+        emit error("无法打开进度文件: " + m_resumeFile);
+        return false;
+    }
+
+    m_progressFile = m_resumeFile;
+    return true;
+}
+
 void CheckerThread::checkApiKeys()
 {
     QNetworkAccessManager networkManager;
@@ -107,14 +311,26 @@ void CheckerThread::checkApiKeys()
 
     QStringList parsedHeaders = parseHeaders(m_headers);
 
-    for (const QString &key : m_apiKeys) {
+    // 恢复检测时计数从进度日志中已完成的结果开始
+    const int restored = m_results.size();
+    validCount.storeRelaxed(m_restoredValid);
+    invalidCount.storeRelaxed(m_restoredInvalid);
+    errorCount.storeRelaxed(m_restoredError);
+    if (restored > 0) {
+        emit progress(restored, m_restoredValid, m_restoredInvalid, m_restoredError);
+    }
+
+    for (int i = 0; i < m_apiKeys.size(); ++i) {
         if (m_shouldStop.loadRelaxed()) {
             break;
         }
 
+        const QString &key = m_apiKeys[i];
+        const quint32 ordinal = m_ordinals[i];
+
         semaphore.acquire();
 
-        QtConcurrent::run([&]() {
+        QtConcurrent::run([&, ordinal]() {
             if (m_shouldStop.loadRelaxed()) {
                 semaphore.release();
                 return;
@@ -122,12 +338,19 @@ void CheckerThread::checkApiKeys()
 
             ApiCheckResult result = checkSingleKey(key);
 
+            if (m_journal) {
+                m_journal->append(JournalRecord::from_result(ordinal, result.toKeyResult()));
+            }
+            if (m_resultWriter) {
+                m_resultWriter->enqueue(result);
+            }
+
             {
                 QMutexLocker locker(&m_resultsMutex);
                 m_results.append(result);
             }
 
-            int current = checkedCount.fetchAndAddRelaxed(1) + 1;
+            int current = restored + checkedCount.fetchAndAddRelaxed(1) + 1;
 
             if (result.isValid()) {
                 validCount.fetchAndAddRelaxed(1);
@@ -142,9 +365,9 @@ void CheckerThread::checkApiKeys()
         });
     }
 
-    while (checkedCount.loadRelaxed() < m_apiKeys.size() && !m_shouldStop.loadRelaxed()) {
-        QThread::msleep(10);
-    }
+    // 取回全部许可即等待所有已提交的任务结束：任务引用了本函数的局部变量和进度日志，
+    // 停止检测时也必须等它们退出后才能返回
+    semaphore.acquire(m_concurrent);
 }
 
 ApiCheckResult CheckerThread::checkSingleKey(const QString &key)
@@ -193,6 +416,7 @@ ApiCheckResult CheckerThread::checkSingleKey(const QString &key)
     if (!reply) {
         result.status = "error";
         result.message = "创建请求失败";
+        result.messageCode = MessageCode::RequestError;
         result.responseTime = timer.elapsed();
         return result;
     }
@@ -213,6 +437,7 @@ ApiCheckResult CheckerThread::checkSingleKey(const QString &key)
 
         if (reply->error() == QNetworkReply::NoError) {
             int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            result.httpStatus = statusCode;
 
             switch (statusCode) {
                 case 200:
@@ -220,40 +445,49 @@ ApiCheckResult CheckerThread::checkSingleKey(const QString &key)
                 case 204:
                     result.status = "valid";
                     result.message = "有效";
+                    result.messageCode = MessageCode::Valid;
                     break;
                 case 401:
                     result.status = "invalid";
                     result.message = "认证失败";
+                    result.messageCode = MessageCode::AuthFailed;
                     break;
                 case 403:
                     result.status = "invalid";
                     result.message = "访问被拒绝";
+                    result.messageCode = MessageCode::Forbidden;
                     break;
                 case 404:
                     result.status = "invalid";
                     result.message = "资源不存在";
+                    result.messageCode = MessageCode::HttpError;
                     break;
                 case 429:
                     result.status = "error";
                     result.message = "请求过多，稍后重试";
+                    result.messageCode = MessageCode::RateLimited;
                     break;
                 default:
                     if (statusCode >= 500) {
                         result.status = "error";
                         result.message = QString("服务器错误 %1").arg(statusCode);
+                        result.messageCode = MessageCode::ServerError;
                     } else {
                         result.status = "invalid";
                         result.message = QString("HTTP %1").arg(statusCode);
+                        result.messageCode = MessageCode::HttpError;
                     }
                     break;
             }
         } else {
             result.status = "error";
             result.message = reply->errorString();
+            result.messageCode = MessageCode::RequestError;
         }
     } else {
         result.status = "error";
         result.message = QString("请求超时 (%1秒)").arg(m_timeout);
+        result.messageCode = MessageCode::RequestError;
     }
 
     reply->deleteLater();
@@ -6,7 +6,11 @@
 #include <QMutex>
 #include <QAtomicInt>
 #include <QDateTime>
+#include <memory>
 #include "api_checker.h"
+#include "progress_journal.h"
+
+class ResultDbWriter;
 
 struct ApiCheckResult {
     QString key;
@@ -14,10 +18,16 @@ struct ApiCheckResult {
     QString message;
     qint64 responseTime;
     QDateTime checkedAt;
+    int httpStatus = 0;  // 未收到HTTP响应时为0
+    api_checker::MessageCode messageCode = api_checker::MessageCode::None;
 
     bool isValid() const { return status == "valid"; }
     bool isInvalid() const { return status == "invalid"; }
     bool isError() const { return status == "error"; }
+
+    // 与核心库检测结果互相转换，用于读写进度日志和结果文件
+    static ApiCheckResult fromKeyResult(const api_checker::KeyResult &result);
+    api_checker::KeyResult toKeyResult() const;
 };
 
 class CheckerThread : public QThread
@@ -36,6 +46,16 @@ public:
     void setConcurrent(int concurrent);
     void setTimeout(int timeout);
 
+    // 检测时把每个结果追加到进度日志，中断后可以只检测剩余的key
+    void setCheckpointEnabled(bool enabled);
+    void setSaveInterval(int seconds);
+    // 从进度日志恢复：已完成的结果直接载入，只检测剩余的key（忽略setApiKeys）
+    void setResumeFile(const QString &progressFile);
+    // 本次检测写入的进度日志，未保存进度时为空
+    QString progressFile() const;
+    // 每个结果（含恢复时载入的结果）同时交给后台线程写入历史数据库，不转移所有权
+    void setResultWriter(ResultDbWriter *writer);
+
     void stop();
 
     QVector<ApiCheckResult> getResults() const;
@@ -57,10 +77,23 @@ private:
     int m_concurrent;
     int m_timeout;
 
+    bool m_checkpointEnabled;
+    int m_saveInterval;
+    QString m_resumeFile;
+    QString m_progressFile;
+    QVector<quint32> m_ordinals;  // m_apiKeys中每个key在进度日志key列表中的序号
+    std::unique_ptr<api_checker::ProgressJournal> m_journal;
+    ResultDbWriter *m_resultWriter;
+    int m_restoredValid;
+    int m_restoredInvalid;
+    int m_restoredError;
+
     QAtomicInt m_shouldStop;
     QVector<ApiCheckResult> m_results;
     QMutex m_resultsMutex;
 
+    bool prepareCheckpoint();
+    bool restoreCheckpoint();
     void checkApiKeys();
     ApiCheckResult checkSingleKey(const QString &key);
     QStringList parseHeaders(const QString &headersStr) const;
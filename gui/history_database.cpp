@@ -0,0 +1,229 @@
+#include "history_database.h"
+#include "history_schema.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+bool tableExists(QSqlDatabase &db, const QString &name)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE name = ?");
+    query.addBindValue(name);
+    return query.exec() && query.next();
+}
+
+// 创建汇总表和维护它们的触发器
+bool createAggregates(QSqlDatabase &db, QString *errorMessage)
+{
+    const bool created = tableExists(db, "history_summary");
+
+    if (!db.transaction()) {
+        if (errorMessage) {
+            *errorMessage = "无法开始事务: " + db.lastError().text();
+        }
+        return false;
+    }
+    QSqlQuery query(db);
+    std::vector<std::string> statements = HistorySchema::aggregateStatements();
+    if (!created) {
+        const auto &backfill = HistorySchema::aggregateBackfillStatements();
+        statements.insert(statements.end(), backfill.begin(), backfill.end());
+    }
+    for (const std::string &statement : statements) {
+        if (!query.exec(QString::fromStdString(statement))) {
+            if (errorMessage) {
+                *errorMessage = "无法创建统计表: " + query.lastError().text();
+            }
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+// 创建 key_lifecycle 表；第一次创建时从已有的 results 汇总
+bool createKeyLifecycle(QSqlDatabase &db, QString *errorMessage)
+{
+    const bool created = tableExists(db, "key_lifecycle");
+
+    if (!db.transaction()) {
+        if (errorMessage) {
+            *errorMessage = "无法开始事务: " + db.lastError().text();
+        }
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const std::string &statement : HistorySchema::keyLifecycleStatements()) {
+        if (!query.exec(QString::fromStdString(statement))) {
+            if (errorMessage) {
+                *errorMessage = "无法创建key生命周期表: " + query.lastError().text();
+            }
+            db.rollback();
+            return false;
+        }
+    }
+    if (!created && !query.exec(QString::fromStdString(HistorySchema::keyLifecycleBackfillSql()))) {
+        if (errorMessage) {
+            *errorMessage = "无法汇总key生命周期: " + query.lastError().text();
+        }
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+// 创建全文索引；SQLite未编译FTS5时返回false，搜索退回LIKE，不影响其他功能
+bool createFullTextIndex(QSqlDatabase &db)
+{
+    // 已有数据的数据库第一次建索引时需要从内容表重建
+    const bool created = tableExists(db, "history_fts");
+
+    if (!db.transaction()) {
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const std::string &statement : HistorySchema::fullTextStatements()) {
+        if (!query.exec(QString::fromStdString(statement))) {
+            qWarning() << "无法创建全文索引，搜索将逐行匹配:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!created) {
+        for (const std::string &statement : HistorySchema::fullTextRebuildStatements()) {
+            query.exec(QString::fromStdString(statement));
+        }
+    }
+    return db.commit();
+}
+
+} // namespace
+
+QString HistoryDatabase::fileName()
+{
+    return "api_checker_history.db";
+}
+
+QSqlDatabase HistoryDatabase::open(const QString &connectionName, QString *errorMessage)
+{
+    QSqlDatabase db = QSqlDatabase::contains(connectionName)
+        ? QSqlDatabase::database(connectionName, false)
+        : QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(fileName());
+    // 写入线程提交时读取方可能正持有锁，稍等而不是立即报 "database is locked"
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!db.open()) {
+        if (errorMessage) {
+            *errorMessage = "无法打开历史数据库: " + db.lastError().text();
+        }
+        return db;
+    }
+
+    // 新建的数据库使用增量清理模式，删除旧记录后由后台维护逐步归还空闲页；
+    // 必须在切换WAL（会写入文件头）和建表之前设置，对已有的数据库不起作用
+    QSqlQuery query(db);
+    query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+
+    // WAL下写入不阻塞读取；synchronous=NORMAL 只在检查点时同步，
+    // 断电最多丢失最近提交的事务，数据库本身不会损坏
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    query.exec("PRAGMA foreign_keys=ON");
+
+    for (const std::string &statement : HistorySchema::tableStatements()) {
+        if (!query.exec(QString::fromStdString(statement))) {
+            if (errorMessage) {
+                *errorMessage = "无法创建历史表: " + query.lastError().text();
+            }
+            db.close();
+            return db;
+        }
+    }
+    if (!createAggregates(db, errorMessage) || !createKeyLifecycle(db, errorMessage)) {
+        db.close();
+        return db;
+    }
+    createFullTextIndex(db);
+
+    return db;
+}
+
+bool HistoryDatabase::hasFullTextSearch(QSqlDatabase &db)
+{
+    return tableExists(db, "history_fts") && tableExists(db, "results_fts");
+}
+
+QString HistoryDatabase::fullTextQuery(const QString &text)
+{
+    // 整体作为一个短语，引号内的运算符和标点都按字面匹配
+    QString phrase = text;
+    phrase.replace('"', "\"\"");
+    return '"' + phrase + '"';
+}
+
+QString HistoryDatabase::keyLifecycleUpsertSql()
+{
+    return QString::fromStdString(HistorySchema::keyLifecycleUpsertSql());
+}
+
+qint64 HistoryDatabase::insertRun(QSqlDatabase &db, const HistoryRecord &record, QString *errorMessage)
+{
+    QSqlQuery query(db);
+    query.prepare(QString::fromStdString(HistorySchema::insertRunSql()));
+
+    query.addBindValue(record.startTime.toString(Qt::ISODate));
+    query.addBindValue(record.endTime.toString(Qt::ISODate));
+    query.addBindValue(record.inputFile);
+    query.addBindValue(record.totalKeys);
+    query.addBindValue(record.validKeys);
+    query.addBindValue(record.invalidKeys);
+    query.addBindValue(record.errorKeys);
+    query.addBindValue(record.duration);
+    query.addBindValue(record.avgSpeed);
+    query.addBindValue(record.apiEndpoint);
+
+    if (!query.exec()) {
+        if (errorMessage) {
+            *errorMessage = "无法保存历史记录: " + query.lastError().text();
+        }
+        return -1;
+    }
+    return query.lastInsertId().toLongLong();
+}
+
+bool HistoryDatabase::updateRun(QSqlDatabase &db, const HistoryRecord &record, QString *errorMessage)
+{
+    QSqlQuery query(db);
+    query.prepare(QString::fromStdString(HistorySchema::updateRunSql()));
+
+    query.addBindValue(record.endTime.toString(Qt::ISODate));
+    query.addBindValue(record.totalKeys);
+    query.addBindValue(record.validKeys);
+    query.addBindValue(record.invalidKeys);
+    query.addBindValue(record.errorKeys);
+    query.addBindValue(record.duration);
+    query.addBindValue(record.avgSpeed);
+    query.addBindValue(record.id);
+
+    if (!query.exec()) {
+        if (errorMessage) {
+            *errorMessage = "无法更新历史记录: " + query.lastError().text();
+        }
+        return false;
+    }
+    return true;
+}
+
+qint64 HistoryDatabase::keyFingerprint(const QString &key)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (char c : key.toUtf8()) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<qint64>(hash);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QString>
+
+struct HistoryRecord {
+    int id;
+    QDateTime startTime;
+    QDateTime endTime;
+    QString inputFile;
+    int totalKeys;
+    int validKeys;
+    int invalidKeys;
+    int errorKeys;
+    double duration;
+    double avgSpeed;
+    QString apiEndpoint;
+};
+
+// 历史数据库（api_checker_history.db）的表结构和连接设置
+// QSqlDatabase 的连接不能跨线程使用，界面线程和后台写入线程各自用不同的连接名打开；
+// 数据库使用WAL日志，后台写入时界面线程仍可读取
+//
+// 表结构:
+//   history  每次检测一行汇总，id 即检测的 run_id
+//   results  每个key的检测结果，主键 (run_id, key_fp)，删除检测时一并删除
+//   history_summary / history_daily_stats / history_endpoint_stats
+//            总计、按天和按API端点的汇总，由 history 上的触发器维护
+//   key_lifecycle  每个key跨检测的首次出现、最后有效和最后失效时间，与 results 在同一事务中更新；
+//            删除检测不影响已汇总的时间
+//   history_fts / results_fts  输入文件、API端点、开始时间和key、结果消息的全文索引（FTS5 trigram），
+//            由触发器维护；SQLite不支持FTS5时不创建
+class HistoryDatabase
+{
+public:
+    static QString fileName();
+
+    // 打开连接：设置WAL、同步级别和外键约束，并确保表结构存在
+    // 失败时返回未打开的连接，errorMessage 中为原因
+    static QSqlDatabase open(const QString &connectionName, QString *errorMessage = nullptr);
+
+    // 全文索引是否可用
+    static bool hasFullTextSearch(QSqlDatabase &db);
+    // trigram 索引按3个字符切分，更短的搜索文本无法用索引匹配
+    static constexpr int MIN_FULL_TEXT_LENGTH = 3;
+    // 把用户输入转成按字面做子串匹配的 MATCH 表达式
+    static QString fullTextQuery(const QString &text);
+
+    // 合并一条结果到 key_lifecycle 的语句，参数依次为
+    // key_fp, api_key, first_seen, last_checked, last_status, last_valid, last_invalidated
+    // 后两项只在结果为有效/无效时为检测时间，否则为NULL
+    static QString keyLifecycleUpsertSql();
+
+    // 插入一次检测的汇总，返回新记录的id（即run_id），失败时返回-1
+    static qint64 insertRun(QSqlDatabase &db, const HistoryRecord &record, QString *errorMessage = nullptr);
+    // 按 record.id 更新汇总
+    static bool updateRun(QSqlDatabase &db, const HistoryRecord &record, QString *errorMessage = nullptr);
+
+    // key的64位FNV-1a指纹，results 表以它代替key文本做索引
+    static qint64 keyFingerprint(const QString &key);
+};
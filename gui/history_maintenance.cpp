@@ -0,0 +1,193 @@
+#include "history_maintenance.h"
+#include "history_database.h"
+#include "history_schema.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QSettings>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+HistoryRetention HistoryRetention::fromSettings()
+{
+    QSettings settings;
+    HistoryRetention retention;
+    retention.maxRuns = settings.value("progress/max_history", 100).toInt();
+    retention.maxAgeDays = settings.value("history/retention_days", 0).toInt();
+    retention.maxResultRows = settings.value("history/max_result_rows", 0).toLongLong();
+    return retention;
+}
+
+HistoryMaintenance::HistoryMaintenance(const HistoryRetention &retention, QObject *parent)
+    : QThread(parent)
+    , m_retention(retention)
+    , m_stop(0)
+{
+}
+
+HistoryMaintenance::~HistoryMaintenance()
+{
+    requestStop();
+    wait();
+}
+
+void HistoryMaintenance::requestStop()
+{
+    m_stop.storeRelease(1);
+}
+
+void HistoryMaintenance::run()
+{
+    const QString connectionName = QString("history_maintenance_%1").arg(reinterpret_cast<quintptr>(this));
+    int removedRuns = 0;
+    qint64 reclaimedPages = 0;
+
+    {
+        QString errorMessage;
+        QSqlDatabase db = HistoryDatabase::open(connectionName, &errorMessage);
+        if (db.isOpen()) {
+            for (qint64 runId : expiredRuns(db)) {
+                if (!removeRun(db, runId)) {
+                    break;
+                }
+                ++removedRuns;
+            }
+
+            reclaimedPages = incrementalVacuum(db);
+
+            // WAL模式下释放的页在检查点时才从数据库文件截掉，顺便清空WAL文件
+            if (removedRuns > 0 || reclaimedPages > 0) {
+                QSqlQuery query(db);
+                query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+            }
+        } else {
+            qWarning() << "历史数据库维护失败:" << errorMessage;
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    emit maintenanceFinished(removedRuns, reclaimedPages);
+}
+
+QVector<qint64> HistoryMaintenance::expiredRuns(QSqlDatabase &db) const
+{
+    QVector<qint64> runs;
+    if (m_retention.isUnlimited()) {
+        return runs;
+    }
+
+    // 参数按 expiredRunsSql 中启用的策略依次绑定
+    QVariantList values;
+    if (m_retention.maxAgeDays > 0) {
+        values << QDateTime::currentDateTime().addDays(-m_retention.maxAgeDays).toString(Qt::ISODate);
+    }
+    if (m_retention.maxRuns > 0) {
+        values << m_retention.maxRuns;
+    }
+    if (m_retention.maxResultRows > 0) {
+        values << m_retention.maxResultRows;
+    }
+    const std::string sql = HistorySchema::expiredRunsSql(
+        m_retention.maxAgeDays > 0, m_retention.maxRuns > 0, m_retention.maxResultRows > 0);
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString::fromStdString(sql));
+    for (const QVariant &value : values) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        qWarning() << "无法查询过期的历史记录:" << query.lastError().text();
+        return runs;
+    }
+    while (query.next()) {
+        runs.append(query.value(0).toLongLong());
+    }
+    return runs;
+}
+
+bool HistoryMaintenance::removeRun(QSqlDatabase &db, qint64 runId)
+{
+    // 结果按 (run_id, key_fp) 主键的范围分批删除，每批一个短事务，
+    // 不让一次删除几百万行的长事务挡住新的检测写入
+    QSqlQuery deleteResults(db);
+    deleteResults.prepare(QString::fromStdString(HistorySchema::deleteResultsChunkSql()));
+
+    int deleted = DELETE_CHUNK_ROWS;
+    while (deleted == DELETE_CHUNK_ROWS) {
+        if (m_stop.loadAcquire()) {
+            return false;
+        }
+
+        db.transaction();
+        deleteResults.bindValue(0, runId);
+        deleteResults.bindValue(1, DELETE_CHUNK_ROWS);
+        if (!deleteResults.exec()) {
+            qWarning() << "无法删除过期的检测结果:" << deleteResults.lastError().text();
+            db.rollback();
+            return false;
+        }
+        deleted = deleteResults.numRowsAffected();
+        if (!db.commit()) {
+            qWarning() << "无法删除过期的检测结果:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    // 汇总表由 history 上的触发器同步扣除
+    QSqlQuery deleteRun(db);
+    deleteRun.prepare(QString::fromStdString(HistorySchema::deleteRunSql()));
+    deleteRun.addBindValue(runId);
+    if (!deleteRun.exec()) {
+        qWarning() << "无法删除过期的历史记录:" << deleteRun.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 HistoryMaintenance::incrementalVacuum(QSqlDatabase &db)
+{
+    // auto_vacuum 只能在建表前设置或用 VACUUM 整库重建时切换，
+    // 旧的数据库不是增量模式时空闲页留在文件中供以后的写入复用
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA auto_vacuum") || !query.next() || query.value(0).toInt() != 2) {
+        return 0;
+    }
+
+    auto freePages = [&query]() -> qint64 {
+        const qint64 pages = query.exec("PRAGMA freelist_count") && query.next()
+            ? query.value(0).toLongLong() : 0;
+        query.finish();
+        return pages;
+    };
+
+    // incremental_vacuum 每执行一步释放一页，而 QSqlQuery::exec 只执行一步，
+    // 所以每次只释放一页，在一个事务中重复执行 VACUUM_STEP_PAGES 次
+    QSqlQuery vacuum(db);
+    vacuum.prepare("PRAGMA incremental_vacuum(1)");
+
+    const qint64 before = freePages();
+    qint64 remaining = before;
+    while (remaining > 0 && !m_stop.loadAcquire()) {
+        const qint64 steps = qMin<qint64>(remaining, VACUUM_STEP_PAGES);
+        db.transaction();
+        for (qint64 i = 0; i < steps; ++i) {
+            vacuum.exec();
+        }
+        vacuum.finish();
+        if (!db.commit()) {
+            qWarning() << "增量清理失败:" << db.lastError().text();
+            db.rollback();
+            break;
+        }
+
+        const qint64 next = freePages();
+        if (next >= remaining) {
+            break;
+        }
+        remaining = next;
+    }
+    return before - remaining;
+}
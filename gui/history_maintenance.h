@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QSqlDatabase>
+#include <QVector>
+
+// 历史数据库的保留策略，各项为0表示不限制
+struct HistoryRetention {
+    int maxRuns = 0;            // 最多保留的检测次数
+    int maxAgeDays = 0;         // 早于这么多天开始的检测被删除
+    qint64 maxResultRows = 0;   // 按各次检测的key数从新到旧累计，超出部分的检测被删除
+
+    bool isUnlimited() const { return maxRuns <= 0 && maxAgeDays <= 0 && maxResultRows <= 0; }
+
+    // 读取设置中的 progress/max_history、history/retention_days、history/max_result_rows
+    static HistoryRetention fromSettings();
+};
+
+// 后台维护历史数据库：按保留策略删除最旧的检测，再用增量清理把空闲页还给文件系统
+// 在界面空闲（没有检测在进行）时启动；每次只在短事务中删除 DELETE_CHUNK_ROWS 行结果、
+// 释放 VACUUM_STEP_PAGES 页，期间开始的检测写入最多等一个小事务；requestStop 后尽快结束
+class HistoryMaintenance : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DELETE_CHUNK_ROWS = 10000;
+    static constexpr int VACUUM_STEP_PAGES = 1024;
+
+    explicit HistoryMaintenance(const HistoryRetention &retention, QObject *parent = nullptr);
+    ~HistoryMaintenance();
+
+    void requestStop();
+
+signals:
+    // removedRuns 为本次删除的检测数，reclaimedPages 为释放回文件系统的页数
+    void maintenanceFinished(int removedRuns, qint64 reclaimedPages);
+
+protected:
+    void run() override;
+
+private:
+    // 按保留策略应删除的检测id，旧的在前
+    QVector<qint64> expiredRuns(QSqlDatabase &db) const;
+    // 分批删除一次检测的结果，最后删除历史记录；中途停止时返回false，剩余部分下次继续
+    bool removeRun(QSqlDatabase &db, qint64 runId);
+    qint64 incrementalVacuum(QSqlDatabase &db);
+
+    HistoryRetention m_retention;
+    QAtomicInt m_stop;
+};
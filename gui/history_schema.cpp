@@ -0,0 +1,389 @@
+#include "history_schema.h"
+
+namespace {
+
+// 把语句模板中的 %1 替换为触发器中的行名（new 或 old）
+std::string withRow(std::string sql, const std::string &row)
+{
+    for (size_t pos = sql.find("%1"); pos != std::string::npos; pos = sql.find("%1", pos + row.size())) {
+        sql.replace(pos, 2, row);
+    }
+    return sql;
+}
+
+// 把一次检测（触发器中的 new 或 old 行）计入汇总表
+std::string addRunSql(const std::string &row)
+{
+    return withRow(R"(
+        UPDATE history_summary SET
+            run_count = run_count + 1, total_keys = total_keys + %1.total_keys,
+            valid_keys = valid_keys + %1.valid_keys, invalid_keys = invalid_keys + %1.invalid_keys,
+            error_keys = error_keys + %1.error_keys, total_duration = total_duration + %1.duration
+        WHERE id = 1;
+        INSERT INTO history_daily_stats (day, run_count, total_keys, valid_keys, invalid_keys,
+                                         error_keys, total_duration)
+        VALUES (substr(%1.start_time, 1, 10), 1, %1.total_keys, %1.valid_keys, %1.invalid_keys,
+                %1.error_keys, %1.duration)
+        ON CONFLICT (day) DO UPDATE SET
+            run_count = run_count + 1, total_keys = total_keys + excluded.total_keys,
+            valid_keys = valid_keys + excluded.valid_keys,
+            invalid_keys = invalid_keys + excluded.invalid_keys,
+            error_keys = error_keys + excluded.error_keys,
+            total_duration = total_duration + excluded.total_duration;
+        INSERT INTO history_endpoint_stats (api_endpoint, run_count, total_keys, valid_keys,
+                                            total_duration, speed_sum)
+        VALUES (%1.api_endpoint, 1, %1.total_keys, %1.valid_keys, %1.duration, %1.avg_speed)
+        ON CONFLICT (api_endpoint) DO UPDATE SET
+            run_count = run_count + 1, total_keys = total_keys + excluded.total_keys,
+            valid_keys = valid_keys + excluded.valid_keys,
+            total_duration = total_duration + excluded.total_duration,
+            speed_sum = speed_sum + excluded.speed_sum;
+    )", row);
+}
+
+// 把一次检测从汇总表中减去，计数减到0的日期和端点行一并删除
+std::string removeRunSql(const std::string &row)
+{
+    return withRow(R"(
+        UPDATE history_summary SET
+            run_count = run_count - 1, total_keys = total_keys - %1.total_keys,
+            valid_keys = valid_keys - %1.valid_keys, invalid_keys = invalid_keys - %1.invalid_keys,
+            error_keys = error_keys - %1.error_keys, total_duration = total_duration - %1.duration
+        WHERE id = 1;
+        UPDATE history_daily_stats SET
+            run_count = run_count - 1, total_keys = total_keys - %1.total_keys,
+            valid_keys = valid_keys - %1.valid_keys, invalid_keys = invalid_keys - %1.invalid_keys,
+            error_keys = error_keys - %1.error_keys, total_duration = total_duration - %1.duration
+        WHERE day = substr(%1.start_time, 1, 10);
+        DELETE FROM history_daily_stats WHERE day = substr(%1.start_time, 1, 10) AND run_count = 0;
+        UPDATE history_endpoint_stats SET
+            run_count = run_count - 1, total_keys = total_keys - %1.total_keys,
+            valid_keys = valid_keys - %1.valid_keys, total_duration = total_duration - %1.duration,
+            speed_sum = speed_sum - %1.avg_speed
+        WHERE api_endpoint = %1.api_endpoint;
+        DELETE FROM history_endpoint_stats WHERE api_endpoint = %1.api_endpoint AND run_count = 0;
+    )", row);
+}
+
+// key_lifecycle 的合并规则：时间都取更早/更晚的一方，与写入顺序无关（恢复的检测会补写较早的结果）
+const char *const KEY_LIFECYCLE_UPSERT = R"(
+    ON CONFLICT (key_fp) DO UPDATE SET
+        api_key = excluded.api_key,
+        first_seen = MIN(first_seen, excluded.first_seen),
+        last_checked = MAX(last_checked, excluded.last_checked),
+        last_status = CASE WHEN excluded.last_checked >= last_checked
+                           THEN excluded.last_status ELSE last_status END,
+        last_valid = COALESCE(MAX(last_valid, excluded.last_valid), last_valid, excluded.last_valid),
+        last_invalidated = COALESCE(MAX(last_invalidated, excluded.last_invalidated),
+                                    last_invalidated, excluded.last_invalidated)
+)";
+
+} // namespace
+
+const std::vector<std::string> &HistorySchema::tableStatements()
+{
+    static const std::vector<std::string> statements = {
+        R"(
+            CREATE TABLE IF NOT EXISTS history (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                start_time TEXT NOT NULL,
+                end_time TEXT NOT NULL,
+                input_file TEXT,
+                total_keys INTEGER NOT NULL,
+                valid_keys INTEGER NOT NULL,
+                invalid_keys INTEGER NOT NULL,
+                error_keys INTEGER NOT NULL,
+                duration REAL NOT NULL,
+                avg_speed REAL NOT NULL,
+                api_endpoint TEXT NOT NULL,
+                created_at TEXT DEFAULT CURRENT_TIMESTAMP
+            )
+        )",
+        // status: 0 有效, 1 无效, 2 错误；checked_at 为Unix时间戳（毫秒）
+        R"(
+            CREATE TABLE IF NOT EXISTS results (
+                run_id INTEGER NOT NULL REFERENCES history(id) ON DELETE CASCADE,
+                key_fp INTEGER NOT NULL,
+                api_key TEXT NOT NULL,
+                status INTEGER NOT NULL,
+                message_code INTEGER NOT NULL,
+                http_status INTEGER NOT NULL,
+                response_ms INTEGER NOT NULL,
+                checked_at INTEGER NOT NULL,
+                message TEXT,
+                PRIMARY KEY (run_id, key_fp)
+            )
+        )",
+        // 历史页按开始时间排序翻页、按API端点筛选
+        "CREATE INDEX IF NOT EXISTS idx_history_start_time ON history(start_time)",
+        "CREATE INDEX IF NOT EXISTS idx_history_api_endpoint ON history(api_endpoint)",
+    };
+    return statements;
+}
+
+// 汇总表：总计一行、按天（start_time 的日期部分）和按API端点各一行，
+// 由 history 上的触发器增量维护，统计标签和趋势只读这几张小表
+const std::vector<std::string> &HistorySchema::aggregateStatements()
+{
+    static const std::vector<std::string> statements = {
+        R"(
+            CREATE TABLE IF NOT EXISTS history_summary (
+                id INTEGER PRIMARY KEY CHECK (id = 1),
+                run_count INTEGER NOT NULL,
+                total_keys INTEGER NOT NULL,
+                valid_keys INTEGER NOT NULL,
+                invalid_keys INTEGER NOT NULL,
+                error_keys INTEGER NOT NULL,
+                total_duration REAL NOT NULL
+            )
+        )",
+        R"(
+            CREATE TABLE IF NOT EXISTS history_daily_stats (
+                day TEXT PRIMARY KEY,
+                run_count INTEGER NOT NULL,
+                total_keys INTEGER NOT NULL,
+                valid_keys INTEGER NOT NULL,
+                invalid_keys INTEGER NOT NULL,
+                error_keys INTEGER NOT NULL,
+                total_duration REAL NOT NULL
+            ) WITHOUT ROWID
+        )",
+        // speed_sum 为各次检测平均速度之和，除以 run_count 得到该端点的平均速度
+        R"(
+            CREATE TABLE IF NOT EXISTS history_endpoint_stats (
+                api_endpoint TEXT PRIMARY KEY,
+                run_count INTEGER NOT NULL,
+                total_keys INTEGER NOT NULL,
+                valid_keys INTEGER NOT NULL,
+                total_duration REAL NOT NULL,
+                speed_sum REAL NOT NULL
+            ) WITHOUT ROWID
+        )",
+        "CREATE TRIGGER IF NOT EXISTS history_stats_insert AFTER INSERT ON history BEGIN "
+            + addRunSql("new") + " END",
+        "CREATE TRIGGER IF NOT EXISTS history_stats_delete AFTER DELETE ON history BEGIN "
+            + removeRunSql("old") + " END",
+        // 检测开始时插入的记录计数为0，结束时更新为最终结果
+        "CREATE TRIGGER IF NOT EXISTS history_stats_update AFTER UPDATE OF start_time, total_keys, "
+        "valid_keys, invalid_keys, error_keys, duration, avg_speed, api_endpoint ON history BEGIN "
+            + removeRunSql("old") + addRunSql("new") + " END",
+    };
+    return statements;
+}
+
+// 第一次创建汇总表时从已有的历史记录计算初值
+const std::vector<std::string> &HistorySchema::aggregateBackfillStatements()
+{
+    static const std::vector<std::string> statements = {
+        R"(
+            INSERT INTO history_summary
+            SELECT 1, COUNT(*), COALESCE(SUM(total_keys), 0), COALESCE(SUM(valid_keys), 0),
+                   COALESCE(SUM(invalid_keys), 0), COALESCE(SUM(error_keys), 0),
+                   COALESCE(SUM(duration), 0)
+            FROM history
+        )",
+        R"(
+            INSERT INTO history_daily_stats
+            SELECT substr(start_time, 1, 10), COUNT(*), SUM(total_keys), SUM(valid_keys),
+                   SUM(invalid_keys), SUM(error_keys), SUM(duration)
+            FROM history GROUP BY 1
+        )",
+        R"(
+            INSERT INTO history_endpoint_stats
+            SELECT api_endpoint, COUNT(*), SUM(total_keys), SUM(valid_keys), SUM(duration),
+                   SUM(avg_speed)
+            FROM history GROUP BY 1
+        )",
+    };
+    return statements;
+}
+
+// 每个key跨检测的生命周期，时间均为Unix时间戳（毫秒），从未有效/无效过时为NULL
+// key_fp 即rowid，按时间范围查询key_fp时只读索引
+const std::vector<std::string> &HistorySchema::keyLifecycleStatements()
+{
+    static const std::vector<std::string> statements = {
+        R"(
+            CREATE TABLE IF NOT EXISTS key_lifecycle (
+                key_fp INTEGER PRIMARY KEY,
+                api_key TEXT NOT NULL,
+                first_seen INTEGER NOT NULL,
+                last_checked INTEGER NOT NULL,
+                last_status INTEGER NOT NULL,
+                last_valid INTEGER,
+                last_invalidated INTEGER
+            )
+        )",
+        // "上周有效、今天失效" 这类查询从任一时间列的范围开始，另一列在同一索引中过滤
+        "CREATE INDEX IF NOT EXISTS idx_key_lifecycle_first_seen ON key_lifecycle(first_seen)",
+        "CREATE INDEX IF NOT EXISTS idx_key_lifecycle_last_valid ON key_lifecycle(last_valid, last_invalidated)",
+        "CREATE INDEX IF NOT EXISTS idx_key_lifecycle_last_invalidated "
+        "ON key_lifecycle(last_invalidated, last_valid)",
+    };
+    return statements;
+}
+
+std::string HistorySchema::keyLifecycleBackfillSql()
+{
+    // WHERE true 让 ON CONFLICT 不被解析为连接条件
+    return std::string(R"(
+        INSERT INTO key_lifecycle (key_fp, api_key, first_seen, last_checked, last_status,
+                                   last_valid, last_invalidated)
+        SELECT key_fp, api_key, checked_at, checked_at, status,
+               CASE WHEN status = 0 THEN checked_at END,
+               CASE WHEN status = 1 THEN checked_at END
+        FROM results WHERE true ORDER BY checked_at
+    )") + KEY_LIFECYCLE_UPSERT;
+}
+
+std::string HistorySchema::keyLifecycleUpsertSql()
+{
+    return std::string(R"(
+        INSERT INTO key_lifecycle (key_fp, api_key, first_seen, last_checked, last_status,
+                                   last_valid, last_invalidated)
+        VALUES (?, ?, ?, ?, ?, ?, ?)
+    )") + KEY_LIFECYCLE_UPSERT;
+}
+
+// 全文索引：外部内容表，只保存索引不重复保存文本，由触发器与 history/results 同步
+// trigram 分词按任意连续3个字符建索引，支持中文和key的任意片段（子串）匹配
+const std::vector<std::string> &HistorySchema::fullTextStatements()
+{
+    static const std::vector<std::string> statements = {
+        R"(
+            CREATE VIRTUAL TABLE IF NOT EXISTS history_fts USING fts5(
+                input_file, api_endpoint, start_time,
+                content='history', content_rowid='id', tokenize='trigram'
+            )
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS history_fts_insert AFTER INSERT ON history BEGIN
+                INSERT INTO history_fts(rowid, input_file, api_endpoint, start_time)
+                VALUES (new.id, new.input_file, new.api_endpoint, new.start_time);
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS history_fts_delete AFTER DELETE ON history BEGIN
+                INSERT INTO history_fts(history_fts, rowid, input_file, api_endpoint, start_time)
+                VALUES ('delete', old.id, old.input_file, old.api_endpoint, old.start_time);
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS history_fts_update AFTER UPDATE OF input_file, api_endpoint, start_time ON history BEGIN
+                INSERT INTO history_fts(history_fts, rowid, input_file, api_endpoint, start_time)
+                VALUES ('delete', old.id, old.input_file, old.api_endpoint, old.start_time);
+                INSERT INTO history_fts(rowid, input_file, api_endpoint, start_time)
+                VALUES (new.id, new.input_file, new.api_endpoint, new.start_time);
+            END
+        )",
+        R"(
+            CREATE VIRTUAL TABLE IF NOT EXISTS results_fts USING fts5(
+                api_key, message,
+                content='results', content_rowid='rowid', tokenize='trigram'
+            )
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS results_fts_insert AFTER INSERT ON results BEGIN
+                INSERT INTO results_fts(rowid, api_key, message)
+                VALUES (new.rowid, new.api_key, new.message);
+            END
+        )",
+        // 删除检测时级联删除的结果行同样会触发
+        R"(
+            CREATE TRIGGER IF NOT EXISTS results_fts_delete AFTER DELETE ON results BEGIN
+                INSERT INTO results_fts(results_fts, rowid, api_key, message)
+                VALUES ('delete', old.rowid, old.api_key, old.message);
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS results_fts_update AFTER UPDATE OF api_key, message ON results BEGIN
+                INSERT INTO results_fts(results_fts, rowid, api_key, message)
+                VALUES ('delete', old.rowid, old.api_key, old.message);
+                INSERT INTO results_fts(rowid, api_key, message)
+                VALUES (new.rowid, new.api_key, new.message);
+            END
+        )",
+    };
+    return statements;
+}
+
+// 已有数据的数据库第一次建索引时需要从内容表重建
+const std::vector<std::string> &HistorySchema::fullTextRebuildStatements()
+{
+    static const std::vector<std::string> statements = {
+        "INSERT INTO history_fts(history_fts) VALUES ('rebuild')",
+        "INSERT INTO results_fts(results_fts) VALUES ('rebuild')",
+    };
+    return statements;
+}
+
+std::string HistorySchema::resultUpsertSql()
+{
+    // 用 UPSERT 而不是 INSERT OR REPLACE：REPLACE 删除旧行时不触发删除触发器，全文索引会残留旧条目
+    return R"(
+        INSERT INTO results (run_id, key_fp, api_key, status, message_code,
+                             http_status, response_ms, checked_at, message)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT (run_id, key_fp) DO UPDATE SET
+            api_key = excluded.api_key, status = excluded.status,
+            message_code = excluded.message_code, http_status = excluded.http_status,
+            response_ms = excluded.response_ms, checked_at = excluded.checked_at,
+            message = excluded.message
+    )";
+}
+
+std::string HistorySchema::insertRunSql()
+{
+    return R"(
+        INSERT INTO history (start_time, end_time, input_file, total_keys,
+                          valid_keys, invalid_keys, error_keys, duration,
+                          avg_speed, api_endpoint)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )";
+}
+
+std::string HistorySchema::updateRunSql()
+{
+    return R"(
+        UPDATE history SET end_time = ?, total_keys = ?, valid_keys = ?, invalid_keys = ?,
+                           error_keys = ?, duration = ?, avg_speed = ?
+        WHERE id = ?
+    )";
+}
+
+std::string HistorySchema::expiredRunsSql(bool byAge, bool byRunCount, bool byResultRows)
+{
+    // 各策略分别选出要删除的检测再取并集；id 随开始时间递增，按 id 从旧到新删除
+    std::vector<std::string> selects;
+    if (byAge) {
+        // start_time 为本地时间的ISO字符串，可以直接按字符串比较，走 start_time 索引
+        selects.push_back("SELECT id FROM history WHERE start_time < ?");
+    }
+    if (byRunCount) {
+        selects.push_back("SELECT id FROM (SELECT id FROM history ORDER BY id DESC LIMIT -1 OFFSET ?)");
+    }
+    if (byResultRows) {
+        // 从最新的检测往前累计key数，超过上限的检测被删除；最新的一次总是保留
+        selects.push_back("SELECT id FROM (SELECT id, SUM(total_keys) OVER (ORDER BY id DESC) AS kept "
+                          "FROM history) WHERE kept > ? AND id < (SELECT MAX(id) FROM history)");
+    }
+    if (selects.empty()) {
+        return std::string();
+    }
+
+    std::string sql;
+    for (const std::string &select : selects) {
+        sql += sql.empty() ? select : " UNION " + select;
+    }
+    return sql + " ORDER BY id";
+}
+
+std::string HistorySchema::deleteResultsChunkSql()
+{
+    return "DELETE FROM results WHERE rowid IN (SELECT rowid FROM results WHERE run_id = ? LIMIT ?)";
+}
+
+std::string HistorySchema::deleteRunSql()
+{
+    return "DELETE FROM history WHERE id = ?";
+}
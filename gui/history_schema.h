@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 历史数据库的建表语句、触发器和维护查询
+// 只有SQL文本，不依赖Qt，HistoryDatabase / ResultDbWriter / HistoryMaintenance 通过它执行，
+// 单元测试直接在SQLite内存数据库上验证
+class HistorySchema
+{
+public:
+    // history / results 表和索引
+    static const std::vector<std::string> &tableStatements();
+
+    // 汇总表和维护它们的触发器；第一次创建汇总表时再执行 aggregateBackfillStatements 计算初值
+    static const std::vector<std::string> &aggregateStatements();
+    static const std::vector<std::string> &aggregateBackfillStatements();
+
+    // key_lifecycle 表和索引；第一次创建时执行 keyLifecycleBackfillSql 从已有的 results 汇总
+    static const std::vector<std::string> &keyLifecycleStatements();
+    static std::string keyLifecycleBackfillSql();
+    // 合并一条结果到 key_lifecycle 的语句，参数依次为
+    // key_fp, api_key, first_seen, last_checked, last_status, last_valid, last_invalidated
+    static std::string keyLifecycleUpsertSql();
+
+    // 全文索引（FTS5 trigram）和同步触发器；SQLite未编译FTS5时执行失败
+    static const std::vector<std::string> &fullTextStatements();
+    static const std::vector<std::string> &fullTextRebuildStatements();
+
+    // 写入一条检测结果，参数依次为 run_id, key_fp, api_key, status, message_code,
+    // http_status, response_ms, checked_at, message；同一次检测中重复的key保留最后的结果
+    static std::string resultUpsertSql();
+
+    static std::string insertRunSql();
+    static std::string updateRunSql();
+
+    // 按保留策略选出要删除的检测id（旧的在前），参数按启用的策略依次为
+    // 最早保留的开始时间、最多保留的检测次数、最多保留的结果行数；没有启用的策略时返回空串
+    static std::string expiredRunsSql(bool byAge, bool byRunCount, bool byResultRows);
+    // 删除一次检测的一批结果，参数为 run_id 和每批行数
+    static std::string deleteResultsChunkSql();
+    static std::string deleteRunSql();
+};
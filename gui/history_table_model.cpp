@@ -0,0 +1,247 @@
+#include "history_table_model.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace {
+
+// 各列的排序表达式；input_file 可能为NULL，翻页比较时按空字符串处理
+const char *const SORT_EXPRESSIONS[HistoryTableModel::ColumnCount] = {
+    "id", "start_time", "end_time", "COALESCE(input_file, '')", "total_keys",
+    "valid_keys", "invalid_keys", "error_keys", "api_endpoint"
+};
+
+const char *const SELECT_COLUMNS =
+    "id, start_time, end_time, input_file, total_keys, valid_keys, invalid_keys, "
+    "error_keys, duration, avg_speed, api_endpoint";
+
+HistoryRecord readRecord(const QSqlQuery &query)
+{
+    HistoryRecord record;
+    record.id = query.value(0).toInt();
+    record.startTime = QDateTime::fromString(query.value(1).toString(), Qt::ISODate);
+    record.endTime = QDateTime::fromString(query.value(2).toString(), Qt::ISODate);
+    record.inputFile = query.value(3).toString();
+    record.totalKeys = query.value(4).toInt();
+    record.validKeys = query.value(5).toInt();
+    record.invalidKeys = query.value(6).toInt();
+    record.errorKeys = query.value(7).toInt();
+    record.duration = query.value(8).toDouble();
+    record.avgSpeed = query.value(9).toDouble();
+    record.apiEndpoint = query.value(10).toString();
+    return record;
+}
+
+// LIKE 模式中转义通配符，搜索文本按字面匹配
+QString likePattern(const QString &text)
+{
+    QString escaped = text;
+    escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' + escaped + '%';
+}
+
+} // namespace
+
+HistoryTableModel::HistoryTableModel(const QSqlDatabase &database, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_database(database)
+    , m_hasMore(false)
+    , m_sortColumn(StartTimeColumn)
+    , m_sortOrder(Qt::DescendingOrder)
+    , m_lastId(0)
+{
+    m_fullText = m_database.isOpen() && HistoryDatabase::hasFullTextSearch(m_database);
+}
+
+bool HistoryTableModel::useFullText() const
+{
+    // 太短的搜索文本无法用trigram索引，历史表行数不多，退回逐行LIKE
+    return m_fullText && m_searchText.size() >= HistoryDatabase::MIN_FULL_TEXT_LENGTH;
+}
+
+void HistoryTableModel::reload()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_lastSortValue.clear();
+    m_lastId = 0;
+    m_hasMore = m_database.isOpen();
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+void HistoryTableModel::setSearchText(const QString &text)
+{
+    if (text.trimmed() == m_searchText) {
+        return;
+    }
+    m_searchText = text.trimmed();
+    reload();
+}
+
+void HistoryTableModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= ColumnCount) {
+        return;
+    }
+    m_sortColumn = column;
+    m_sortOrder = order;
+    reload();
+}
+
+QString HistoryTableModel::selectSql(bool afterLastRow) const
+{
+    const QString sortExpr = SORT_EXPRESSIONS[m_sortColumn];
+    const bool descending = m_sortOrder == Qt::DescendingOrder;
+    const QString direction = descending ? "DESC" : "ASC";
+    const QString op = descending ? "<" : ">";
+
+    QStringList conditions;
+    if (useFullText()) {
+        conditions << "id IN (SELECT rowid FROM history_fts WHERE history_fts MATCH :match)";
+    } else if (!m_searchText.isEmpty()) {
+        conditions << "(COALESCE(input_file, '') LIKE :pattern1 ESCAPE '\\' OR "
+                      "api_endpoint LIKE :pattern2 ESCAPE '\\' OR "
+                      "start_time LIKE :pattern3 ESCAPE '\\')";
+    }
+    if (afterLastRow) {
+        if (m_sortColumn == IdColumn) {
+            conditions << QString("id %1 :last_id").arg(op);
+        } else {
+            // 行值比较，可直接在 (排序列, id) 索引上定位
+            conditions << QString("(%1, id) %2 (:last_value, :last_id)").arg(sortExpr, op);
+        }
+    }
+
+    QString sql = QString("SELECT %1, %2 FROM history").arg(SELECT_COLUMNS, sortExpr);
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += QString(" ORDER BY %1 %2").arg(sortExpr, direction);
+    if (m_sortColumn != IdColumn) {
+        sql += QString(", id %1").arg(direction);
+    }
+    sql += QString(" LIMIT %1").arg(PAGE_SIZE);
+    return sql;
+}
+
+bool HistoryTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_hasMore;
+}
+
+void HistoryTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || !m_hasMore) {
+        return;
+    }
+
+    const bool afterLastRow = !m_rows.isEmpty();
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare(selectSql(afterLastRow));
+    if (useFullText()) {
+        query.bindValue(":match", HistoryDatabase::fullTextQuery(m_searchText));
+    } else if (!m_searchText.isEmpty()) {
+        const QString pattern = likePattern(m_searchText);
+        query.bindValue(":pattern1", pattern);
+        query.bindValue(":pattern2", pattern);
+        query.bindValue(":pattern3", pattern);
+    }
+    if (afterLastRow) {
+        query.bindValue(":last_id", m_lastId);
+        if (m_sortColumn != IdColumn) {
+            query.bindValue(":last_value", m_lastSortValue);
+        }
+    }
+
+    if (!query.exec()) {
+        qWarning() << "读取历史记录失败:" << query.lastError().text();
+        m_hasMore = false;
+        return;
+    }
+
+    QVector<HistoryRecord> page;
+    page.reserve(PAGE_SIZE);
+    while (query.next()) {
+        page.append(readRecord(query));
+        m_lastSortValue = query.value(11);
+        m_lastId = query.value(0).toLongLong();
+    }
+    m_hasMore = page.size() == PAGE_SIZE;
+
+    if (page.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + page.size() - 1);
+    m_rows += page;
+    endInsertRows();
+}
+
+void HistoryTableModel::forEachRecord(const std::function<void(const HistoryRecord &)> &fn) const
+{
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM history ORDER BY start_time DESC").arg(SELECT_COLUMNS))) {
+        qWarning() << "读取历史记录失败:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        fn(readRecord(query));
+    }
+}
+
+int HistoryTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int HistoryTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant HistoryTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const HistoryRecord &record = m_rows[index.row()];
+    switch (index.column()) {
+        case IdColumn:
+            return record.id;
+        case StartTimeColumn:
+            return record.startTime.toString("yyyy-MM-dd hh:mm:ss");
+        case EndTimeColumn:
+            return record.endTime.toString("yyyy-MM-dd hh:mm:ss");
+        case InputFileColumn:
+            return record.inputFile;
+        case TotalColumn:
+            return record.totalKeys;
+        case ValidColumn:
+            return record.validKeys;
+        case InvalidColumn:
+            return record.invalidKeys;
+        case ErrorColumn:
+            return record.errorKeys;
+        case EndpointColumn:
+            return record.apiEndpoint;
+        default:
+            return QVariant();
+    }
+}
+
+QVariant HistoryTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    static const QStringList headers = {
+        "ID", "开始时间", "结束时间", "输入文件",
+        "总数", "有效", "无效", "错误", "API端点"
+    };
+    return section >= 0 && section < headers.size() ? headers[section] : QVariant();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QSqlDatabase>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+#include "history_database.h"
+
+// 历史记录表格模型：按页从数据库读取，滚动到末尾时再读取下一页
+// 排序和搜索都在SQL中完成，翻页按 (排序列, id) 定位上一页的最后一行（而不是OFFSET），
+// 有索引的列无论翻到哪一页都只读取本页的行；搜索优先使用 history_fts 全文索引
+class HistoryTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PAGE_SIZE = 200;
+
+    enum Column {
+        IdColumn,
+        StartTimeColumn,
+        EndTimeColumn,
+        InputFileColumn,
+        TotalColumn,
+        ValidColumn,
+        InvalidColumn,
+        ErrorColumn,
+        EndpointColumn,
+        ColumnCount
+    };
+
+    explicit HistoryTableModel(const QSqlDatabase &database, QObject *parent = nullptr);
+
+    // 丢弃已读取的行，按当前排序和搜索条件重新读取第一页
+    void reload();
+    void setSearchText(const QString &text);
+    QString searchText() const { return m_searchText; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    const HistoryRecord &record(int row) const { return m_rows[row]; }
+
+    // 按开始时间倒序逐行读取全部记录（不受搜索条件限制），不加载到模型中（用于导出）
+    void forEachRecord(const std::function<void(const HistoryRecord &)> &fn) const;
+
+private:
+    QString selectSql(bool afterLastRow) const;
+    bool useFullText() const;
+
+    QSqlDatabase m_database;
+    QVector<HistoryRecord> m_rows;
+    bool m_hasMore;
+    bool m_fullText;
+
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    QString m_searchText;
+
+    // 已读取的最后一行的排序值和id，下一页从其后开始
+    QVariant m_lastSortValue;
+    qint64 m_lastId;
+};
@@ -11,9 +11,16 @@
 #include <QDialog>
 #include <QFormLayout>
 #include <QLabel>
+#include <QTableWidget>
+#include <QDebug>
+#include <algorithm>
+#include "progress_index.h"
+#include "progress_journal.h"
 
 HistoryWidget::HistoryWidget(QWidget *parent)
     : QWidget(parent)
+    , m_maintenance(nullptr)
+    , m_detectionRunning(false)
 {
     initDatabase();
     setupUi();
@@ -30,36 +37,10 @@ HistoryWidget::~HistoryWidget()
 
 void HistoryWidget::initDatabase()
 {
-    m_database = QSqlDatabase::addDatabase("QSQLITE", "history_connection");
-    m_database.setDatabaseName("api_checker_history.db");
-
-    if (!m_database.open()) {
-        QMessageBox::critical(this, "数据库错误",
-            "无法打开历史数据库: " + m_database.lastError().text());
-        return;
-    }
-
-    QSqlQuery query(m_database);
-    QString createTableSql = R"(
-        CREATE TABLE IF NOT EXISTS history (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            start_time TEXT NOT NULL,
-            end_time TEXT NOT NULL,
-            input_file TEXT,
-            total_keys INTEGER NOT NULL,
-            valid_keys INTEGER NOT NULL,
-            invalid_keys INTEGER NOT NULL,
-            error_keys INTEGER NOT NULL,
-            duration REAL NOT NULL,
-            avg_speed REAL NOT NULL,
-            api_endpoint TEXT NOT NULL,
-            created_at TEXT DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-
-    if (!query.exec(createTableSql)) {
-        QMessageBox::critical(this, "数据库错误",
-            "无法创建历史表: " + query.lastError().text());
+    QString errorMessage;
+    m_database = HistoryDatabase::open("history_connection", &errorMessage);
+    if (!errorMessage.isEmpty()) {
+        QMessageBox::critical(this, "数据库错误", errorMessage);
     }
 }
 
@@ -85,31 +66,58 @@ void HistoryWidget::setupUi()
     QHBoxLayout *searchLayout = new QHBoxLayout(searchGroup);
 
     m_searchEdit = new QLineEdit(this);
-    m_searchEdit->setPlaceholderText("搜索历史记录...");
+    m_searchEdit->setPlaceholderText("搜索历史记录和key、结果消息...");
 
     searchLayout->addWidget(m_searchEdit);
 
-    m_historyTable = new QTableWidget(this);
-    m_historyTable->setColumnCount(9);
-    m_historyTable->setHorizontalHeaderLabels({
-        "ID", "开始时间", "结束时间", "输入文件",
-        "总数", "有效", "无效", "错误", "API端点"
-    });
-    m_historyTable->horizontalHeader()->setStretchLastSection(true);
-    m_historyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_historyTable->setSelectionMode(QAbstractItemView::SingleSelection);
-    m_historyTable->setAlternatingRowColors(true);
-    m_historyTable->setSortingEnabled(true);
-
-    m_historyTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(6, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(7, QHeaderView::ResizeToContents);
-    m_historyTable->horizontalHeader()->setSectionResizeMode(8, QHeaderView::Stretch);
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(300);
+
+    m_maintenanceTimer = new QTimer(this);
+    m_maintenanceTimer->setSingleShot(true);
+
+    // 模型按页读取，排序由模型在SQL中完成
+    m_historyModel = new HistoryTableModel(m_database, this);
+    m_historyView = new QTableView(this);
+    m_historyView->setModel(m_historyModel);
+    m_historyView->horizontalHeader()->setStretchLastSection(true);
+    m_historyView->horizontalHeader()->setSortIndicator(HistoryTableModel::StartTimeColumn,
+                                                        Qt::DescendingOrder);
+    m_historyView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_historyView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_historyView->setAlternatingRowColors(true);
+    m_historyView->setSortingEnabled(true);
+
+    m_historyView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    m_historyView->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(6, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(7, QHeaderView::ResizeToContents);
+    m_historyView->horizontalHeader()->setSectionResizeMode(8, QHeaderView::Stretch);
+
+    // 匹配的检测结果在后台查询，边查边显示
+    m_resultSearchGroup = new QGroupBox("匹配的检测结果", this);
+    QVBoxLayout *resultSearchLayout = new QVBoxLayout(m_resultSearchGroup);
+
+    m_resultSearchLabel = new QLabel(this);
+    m_resultSearchModel = new ResultSearchModel(this);
+    m_resultSearchView = new QTableView(this);
+    m_resultSearchView->setModel(m_resultSearchModel);
+    m_resultSearchView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_resultSearchView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultSearchView->setAlternatingRowColors(true);
+    m_resultSearchView->horizontalHeader()->setStretchLastSection(true);
+    m_resultSearchView->horizontalHeader()->setSectionResizeMode(ResultSearchModel::KeyColumn,
+                                                                QHeaderView::Stretch);
+
+    resultSearchLayout->addWidget(m_resultSearchLabel);
+    resultSearchLayout->addWidget(m_resultSearchView);
+    m_resultSearchGroup->setVisible(false);
 
     QGroupBox *actionGroup = new QGroupBox("操作", this);
     QHBoxLayout *actionLayout = new QHBoxLayout(actionGroup);
@@ -119,17 +127,20 @@ void HistoryWidget::setupUi()
     m_exportButton = new QPushButton("📥 导出选中", this);
     m_exportAllButton = new QPushButton("📥 导出全部", this);
     m_resumeButton = new QPushButton("▶️ 恢复检测", this);
+    m_trendsButton = new QPushButton("📈 趋势统计", this);
 
     actionLayout->addWidget(m_refreshButton);
     actionLayout->addWidget(m_deleteButton);
     actionLayout->addWidget(m_exportButton);
     actionLayout->addWidget(m_exportAllButton);
     actionLayout->addWidget(m_resumeButton);
+    actionLayout->addWidget(m_trendsButton);
     actionLayout->addStretch();
 
     mainLayout->addWidget(statsGroup);
     mainLayout->addWidget(searchGroup);
-    mainLayout->addWidget(m_historyTable);
+    mainLayout->addWidget(m_historyView, 2);
+    mainLayout->addWidget(m_resultSearchGroup, 1);
     mainLayout->addWidget(actionGroup);
 }
 
@@ -140,104 +151,62 @@ void HistoryWidget::connectSignals()
     connect(m_exportButton, &QPushButton::clicked, this, &HistoryWidget::onExportSelected);
     connect(m_exportAllButton, &QPushButton::clicked, this, &HistoryWidget::onExportAll);
     connect(m_resumeButton, &QPushButton::clicked, this, &HistoryWidget::showResumeDialog);
+    connect(m_trendsButton, &QPushButton::clicked, this, &HistoryWidget::showTrends);
     connect(m_searchEdit, &QLineEdit::textChanged, this, &HistoryWidget::onSearchTextChanged);
-    connect(m_historyTable, &QTableWidget::itemSelectionChanged,
+    connect(m_searchTimer, &QTimer::timeout, this, &HistoryWidget::startSearch);
+    connect(m_maintenanceTimer, &QTimer::timeout, this, &HistoryWidget::startMaintenance);
+    m_maintenanceTimer->start(MAINTENANCE_IDLE_DELAY_MS);
+    connect(m_resultSearchModel, &QAbstractItemModel::rowsInserted,
+            this, &HistoryWidget::updateResultSearchStatus);
+    connect(m_resultSearchModel, &ResultSearchModel::searchFinished,
+            this, [this](int matches, bool truncated) {
+        m_resultSearchLabel->setText(truncated
+            ? QString("匹配超过 %1 条，只显示最近的 %1 条").arg(matches)
+            : QString("匹配 %1 条").arg(matches));
+    });
+    connect(m_resultSearchModel, &ResultSearchModel::searchFailed,
+            m_resultSearchLabel, &QLabel::setText);
+    connect(m_historyView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &HistoryWidget::onSelectionChanged);
+    connect(m_historyView, &QTableView::doubleClicked, this, &HistoryWidget::onViewDetails);
 }
 
 void HistoryWidget::loadHistory()
 {
-    m_historyRecords.clear();
-
-    QSqlQuery query(m_database);
-    query.exec("SELECT * FROM history ORDER BY start_time DESC");
-
-    while (query.next()) {
-        HistoryRecord record;
-        record.id = query.value("id").toInt();
-        record.startTime = QDateTime::fromString(query.value("start_time").toString(), Qt::ISODate);
-        record.endTime = QDateTime::fromString(query.value("end_time").toString(), Qt::ISODate);
-        record.inputFile = query.value("input_file").toString();
-        record.totalKeys = query.value("total_keys").toInt();
-        record.validKeys = query.value("valid_keys").toInt();
-        record.invalidKeys = query.value("invalid_keys").toInt();
-        record.errorKeys = query.value("error_keys").toInt();
-        record.duration = query.value("duration").toDouble();
-        record.avgSpeed = query.value("avg_speed").toDouble();
-        record.apiEndpoint = query.value("api_endpoint").toString();
-
-        m_historyRecords.append(record);
-    }
-
-    populateTable();
+    m_historyModel->reload();
     updateStatistics();
+    onSelectionChanged();
 }
 
-void HistoryWidget::populateTable()
+void HistoryWidget::updateStatistics()
 {
-    m_historyTable->setRowCount(m_historyRecords.size());
-
-    for (int row = 0; row < m_historyRecords.size(); ++row) {
-        const auto &record = m_historyRecords[row];
-
-        m_historyTable->setItem(row, 0, new QTableWidgetItem(QString::number(record.id)));
-        m_historyTable->setItem(row, 1, new QTableWidgetItem(
-            record.startTime.toString("yyyy-MM-dd hh:mm:ss")));
-        m_historyTable->setItem(row, 2, new QTableWidgetItem(
-            record.endTime.toString("yyyy-MM-dd hh:mm:ss")));
-        m_historyTable->setItem(row, 3, new QTableWidgetItem(record.inputFile));
-        m_historyTable->setItem(row, 4, new QTableWidgetItem(QString::number(record.totalKeys)));
-        m_historyTable->setItem(row, 5, new QTableWidgetItem(QString::number(record.validKeys)));
-        m_historyTable->setItem(row, 6, new QTableWidgetItem(QString::number(record.invalidKeys)));
-        m_historyTable->setItem(row, 7, new QTableWidgetItem(QString::number(record.errorKeys)));
-        m_historyTable->setItem(row, 8, new QTableWidgetItem(record.apiEndpoint));
-
-        for (int col = 0; col < 9; ++col) {
-            if (auto item = m_historyTable->item(row, col)) {
-                item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-            }
-        }
+    // 汇总由触发器维护，只读一行，与历史记录数量无关
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT run_count, total_keys, valid_keys FROM history_summary WHERE id = 1") ||
+        !query.next()) {
+        return;
     }
+
+    m_totalRecordsLabel->setText(QString("总记录: %1").arg(query.value(0).toLongLong()));
+    m_totalKeysLabel->setText(QString("总检测: %1").arg(query.value(1).toLongLong()));
+    m_totalValidLabel->setText(QString("总有效: %1").arg(query.value(2).toLongLong()));
 }
 
-void HistoryWidget::updateStatistics()
+bool HistoryWidget::currentRecord(HistoryRecord &record) const
 {
-    m_totalRecordsLabel->setText(QString("总记录: %1").arg(m_historyRecords.size()));
-
-    int totalKeys = 0, totalValid = 0;
-    for (const auto &record : m_historyRecords) {
-        totalKeys += record.totalKeys;
-        totalValid += record.validKeys;
+    QModelIndex current = m_historyView->selectionModel()->currentIndex();
+    if (!current.isValid() || !m_historyView->selectionModel()->isRowSelected(current.row(), QModelIndex())) {
+        return false;
     }
-
-    m_totalKeysLabel->setText(QString("总检测: %1").arg(totalKeys));
-    m_totalValidLabel->setText(QString("总有效: %1").arg(totalValid));
+    record = m_historyModel->record(current.row());
+    return true;
 }
 
 void HistoryWidget::addRecord(const HistoryRecord &record)
 {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
-        INSERT INTO history (start_time, end_time, input_file, total_keys,
-                          valid_keys, invalid_keys, error_keys, duration,
-                          avg_speed, api_endpoint)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-
-    query.addBindValue(record.startTime.toString(Qt::ISODate));
-    query.addBindValue(record.endTime.toString(Qt::ISODate));
-    query.addBindValue(record.inputFile);
-    query.addBindValue(record.totalKeys);
-    query.addBindValue(record.validKeys);
-    query.addBindValue(record.invalidKeys);
-    query.addBindValue(record.errorKeys);
-    query.addBindValue(record.duration);
-    query.addBindValue(record.avgSpeed);
-    query.addBindValue(record.apiEndpoint);
-
-    if (!query.exec()) {
-        QMessageBox::critical(this, "数据库错误",
-            "无法保存历史记录: " + query.lastError().text());
+    QString errorMessage;
+    if (HistoryDatabase::insertRun(m_database, record, &errorMessage) < 0) {
+        QMessageBox::critical(this, "数据库错误", errorMessage);
         return;
     }
 
@@ -251,13 +220,20 @@ void HistoryWidget::clearAllHistory()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
+        // key_lifecycle 不随检测级联删除，清除全部历史时一并清空
         QSqlQuery query(m_database);
-        if (!query.exec("DELETE FROM history")) {
+        if (!query.exec("DELETE FROM history") || !query.exec("DELETE FROM key_lifecycle")) {
             QMessageBox::critical(this, "数据库错误",
                 "无法清除历史记录: " + query.lastError().text());
             return;
         }
 
+        // 清空后整库重建很快：缩小文件，并把早期创建的数据库切换为增量清理模式
+        if (!m_detectionRunning && !m_maintenance) {
+            query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+            query.exec("VACUUM");
+        }
+
         loadHistory();
         QMessageBox::information(this, "清除完成", "所有历史记录已清除");
     }
@@ -265,8 +241,20 @@ void HistoryWidget::clearAllHistory()
 
 void HistoryWidget::showResumeDialog()
 {
-    if (m_historyRecords.isEmpty()) {
-        QMessageBox::information(this, "提示", "没有可恢复的历史记录");
+    // 工作目录中尚未完成的进度日志，最近保存的排在前面
+    std::vector<api_checker::ProgressSession> sessions;
+    for (auto &session : api_checker::ProgressIndex::refresh(".")) {
+        if (session.completed < session.total &&
+            api_checker::ProgressJournal::is_journal(session.file)) {
+            sessions.push_back(std::move(session));
+        }
+    }
+    std::sort(sessions.begin(), sessions.end(), [](const auto &a, const auto &b) {
+        return a.last_save > b.last_save;
+    });
+
+    if (sessions.empty()) {
+        QMessageBox::information(this, "提示", "没有可恢复的检测进度");
         return;
     }
 
@@ -277,27 +265,31 @@ void HistoryWidget::showResumeDialog()
     QVBoxLayout *layout = new QVBoxLayout(&dialog);
 
     QTableWidget *table = new QTableWidget(&dialog);
-    table->setColumnCount(5);
-    table->setHorizontalHeaderLabels({"ID", "时间", "输入文件", "总数", "有效"});
+    table->setColumnCount(4);
+    table->setHorizontalHeaderLabels({"会话", "上次保存", "输入文件", "进度"});
     table->horizontalHeader()->setStretchLastSection(true);
     table->setSelectionBehavior(QAbstractItemView::SelectRows);
     table->setSelectionMode(QAbstractItemView::SingleSelection);
-
-    table->setRowCount(m_historyRecords.size());
-    for (int row = 0; row < m_historyRecords.size(); ++row) {
-        const auto &record = m_historyRecords[row];
-        table->setItem(row, 0, new QTableWidgetItem(QString::number(record.id)));
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    table->setRowCount(static_cast<int>(sessions.size()));
+    for (int row = 0; row < table->rowCount(); ++row) {
+        const auto &session = sessions[row];
+        auto lastSave = std::chrono::duration_cast<std::chrono::milliseconds>(
+            session.last_save.time_since_epoch());
+        table->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(session.session_id)));
         table->setItem(row, 1, new QTableWidgetItem(
-            record.startTime.toString("yyyy-MM-dd hh:mm:ss")));
-        table->setItem(row, 2, new QTableWidgetItem(record.inputFile));
-        table->setItem(row, 3, new QTableWidgetItem(QString::number(record.totalKeys)));
-        table->setItem(row, 4, new QTableWidgetItem(QString::number(record.validKeys)));
+            QDateTime::fromMSecsSinceEpoch(lastSave.count()).toString("yyyy-MM-dd hh:mm:ss")));
+        table->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(session.input_file)));
+        table->setItem(row, 3, new QTableWidgetItem(QString("%1/%2")
+            .arg(session.completed).arg(session.total)));
     }
+    table->selectRow(0);
 
     layout->addWidget(table);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
-    QPushButton *okButton = new QPushButton("确定", &dialog);
+    QPushButton *okButton = new QPushButton("恢复检测", &dialog);
     QPushButton *cancelButton = new QPushButton("取消", &dialog);
 
     buttonLayout->addStretch();
@@ -308,29 +300,140 @@ void HistoryWidget::showResumeDialog()
 
     connect(okButton, &QPushButton::clicked, &dialog, &QDialog::accept);
     connect(cancelButton, &QPushButton::clicked, &dialog, &QDialog::reject);
+    connect(table, &QTableWidget::cellDoubleClicked, &dialog, &QDialog::accept);
 
     if (dialog.exec() == QDialog::Accepted) {
         int currentRow = table->currentRow();
-        if (currentRow >= 0 && currentRow < m_historyRecords.size()) {
-            const auto &record = m_historyRecords[currentRow];
-            QMessageBox::information(this, "恢复功能",
-                "恢复功能将在后续版本中实现\n\n"
-                "记录ID: " + QString::number(record.id) + "\n"
-                "输入文件: " + record.inputFile + "\n"
-                "检测时间: " + record.startTime.toString());
+        if (currentRow >= 0 && currentRow < static_cast<int>(sessions.size())) {
+            emit resumeRequested(QString::fromStdString(sessions[currentRow].file));
+        }
+    }
+}
+
+void HistoryWidget::showTrends()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("趋势统计");
+    dialog.resize(700, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+    auto createTable = [&dialog](const QStringList &headers) {
+        QTableWidget *table = new QTableWidget(&dialog);
+        table->setColumnCount(headers.size());
+        table->setHorizontalHeaderLabels(headers);
+        table->horizontalHeader()->setStretchLastSection(true);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        table->setAlternatingRowColors(true);
+        return table;
+    };
+    auto validRate = [](qint64 valid, qint64 total) {
+        return total > 0 ? QString("%1%").arg(valid * 100.0 / total, 0, 'f', 1) : QString("-");
+    };
+
+    // 两张表都读预先汇总的行，行数只与天数和端点数有关
+    QTableWidget *dailyTable = createTable({"日期", "检测次数", "检测key数", "有效率"});
+    QSqlQuery query(m_database);
+    if (query.exec(QString("SELECT day, run_count, total_keys, valid_keys FROM history_daily_stats "
+                           "ORDER BY day DESC LIMIT %1").arg(TREND_DAYS))) {
+        while (query.next()) {
+            const int row = dailyTable->rowCount();
+            dailyTable->insertRow(row);
+            dailyTable->setItem(row, 0, new QTableWidgetItem(query.value(0).toString()));
+            dailyTable->setItem(row, 1, new QTableWidgetItem(query.value(1).toString()));
+            dailyTable->setItem(row, 2, new QTableWidgetItem(query.value(2).toString()));
+            dailyTable->setItem(row, 3, new QTableWidgetItem(
+                validRate(query.value(3).toLongLong(), query.value(2).toLongLong())));
+        }
+    }
+
+    QTableWidget *endpointTable = createTable({"API端点", "检测次数", "检测key数", "有效率", "平均速度"});
+    endpointTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    if (query.exec("SELECT api_endpoint, run_count, total_keys, valid_keys, speed_sum / run_count "
+                   "FROM history_endpoint_stats ORDER BY run_count DESC")) {
+        while (query.next()) {
+            const int row = endpointTable->rowCount();
+            endpointTable->insertRow(row);
+            endpointTable->setItem(row, 0, new QTableWidgetItem(query.value(0).toString()));
+            endpointTable->setItem(row, 1, new QTableWidgetItem(query.value(1).toString()));
+            endpointTable->setItem(row, 2, new QTableWidgetItem(query.value(2).toString()));
+            endpointTable->setItem(row, 3, new QTableWidgetItem(
+                validRate(query.value(3).toLongLong(), query.value(2).toLongLong())));
+            endpointTable->setItem(row, 4, new QTableWidgetItem(
+                QString("%1 keys/秒").arg(query.value(4).toDouble(), 0, 'f', 1)));
+        }
+    }
+
+    layout->addWidget(new QLabel(QString("最近 %1 天").arg(TREND_DAYS), &dialog));
+    layout->addWidget(dailyTable);
+    layout->addWidget(new QLabel("按API端点", &dialog));
+    layout->addWidget(endpointTable);
+
+    QPushButton *closeButton = new QPushButton("关闭", &dialog);
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    layout->addLayout(buttonLayout);
+    connect(closeButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    dialog.exec();
+}
+
+void HistoryWidget::refresh()
+{
+    loadHistory();
+}
+
+void HistoryWidget::setDetectionRunning(bool running)
+{
+    m_detectionRunning = running;
+    if (running) {
+        m_maintenanceTimer->stop();
+        if (m_maintenance) {
+            m_maintenance->requestStop();
         }
+    } else if (!m_maintenance) {
+        m_maintenanceTimer->start(MAINTENANCE_IDLE_DELAY_MS);
     }
 }
 
+void HistoryWidget::startMaintenance()
+{
+    if (m_detectionRunning || m_maintenance || !m_database.isOpen()) {
+        return;
+    }
+
+    m_maintenance = new HistoryMaintenance(HistoryRetention::fromSettings(), this);
+    connect(m_maintenance, &HistoryMaintenance::maintenanceFinished,
+            this, [this](int removedRuns, qint64 reclaimedPages) {
+        m_maintenance->wait();
+        m_maintenance->deleteLater();
+        m_maintenance = nullptr;
+
+        if (removedRuns > 0) {
+            qInfo() << "历史数据库维护: 删除了" << removedRuns << "次过期的检测，释放"
+                    << reclaimedPages << "页";
+            loadHistory();
+        }
+        if (!m_detectionRunning) {
+            m_maintenanceTimer->start(MAINTENANCE_INTERVAL_MS);
+        }
+    });
+    m_maintenance->start(QThread::LowPriority);
+}
+
 void HistoryWidget::onRefresh()
 {
     loadHistory();
+    if (m_resultSearchGroup->isVisible()) {
+        startSearch();
+    }
 }
 
 void HistoryWidget::onDeleteSelected()
 {
-    int currentRow = m_historyTable->currentRow();
-    if (currentRow < 0) {
+    HistoryRecord record;
+    if (!currentRecord(record)) {
         QMessageBox::warning(this, "提示", "请先选择要删除的记录");
         return;
     }
@@ -340,8 +443,6 @@ void HistoryWidget::onDeleteSelected()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        const auto &record = m_historyRecords[currentRow];
-
         QSqlQuery query(m_database);
         query.prepare("DELETE FROM history WHERE id = ?");
         query.addBindValue(record.id);
@@ -359,8 +460,8 @@ void HistoryWidget::onDeleteSelected()
 
 void HistoryWidget::onExportSelected()
 {
-    int currentRow = m_historyTable->currentRow();
-    if (currentRow < 0) {
+    HistoryRecord record;
+    if (!currentRecord(record)) {
         QMessageBox::warning(this, "提示", "请先选择要导出的记录");
         return;
     }
@@ -378,8 +479,6 @@ void HistoryWidget::onExportSelected()
         return;
     }
 
-    const auto &record = m_historyRecords[currentRow];
-
     QTextStream out(&file);
     out << "=== API检测历史记录 ===\n\n";
     out << "记录ID: " << record.id << "\n";
@@ -412,52 +511,70 @@ void HistoryWidget::onExportAll()
         return;
     }
 
+    // 从数据库逐行读取全部记录，不受已加载页数和搜索条件限制
+    QString body;
+    QTextStream records(&body);
+    int count = 0;
+    m_historyModel->forEachRecord([&](const HistoryRecord &record) {
+        ++count;
+        records << "--- 记录 " << record.id << " ---\n";
+        records << "时间: " << record.startTime.toString("yyyy-MM-dd hh:mm:ss") << "\n";
+        records << "总数: " << record.totalKeys << " | 有效: " << record.validKeys
+                << " | 无效: " << record.invalidKeys << " | 错误: " << record.errorKeys << "\n";
+        records << "耗时: " << record.duration << "秒 | 速度: " << record.avgSpeed << " keys/秒\n\n";
+    });
+    records.flush();
+
     QTextStream out(&file);
     out << "=== API检测历史记录汇总 ===\n\n";
-    out << "总记录数: " << m_historyRecords.size() << "\n\n";
-
-    for (const auto &record : m_historyRecords) {
-        out << "--- 记录 " << record.id << " ---\n";
-        out << "时间: " << record.startTime.toString("yyyy-MM-dd hh:mm:ss") << "\n";
-        out << "总数: " << record.totalKeys << " | 有效: " << record.validKeys
-            << " | 无效: " << record.invalidKeys << " | 错误: " << record.errorKeys << "\n";
-        out << "耗时: " << record.duration << "秒 | 速度: " << record.avgSpeed << " keys/秒\n\n";
-    }
+    out << "总记录数: " << count << "\n\n";
+    out << body;
 
     QMessageBox::information(this, "导出完成",
-        QString("已导出 %1 条记录").arg(m_historyRecords.size()));
+        QString("已导出 %1 条记录").arg(count));
 }
 
 void HistoryWidget::onSearchTextChanged(const QString &text)
 {
-    for (int row = 0; row < m_historyTable->rowCount(); ++row) {
-        bool visible = false;
-
-        for (int col = 0; col < m_historyTable->columnCount(); ++col) {
-            if (auto item = m_historyTable->item(row, col)) {
-                if (item->text().contains(text, Qt::CaseInsensitive)) {
-                    visible = true;
-                    break;
-                }
-            }
-        }
+    Q_UNUSED(text);
+    m_searchTimer->start();
+}
+
+void HistoryWidget::startSearch()
+{
+    m_searchTimer->stop();
+    const QString text = m_searchEdit->text().trimmed();
 
-        m_historyTable->setRowHidden(row, !visible);
+    // 历史记录表不大，按全文索引读一页很快，直接在界面线程中查询；
+    // 检测结果可能有数百万行，交给后台查询
+    m_historyModel->setSearchText(text);
+    onSelectionChanged();
+
+    m_resultSearchModel->search(text);
+    m_resultSearchGroup->setVisible(!text.isEmpty());
+    updateResultSearchStatus();
+}
+
+void HistoryWidget::updateResultSearchStatus()
+{
+    if (m_resultSearchModel->isSearching()) {
+        m_resultSearchLabel->setText(QString("正在搜索... 已找到 %1 条")
+                                         .arg(m_resultSearchModel->rowCount()));
     }
 }
 
 void HistoryWidget::onSelectionChanged()
 {
-    bool hasSelection = m_historyTable->currentRow() >= 0;
+    HistoryRecord record;
+    bool hasSelection = currentRecord(record);
     m_deleteButton->setEnabled(hasSelection);
     m_exportButton->setEnabled(hasSelection);
 }
 
 void HistoryWidget::onViewDetails()
 {
-    int currentRow = m_historyTable->currentRow();
-    if (currentRow >= 0 && currentRow < m_historyRecords.size()) {
-        const auto &record = m_historyRecords[currentRow];
+    HistoryRecord record;
+    if (currentRecord(record)) {
 
         QString details;
         details += QString("<b>记录ID:</b> %1<br>").arg(record.id);
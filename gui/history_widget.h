@@ -1,7 +1,7 @@
 #pragma once
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QLabel>
 #include <QLineEdit>
@@ -10,32 +10,38 @@
 #include <QSqlTableModel>
 #include <QSqlQuery>
 #include <QDateTime>
-
-struct HistoryRecord {
-    int id;
-    QDateTime startTime;
-    QDateTime endTime;
-    QString inputFile;
-    int totalKeys;
-    int validKeys;
-    int invalidKeys;
-    int errorKeys;
-    double duration;
-    double avgSpeed;
-    QString apiEndpoint;
-};
+#include <QTimer>
+#include "history_database.h"
+#include "history_table_model.h"
+#include "result_search_model.h"
+#include "history_maintenance.h"
 
 class HistoryWidget : public QWidget
 {
     Q_OBJECT
 
 public:
+    static constexpr int TREND_DAYS = 30;
+    // 检测结束（或程序启动）后空闲这么久开始维护数据库，之后每隔 MAINTENANCE_INTERVAL_MS 一次
+    static constexpr int MAINTENANCE_IDLE_DELAY_MS = 60 * 1000;
+    static constexpr int MAINTENANCE_INTERVAL_MS = 60 * 60 * 1000;
+
     explicit HistoryWidget(QWidget *parent = nullptr);
     ~HistoryWidget();
 
     void addRecord(const HistoryRecord &record);
     void clearAllHistory();
     void showResumeDialog();
+    // 按天和按API端点的检测趋势
+    void showTrends();
+    // 重新从数据库读取历史记录
+    void refresh();
+    // 检测进行期间不做数据库维护，已开始的维护尽快停止
+    void setDetectionRunning(bool running);
+
+signals:
+    // 在恢复对话框中选择了要继续的进度文件
+    void resumeRequested(const QString &progressFile);
 
 private slots:
     void onRefresh();
@@ -43,6 +49,9 @@ private slots:
     void onExportSelected();
     void onExportAll();
     void onSearchTextChanged(const QString &text);
+    void startSearch();
+    void updateResultSearchStatus();
+    void startMaintenance();
     void onSelectionChanged();
     void onViewDetails();
 
@@ -51,11 +60,21 @@ private:
     void connectSignals();
     void initDatabase();
     void loadHistory();
-    void populateTable();
     void updateStatistics();
+    // 当前选中行对应的记录，未选中时返回false
+    bool currentRecord(HistoryRecord &record) const;
 
-    QTableWidget *m_historyTable;
+    QTableView *m_historyView;
+    HistoryTableModel *m_historyModel;
     QLineEdit *m_searchEdit;
+    // 输入停顿后才开始搜索，避免每个字符都发起一次查询
+    QTimer *m_searchTimer;
+
+    // 搜索文本同时在所有检测的结果中查找匹配的key和消息
+    QGroupBox *m_resultSearchGroup;
+    QLabel *m_resultSearchLabel;
+    QTableView *m_resultSearchView;
+    ResultSearchModel *m_resultSearchModel;
     QLabel *m_totalRecordsLabel;
     QLabel *m_totalKeysLabel;
     QLabel *m_totalValidLabel;
@@ -65,7 +84,11 @@ private:
     QPushButton *m_exportButton;
     QPushButton *m_exportAllButton;
     QPushButton *m_resumeButton;
+    QPushButton *m_trendsButton;
 
     QSqlDatabase m_database;
-    QVector<HistoryRecord> m_historyRecords;
+
+    QTimer *m_maintenanceTimer;
+    HistoryMaintenance *m_maintenance;
+    bool m_detectionRunning;
 };
@@ -128,6 +128,22 @@ void MainWindow::connectSignals()
     connect(m_inputWidget, &ApiInputWidget::detectionProgress, this, &MainWindow::onDetectionProgress);
     connect(m_inputWidget, &ApiInputWidget::detectionFinished, this, &MainWindow::onDetectionFinished);
     connect(m_inputWidget, &ApiInputWidget::detectionError, this, &MainWindow::onDetectionError);
+
+    connect(m_inputWidget, &ApiInputWidget::historyRecorded, m_historyWidget, &HistoryWidget::refresh);
+    // 历史数据库的维护只在没有检测进行时执行
+    connect(m_inputWidget, &ApiInputWidget::detectionStarted, m_historyWidget, [this]() {
+        m_historyWidget->setDetectionRunning(true);
+    });
+    connect(m_inputWidget, &ApiInputWidget::detectionFinished, m_historyWidget, [this]() {
+        m_historyWidget->setDetectionRunning(false);
+    });
+    connect(m_inputWidget, &ApiInputWidget::detectionError, m_historyWidget, [this]() {
+        m_historyWidget->setDetectionRunning(false);
+    });
+    connect(m_historyWidget, &HistoryWidget::resumeRequested, this, [this](const QString &progressFile) {
+        m_tabWidget->setCurrentWidget(m_inputWidget);
+        m_inputWidget->resumeDetection(progressFile);
+    });
 }
 
 void MainWindow::loadSettings()
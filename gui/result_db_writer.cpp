@@ -0,0 +1,160 @@
+#include "result_db_writer.h"
+#include "history_schema.h"
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+ResultDbWriter::ResultDbWriter(const HistoryRecord &run, QObject *parent)
+    : QThread(parent)
+    , m_run(run)
+    , m_summary(run)
+    , m_runId(-1)
+    , m_finishing(false)
+{
+}
+
+ResultDbWriter::~ResultDbWriter()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finishing = true;
+    }
+    m_wakeUp.wakeOne();
+    wait();
+}
+
+void ResultDbWriter::enqueue(const ApiCheckResult &result)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(result);
+    if (m_pending.size() == BATCH_SIZE) {
+        m_wakeUp.wakeOne();
+    }
+}
+
+void ResultDbWriter::finishRun(const HistoryRecord &summary)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_summary = summary;
+        m_finishing = true;
+    }
+    m_wakeUp.wakeOne();
+}
+
+void ResultDbWriter::run()
+{
+    const QString connectionName = QString("result_writer_%1").arg(reinterpret_cast<quintptr>(this));
+    QString errorMessage;
+    qint64 runId = -1;
+
+    {
+        QSqlDatabase db = HistoryDatabase::open(connectionName, &errorMessage);
+        if (db.isOpen()) {
+            runId = HistoryDatabase::insertRun(db, m_run, &errorMessage);
+        }
+        m_runId.storeRelease(runId);
+
+        // 预编译一次，之后每行只重新绑定参数；同一次检测中重复的key保留最后的结果
+        QSqlQuery insert(db);
+        if (runId >= 0 && !insert.prepare(QString::fromStdString(HistorySchema::resultUpsertSql()))) {
+            errorMessage = "无法准备插入语句: " + insert.lastError().text();
+            runId = -1;
+        }
+        QSqlQuery lifecycle(db);
+        if (runId >= 0 && !lifecycle.prepare(HistoryDatabase::keyLifecycleUpsertSql())) {
+            errorMessage = "无法准备插入语句: " + lifecycle.lastError().text();
+            runId = -1;
+        }
+
+        QVector<ApiCheckResult> batch;
+        HistoryRecord summary;
+        bool finishing = false;
+        while (!finishing) {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_pending.size() < BATCH_SIZE && !m_finishing) {
+                    m_wakeUp.wait(&m_mutex, FLUSH_INTERVAL_MS);
+                }
+                batch.swap(m_pending);
+                finishing = m_finishing;
+                summary = m_summary;
+            }
+
+            // 数据库不可用时照常取走结果，不让队列无限增长
+            if (runId >= 0 && !batch.isEmpty() && !writeBatch(db, insert, lifecycle, runId, batch, errorMessage)) {
+                runId = -1;
+                m_runId.storeRelease(runId);
+            }
+            batch.clear();
+        }
+
+        if (runId >= 0) {
+            summary.id = static_cast<int>(runId);
+            HistoryDatabase::updateRun(db, summary, &errorMessage);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (!errorMessage.isEmpty()) {
+        emit error(errorMessage);
+    }
+    emit runFinished(runId);
+}
+
+bool ResultDbWriter::writeBatch(QSqlDatabase &db, QSqlQuery &insert, QSqlQuery &lifecycle,
+                                qint64 runId, const QVector<ApiCheckResult> &batch,
+                                QString &errorMessage)
+{
+    // 整批在一个事务中提交，每条结果不再单独同步；key_lifecycle 与 results 同时生效
+    const QVariant noTime(QMetaType::fromType<qint64>());
+    if (!db.transaction()) {
+        errorMessage = "无法开始事务: " + db.lastError().text();
+        return false;
+    }
+
+    for (const ApiCheckResult &result : batch) {
+        const qint64 fingerprint = HistoryDatabase::keyFingerprint(result.key);
+        const int status = result.isValid() ? 0 : result.isInvalid() ? 1 : 2;
+        const qint64 checkedAt = result.checkedAt.toMSecsSinceEpoch();
+
+        insert.bindValue(0, runId);
+        insert.bindValue(1, fingerprint);
+        insert.bindValue(2, result.key);
+        insert.bindValue(3, status);
+        insert.bindValue(4, static_cast<int>(result.messageCode));
+        insert.bindValue(5, result.httpStatus);
+        insert.bindValue(6, result.responseTime);
+        insert.bindValue(7, checkedAt);
+        insert.bindValue(8, result.message);
+
+        if (!insert.exec()) {
+            errorMessage = "无法保存检测结果: " + insert.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        lifecycle.bindValue(0, fingerprint);
+        lifecycle.bindValue(1, result.key);
+        lifecycle.bindValue(2, checkedAt);
+        lifecycle.bindValue(3, checkedAt);
+        lifecycle.bindValue(4, status);
+        lifecycle.bindValue(5, status == 0 ? QVariant(checkedAt) : noTime);
+        lifecycle.bindValue(6, status == 1 ? QVariant(checkedAt) : noTime);
+
+        if (!lifecycle.exec()) {
+            errorMessage = "无法更新key生命周期: " + lifecycle.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        errorMessage = "无法提交检测结果: " + db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
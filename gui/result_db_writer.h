@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QAtomicInteger>
+#include <QSqlQuery>
+#include "checker_thread.h"
+#include "history_database.h"
+
+// 后台写入检测结果到历史数据库的 results 表
+// 检测线程调用 enqueue 只把结果放入内存队列；写入线程用自己的数据库连接，
+// 攒够一批或每隔 FLUSH_INTERVAL_MS 在一个事务中用预编译语句批量插入，界面线程不参与写入；
+// 同一事务中更新每个key的 key_lifecycle
+class ResultDbWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BATCH_SIZE = 4096;
+    static constexpr int FLUSH_INTERVAL_MS = 250;
+
+    // run 为本次检测的汇总初值，写入线程启动时据此创建历史记录
+    explicit ResultDbWriter(const HistoryRecord &run, QObject *parent = nullptr);
+    ~ResultDbWriter();
+
+    // 加入一条结果，可在任意线程中调用
+    void enqueue(const ApiCheckResult &result);
+
+    // 写完队列中的结果后用summary更新历史记录并结束线程
+    void finishRun(const HistoryRecord &summary);
+
+    // 历史记录的id，写入线程创建记录之前为-1
+    qint64 runId() const { return m_runId.loadAcquire(); }
+
+signals:
+    void runFinished(qint64 runId);
+    void error(const QString &errorMessage);
+
+protected:
+    void run() override;
+
+private:
+    bool writeBatch(QSqlDatabase &db, QSqlQuery &insert, QSqlQuery &lifecycle, qint64 runId,
+                    const QVector<ApiCheckResult> &batch, QString &errorMessage);
+
+    HistoryRecord m_run;
+    HistoryRecord m_summary;
+    QAtomicInteger<qint64> m_runId;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    QVector<ApiCheckResult> m_pending;
+    bool m_finishing;
+};
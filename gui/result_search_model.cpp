@@ -0,0 +1,234 @@
+#include "result_search_model.h"
+#include "history_database.h"
+#include <QBrush>
+#include <QMetaObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtConcurrent>
+
+namespace {
+
+QString statusText(int status)
+{
+    switch (status) {
+        case 0:
+            return "valid";
+        case 1:
+            return "invalid";
+        default:
+            return "error";
+    }
+}
+
+QString likePattern(const QString &text)
+{
+    QString escaped = text;
+    escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' + escaped + '%';
+}
+
+} // namespace
+
+ResultSearchModel::ResultSearchModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_generation(0)
+    , m_searching(false)
+{
+}
+
+ResultSearchModel::~ResultSearchModel()
+{
+    // 后台查询会回调本对象，必须等它们退出
+    cancel();
+    m_pool.waitForDone();
+}
+
+void ResultSearchModel::search(const QString &text)
+{
+    const int generation = m_generation.fetchAndAddOrdered(1) + 1;
+
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+
+    const QString trimmed = text.trimmed();
+    m_searching = !trimmed.isEmpty();
+    if (!m_searching) {
+        return;
+    }
+
+    // 被取消的旧查询会在下一行之前退出，不必等它
+    QtConcurrent::run(&m_pool, [this, generation, trimmed]() {
+        runSearch(generation, trimmed);
+    });
+}
+
+void ResultSearchModel::cancel()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_searching = false;
+}
+
+void ResultSearchModel::runSearch(int generation, const QString &text)
+{
+    const QString connectionName = QString("result_search_%1").arg(generation);
+    QString errorMessage;
+    int matches = 0;
+    bool truncated = false;
+    bool cancelled = false;
+
+    {
+        QSqlDatabase db = HistoryDatabase::open(connectionName, &errorMessage);
+        if (db.isOpen()) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+
+            // 按 rowid 倒序读取，最近写入的结果先显示；全文索引不可用或文本太短时逐行匹配
+            if (HistoryDatabase::hasFullTextSearch(db) &&
+                text.size() >= HistoryDatabase::MIN_FULL_TEXT_LENGTH) {
+                query.prepare(R"(
+                    SELECT r.run_id, r.api_key, r.status, r.message, r.checked_at
+                    FROM results_fts f JOIN results r ON r.rowid = f.rowid
+                    WHERE results_fts MATCH ?
+                    ORDER BY f.rowid DESC
+                    LIMIT ?
+                )");
+                query.addBindValue(HistoryDatabase::fullTextQuery(text));
+            } else {
+                query.prepare(R"(
+                    SELECT run_id, api_key, status, message, checked_at FROM results
+                    WHERE api_key LIKE ? ESCAPE '\' OR message LIKE ? ESCAPE '\'
+                    ORDER BY rowid DESC
+                    LIMIT ?
+                )");
+                query.addBindValue(likePattern(text));
+                query.addBindValue(likePattern(text));
+            }
+            // 多取一行用来判断是否超过上限
+            query.addBindValue(MAX_RESULTS + 1);
+
+            if (!query.exec()) {
+                errorMessage = "搜索失败: " + query.lastError().text();
+            }
+
+            QVector<ResultMatch> batch;
+            batch.reserve(BATCH_SIZE);
+            while (query.isActive() && query.next()) {
+                if (m_generation.loadAcquire() != generation) {
+                    cancelled = true;
+                    break;
+                }
+                if (matches == MAX_RESULTS) {
+                    truncated = true;
+                    break;
+                }
+
+                ResultMatch match;
+                match.runId = query.value(0).toLongLong();
+                match.key = query.value(1).toString();
+                match.status = query.value(2).toInt();
+                match.message = query.value(3).toString();
+                match.checkedAt = QDateTime::fromMSecsSinceEpoch(query.value(4).toLongLong());
+                batch.append(std::move(match));
+                ++matches;
+
+                if (batch.size() == BATCH_SIZE) {
+                    QMetaObject::invokeMethod(this, [this, generation, batch]() {
+                        appendRows(generation, batch);
+                    }, Qt::QueuedConnection);
+                    batch.clear();
+                }
+            }
+            if (!batch.isEmpty() && !cancelled) {
+                QMetaObject::invokeMethod(this, [this, generation, batch]() {
+                    appendRows(generation, batch);
+                }, Qt::QueuedConnection);
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (cancelled) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, generation, matches, truncated, errorMessage]() {
+        if (m_generation.loadAcquire() != generation) {
+            return;
+        }
+        m_searching = false;
+        if (errorMessage.isEmpty()) {
+            emit searchFinished(matches, truncated);
+        } else {
+            emit searchFailed(errorMessage);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void ResultSearchModel::appendRows(int generation, const QVector<ResultMatch> &rows)
+{
+    // 已被新的搜索取代的结果丢弃
+    if (m_generation.loadAcquire() != generation || rows.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + rows.size() - 1);
+    m_rows += rows;
+    endInsertRows();
+}
+
+int ResultSearchModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int ResultSearchModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ResultSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const ResultMatch &match = m_rows[index.row()];
+
+    if (role == Qt::ForegroundRole && index.column() == StatusColumn) {
+        if (match.status == 0) {
+            return QBrush(Qt::green);
+        } else if (match.status == 1) {
+            return QBrush(Qt::red);
+        }
+        return QBrush(Qt::darkYellow);
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case RunIdColumn:
+            return match.runId;
+        case KeyColumn:
+            return match.key;
+        case StatusColumn:
+            return statusText(match.status);
+        case MessageColumn:
+            return match.message;
+        case CheckedAtColumn:
+            return match.checkedAt.toString("yyyy-MM-dd hh:mm:ss");
+        default:
+            return QVariant();
+    }
+}
+
+QVariant ResultSearchModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    static const QStringList headers = {"检测ID", "API Key", "状态", "消息", "检测时间"};
+    return section >= 0 && section < headers.size() ? headers[section] : QVariant();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QVector>
+
+// 历史数据库中匹配搜索文本的一条检测结果
+struct ResultMatch {
+    qint64 runId = 0;
+    QString key;
+    int status = 0;      // 与 results.status 相同: 0 有效, 1 无效, 2 错误
+    QString message;
+    QDateTime checkedAt;
+};
+
+// 在全部历史检测结果中按key片段或结果消息搜索
+// 查询在后台线程中用自己的数据库连接执行，匹配的行每读满 BATCH_SIZE 条就追加到模型，
+// 界面不必等整个查询结束；开始新的搜索会取消尚未完成的旧搜索
+class ResultSearchModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BATCH_SIZE = 200;
+    // 常见的消息（如"认证失败"）可能匹配数百万行，最多显示这么多条，新的检测在前
+    static constexpr int MAX_RESULTS = 10000;
+
+    enum Column {
+        RunIdColumn,
+        KeyColumn,
+        StatusColumn,
+        MessageColumn,
+        CheckedAtColumn,
+        ColumnCount
+    };
+
+    explicit ResultSearchModel(QObject *parent = nullptr);
+    ~ResultSearchModel();
+
+    // 清空模型并开始新的搜索；文本为空时只清空
+    void search(const QString &text);
+    void cancel();
+    bool isSearching() const { return m_searching; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    const ResultMatch &match(int row) const { return m_rows[row]; }
+
+signals:
+    // 搜索结束（未被取消）；truncated 表示匹配行超过 MAX_RESULTS，只显示了一部分
+    void searchFinished(int matches, bool truncated);
+    void searchFailed(const QString &errorMessage);
+
+private:
+    // 在后台线程中执行
+    void runSearch(int generation, const QString &text);
+    void appendRows(int generation, const QVector<ResultMatch> &rows);
+
+    QVector<ResultMatch> m_rows;
+    QAtomicInt m_generation;
+    // 被取消的旧查询可能仍在退出途中，析构时等待池中所有查询
+    QThreadPool m_pool;
+    bool m_searching;
+};
@@ -0,0 +1,184 @@
+#include "result_store_model.h"
+#include <QBrush>
+#include <QDateTime>
+#include <algorithm>
+#include <cctype>
+
+using namespace api_checker;
+
+namespace {
+
+QString statusText(KeyStatus status)
+{
+    switch (status) {
+        case KeyStatus::Valid:
+            return "valid";
+        case KeyStatus::Invalid:
+            return "invalid";
+        default:
+            return "error";
+    }
+}
+
+// key只含ASCII字符，按字节忽略大小写比较，不必为每行构造QString
+bool containsIgnoreCase(std::string_view haystack, const std::string &lowerNeedle)
+{
+    auto it = std::search(haystack.begin(), haystack.end(), lowerNeedle.begin(), lowerNeedle.end(),
+        [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == b;
+        });
+    return it != haystack.end();
+}
+
+QDateTime toDateTime(std::chrono::system_clock::time_point time)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch());
+    return QDateTime::fromMSecsSinceEpoch(ms.count());
+}
+
+} // namespace
+
+ResultStoreModel::ResultStoreModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+bool ResultStoreModel::openFile(const QString &filePath)
+{
+    beginResetModel();
+    m_rows.clear();
+    m_filtered = false;
+    bool ok = m_reader.open(filePath.toStdString());
+    m_filePath = ok ? filePath : QString();
+    endResetModel();
+    return ok;
+}
+
+void ResultStoreModel::closeFile()
+{
+    beginResetModel();
+    m_reader.close();
+    m_filePath.clear();
+    m_rows.clear();
+    m_filtered = false;
+    endResetModel();
+}
+
+void ResultStoreModel::setFilter(Filter filter, const QString &searchText)
+{
+    beginResetModel();
+    m_rows.clear();
+    m_filtered = filter != AllRows || !searchText.isEmpty();
+
+    if (m_filtered) {
+        if (filter == ValidRows) {
+            m_rows = m_reader.rows_with_status(KeyStatus::Valid);
+        } else if (filter == InvalidRows) {
+            m_rows = m_reader.rows_with_status(KeyStatus::Invalid);
+        } else if (filter == ErrorRows) {
+            m_rows = m_reader.rows_with_status(KeyStatus::Error);
+        } else {
+            m_rows.resize(m_reader.size());
+            for (size_t i = 0; i < m_rows.size(); ++i) {
+                m_rows[i] = static_cast<uint32_t>(i);
+            }
+        }
+
+        // 搜索直接比较映射内存中的key，消息只在key不匹配时才生成
+        if (!searchText.isEmpty()) {
+            const QString needle = searchText.toLower();
+            const std::string needleUtf8 = needle.toStdString();
+            std::vector<uint32_t> matched;
+            for (uint32_t row : m_rows) {
+                bool match = containsIgnoreCase(m_reader.key(row), needleUtf8);
+                if (!match) {
+                    auto message = KeyResult::describe(m_reader.message_code(row),
+                                                       m_reader.http_status(row));
+                    match = QString::fromStdString(message).toLower().contains(needle);
+                }
+                if (match) {
+                    matched.push_back(row);
+                }
+            }
+            m_rows = std::move(matched);
+        }
+    }
+
+    endResetModel();
+}
+
+int ResultStoreModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(m_filtered ? m_rows.size() : m_reader.size());
+}
+
+int ResultStoreModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 5;
+}
+
+size_t ResultStoreModel::sourceRow(int row) const
+{
+    return m_filtered ? m_rows[static_cast<size_t>(row)] : static_cast<size_t>(row);
+}
+
+QVariant ResultStoreModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    size_t row = sourceRow(index.row());
+    KeyStatus status = m_reader.status(row);
+
+    if (role == Qt::ForegroundRole && index.column() == 1) {
+        if (status == KeyStatus::Valid) {
+            return QBrush(Qt::green);
+        } else if (status == KeyStatus::Invalid) {
+            return QBrush(Qt::red);
+        }
+        return QBrush(Qt::darkYellow);
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case 0: {
+            auto key = m_reader.key(row);
+            return QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size()));
+        }
+        case 1:
+            return statusText(status);
+        case 2:
+            return QString::fromStdString(
+                KeyResult::describe(m_reader.message_code(row), m_reader.http_status(row)));
+        case 3: {
+            auto responseTime = m_reader.response_time(row);
+            return QString("%1ms").arg(responseTime ? responseTime->count() : 0);
+        }
+        case 4:
+            return toDateTime(m_reader.checked_at(row)).toString("yyyy-MM-dd hh:mm:ss");
+        default:
+            return QVariant();
+    }
+}
+
+QVariant ResultStoreModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    static const QStringList headers = {"API Key", "状态", "消息", "响应时间", "检测时间"};
+    return section >= 0 && section < headers.size() ? headers[section] : QVariant();
+}
+
+ApiCheckResult ResultStoreModel::resultAt(int row) const
+{
+    return ApiCheckResult::fromKeyResult(m_reader.result(sourceRow(row)));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <vector>
+#include "checker_thread.h"
+#include "result_store.h"
+
+// 列式结果文件（.apcr）的表格模型
+// 数据按行直接从内存映射的文件读取，筛选时只保存匹配的行号，
+// 千万行的结果也不需要复制到内存中
+class ResultStoreModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Filter {
+        AllRows,
+        ValidRows,
+        InvalidRows,
+        ErrorRows
+    };
+
+    explicit ResultStoreModel(QObject *parent = nullptr);
+
+    bool openFile(const QString &filePath);
+    void closeFile();
+    bool isOpen() const { return m_reader.is_open(); }
+    QString filePath() const { return m_filePath; }
+
+    // 按状态筛选并按key或消息搜索
+    void setFilter(Filter filter, const QString &searchText);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    // 可见行对应的文件行号
+    size_t sourceRow(int row) const;
+    ApiCheckResult resultAt(int row) const;
+
+    const api_checker::ResultStoreReader &reader() const { return m_reader; }
+
+private:
+    api_checker::ResultStoreReader m_reader;
+    QString m_filePath;
+
+    // 筛选后的文件行号；m_filtered 为false时显示全部行
+    std::vector<uint32_t> m_rows;
+    bool m_filtered = false;
+};
@@ -81,11 +81,25 @@ void ResultWidget::setupUi()
     m_detailView->setMaximumHeight(150);
     m_detailView->setPlaceholderText("选择一行查看详细信息");
 
+    // 打开结果文件时用模型视图代替表格，行数据按需从映射的文件读取
+    m_storeModel = new ResultStoreModel(this);
+    m_storeView = new QTableView(this);
+    m_storeView->setModel(m_storeModel);
+    m_storeView->horizontalHeader()->setStretchLastSection(true);
+    m_storeView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_storeView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_storeView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_storeView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_storeView->setAlternatingRowColors(true);
+    m_storeView->setVisible(false);
+
     m_splitter = new QSplitter(Qt::Vertical, this);
     m_splitter->addWidget(m_resultTable);
+    m_splitter->addWidget(m_storeView);
     m_splitter->addWidget(m_detailView);
     m_splitter->setStretchFactor(0, 3);
-    m_splitter->setStretchFactor(1, 1);
+    m_splitter->setStretchFactor(1, 3);
+    m_splitter->setStretchFactor(2, 1);
 
     QGroupBox *exportGroup = new QGroupBox("导出", this);
     QHBoxLayout *exportLayout = new QHBoxLayout(exportGroup);
@@ -94,12 +108,14 @@ void ResultWidget::setupUi()
     m_exportInvalidButton = new QPushButton("📥 导出无效", this);
     m_exportAllButton = new QPushButton("📥 导出全部", this);
     m_exportJsonButton = new QPushButton("📋 导出JSON", this);
+    m_openStoreButton = new QPushButton("📂 打开结果文件", this);
 
     exportLayout->addWidget(m_exportValidButton);
     exportLayout->addWidget(m_exportInvalidButton);
     exportLayout->addWidget(m_exportAllButton);
     exportLayout->addWidget(m_exportJsonButton);
     exportLayout->addStretch();
+    exportLayout->addWidget(m_openStoreButton);
 
     mainLayout->addWidget(statsGroup);
     mainLayout->addWidget(filterGroup);
@@ -121,12 +137,17 @@ void ResultWidget::connectSignals()
             this, &ResultWidget::onExportAll);
     connect(m_exportJsonButton, &QPushButton::clicked,
             this, &ResultWidget::onExportJson);
+    connect(m_openStoreButton, &QPushButton::clicked,
+            this, &ResultWidget::onOpenResultStore);
     connect(m_resultTable, &QTableWidget::itemSelectionChanged,
             this, &ResultWidget::onSelectionChanged);
+    connect(m_storeView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &ResultWidget::onSelectionChanged);
 }
 
 void ResultWidget::setResults(const QVector<ApiCheckResult> &results)
 {
+    closeResultStore();
     m_allResults = results;
     applyFilter();
     updateStatistics();
@@ -140,6 +161,7 @@ void ResultWidget::refreshResults()
 
 void ResultWidget::clearResults()
 {
+    closeResultStore();
     m_allResults.clear();
     m_filteredResults.clear();
     m_resultTable->setRowCount(0);
@@ -152,6 +174,68 @@ void ResultWidget::exportResults()
     onExportAll();
 }
 
+bool ResultWidget::openResultStore(const QString &filePath)
+{
+    if (!m_storeModel->openFile(filePath)) {
+        return false;
+    }
+
+    m_allResults.clear();
+    m_filteredResults.clear();
+    m_resultTable->setRowCount(0);
+    m_resultTable->setVisible(false);
+    m_storeView->setVisible(true);
+    m_detailView->clear();
+
+    applyFilter();
+    updateStatistics();
+    return true;
+}
+
+void ResultWidget::closeResultStore()
+{
+    if (!isStoreMode()) {
+        return;
+    }
+    m_storeModel->closeFile();
+    m_storeView->setVisible(false);
+    m_resultTable->setVisible(true);
+}
+
+bool ResultWidget::isStoreMode() const
+{
+    return m_storeModel->isOpen();
+}
+
+void ResultWidget::onOpenResultStore()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "打开结果文件",
+        QString(), "结果文件 (*.apcr);;所有文件 (*.*)");
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    if (!openResultStore(fileName)) {
+        QMessageBox::critical(this, "打开失败", "不是有效的结果文件: " + fileName);
+    }
+}
+
+void ResultWidget::forEachResult(const std::function<void(const ApiCheckResult &)> &fn) const
+{
+    if (isStoreMode()) {
+        const auto &reader = m_storeModel->reader();
+        for (size_t row = 0; row < reader.size(); ++row) {
+            fn(ApiCheckResult::fromKeyResult(reader.result(row)));
+        }
+        return;
+    }
+
+    for (const auto &result : m_allResults) {
+        fn(result);
+    }
+}
+
 void ResultWidget::onFilterChanged(int index)
 {
     applyFilter();
@@ -169,6 +253,19 @@ void ResultWidget::applyFilter()
     QString filter = m_filterCombo->currentText();
     QString searchText = m_searchEdit->text().toLower();
 
+    if (isStoreMode()) {
+        ResultStoreModel::Filter storeFilter = ResultStoreModel::AllRows;
+        if (filter == "仅有效") {
+            storeFilter = ResultStoreModel::ValidRows;
+        } else if (filter == "仅无效") {
+            storeFilter = ResultStoreModel::InvalidRows;
+        } else if (filter == "仅错误") {
+            storeFilter = ResultStoreModel::ErrorRows;
+        }
+        m_storeModel->setFilter(storeFilter, searchText);
+        return;
+    }
+
     for (const auto &result : m_allResults) {
         bool matchesFilter = true;
 
@@ -235,19 +332,35 @@ void ResultWidget::populateTable(const QVector<ApiCheckResult> &results)
 
 void ResultWidget::updateStatistics()
 {
-    int total = m_allResults.size();
-    int valid = 0, invalid = 0, error = 0;
+    qint64 total = m_allResults.size();
+    qint64 valid = 0, invalid = 0, error = 0;
     qint64 totalTime = 0;
-
-    for (const auto &result : m_allResults) {
-        if (result.isValid()) {
-            valid++;
-        } else if (result.isInvalid()) {
-            invalid++;
-        } else {
-            error++;
+    qint64 shown = m_filteredResults.size();
+
+    if (isStoreMode()) {
+        // 只扫描状态列和耗时列
+        const auto &reader = m_storeModel->reader();
+        total = static_cast<qint64>(reader.size());
+        valid = static_cast<qint64>(reader.count(api_checker::KeyStatus::Valid));
+        invalid = static_cast<qint64>(reader.count(api_checker::KeyStatus::Invalid));
+        error = total - valid - invalid;
+        for (size_t row = 0; row < reader.size(); ++row) {
+            if (auto responseTime = reader.response_time(row)) {
+                totalTime += responseTime->count();
+            }
+        }
+        shown = m_storeModel->rowCount();
+    } else {
+        for (const auto &result : m_allResults) {
+            if (result.isValid()) {
+                valid++;
+            } else if (result.isInvalid()) {
+                invalid++;
+            } else {
+                error++;
+            }
+            totalTime += result.responseTime;
         }
-        totalTime += result.responseTime;
     }
 
     m_totalLabel->setText(QString("总计: %1").arg(total));
@@ -264,11 +377,21 @@ void ResultWidget::updateStatistics()
         m_avgTimeLabel->setText("平均响应: 0ms");
     }
 
-    m_speedLabel->setText(QString("显示: %1/%2").arg(m_filteredResults.size()).arg(total));
+    m_speedLabel->setText(QString("显示: %1/%2").arg(shown).arg(total));
 }
 
 void ResultWidget::onSelectionChanged()
 {
+    if (isStoreMode()) {
+        int currentRow = m_storeView->currentIndex().row();
+        if (currentRow >= 0 && currentRow < m_storeModel->rowCount()) {
+            showResultDetails(m_storeModel->resultAt(currentRow));
+        } else {
+            m_detailView->clear();
+        }
+        return;
+    }
+
     int currentRow = m_resultTable->currentRow();
     if (currentRow >= 0 && currentRow < m_filteredResults.size()) {
         showResultDetails(m_filteredResults[currentRow]);
@@ -307,12 +430,12 @@ void ResultWidget::onExportValid()
 
     QTextStream out(&file);
     int count = 0;
-    for (const auto &result : m_allResults) {
+    forEachResult([&](const ApiCheckResult &result) {
         if (result.isValid()) {
             out << result.key << "\n";
             count++;
         }
-    }
+    });
 
     QMessageBox::information(this, "导出完成",
         QString("已导出 %1 个有效API").arg(count));
@@ -335,12 +458,12 @@ void ResultWidget::onExportInvalid()
 
     QTextStream out(&file);
     int count = 0;
-    for (const auto &result : m_allResults) {
+    forEachResult([&](const ApiCheckResult &result) {
         if (result.isInvalid()) {
             out << result.key << " # " << result.message << "\n";
             count++;
         }
-    }
+    });
 
     QMessageBox::information(this, "导出完成",
         QString("已导出 %1 个无效API").arg(count));
@@ -362,13 +485,15 @@ void ResultWidget::onExportAll()
     }
 
     QTextStream out(&file);
-    for (const auto &result : m_allResults) {
+    qint64 count = 0;
+    forEachResult([&](const ApiCheckResult &result) {
         QString statusIcon = result.isValid() ? "✓" : (result.isInvalid() ? "✗" : "!");
         out << statusIcon << " " << result.key << " - " << result.message << "\n";
-    }
+        count++;
+    });
 
     QMessageBox::information(this, "导出完成",
-        QString("已导出 %1 条记录").arg(m_allResults.size()));
+        QString("已导出 %1 条记录").arg(count));
 }
 
 void ResultWidget::onExportJson()
@@ -381,7 +506,7 @@ void ResultWidget::onExportJson()
     }
 
     QJsonArray jsonArray;
-    for (const auto &result : m_allResults) {
+    forEachResult([&](const ApiCheckResult &result) {
         QJsonObject obj;
         obj["key"] = result.key;
         obj["status"] = result.status;
@@ -389,7 +514,7 @@ void ResultWidget::onExportJson()
         obj["response_time_ms"] = result.responseTime;
         obj["checked_at"] = result.checkedAt.toString(Qt::ISODate);
         jsonArray.append(obj);
-    }
+    });
 
     QJsonDocument doc(jsonArray);
 
@@ -401,5 +526,5 @@ void ResultWidget::onExportJson()
 
     file.write(doc.toJson());
     QMessageBox::information(this, "导出完成",
-        QString("已导出 %1 条记录").arg(m_allResults.size()));
+        QString("已导出 %1 条记录").arg(jsonArray.size()));
 }
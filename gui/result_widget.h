@@ -9,7 +9,10 @@
 #include <QSplitter>
 #include <QTextEdit>
 #include <QGroupBox>
+#include <QTableView>
+#include <functional>
 #include "checker_thread.h"
+#include "result_store_model.h"
 
 class ResultWidget : public QWidget
 {
@@ -23,12 +26,16 @@ public:
     void exportResults();
     void clearResults();
 
+    // 打开列式结果文件（.apcr），按需从映射的文件读取，不把结果载入内存
+    bool openResultStore(const QString &filePath);
+
 private slots:
     void onFilterChanged(int index);
     void onExportValid();
     void onExportInvalid();
     void onExportAll();
     void onExportJson();
+    void onOpenResultStore();
     void onSelectionChanged();
     void onSearchTextChanged(const QString &text);
 
@@ -39,6 +46,11 @@ private:
     void populateTable(const QVector<ApiCheckResult> &results);
     void applyFilter();
     void showResultDetails(const ApiCheckResult &result);
+    void closeResultStore();
+    bool isStoreMode() const;
+
+    // 依次处理全部结果（内存中的结果或已打开的结果文件），用于导出
+    void forEachResult(const std::function<void(const ApiCheckResult &)> &fn) const;
 
     QTableWidget *m_resultTable;
     QLineEdit *m_searchEdit;
@@ -54,10 +66,14 @@ private:
     QPushButton *m_exportInvalidButton;
     QPushButton *m_exportAllButton;
     QPushButton *m_exportJsonButton;
+    QPushButton *m_openStoreButton;
 
     QTextEdit *m_detailView;
     QSplitter *m_splitter;
 
+    QTableView *m_storeView;
+    ResultStoreModel *m_storeModel;
+
     QVector<ApiCheckResult> m_allResults;
     QVector<ApiCheckResult> m_filteredResults;
 };
@@ -109,7 +109,27 @@ void SettingsWidget::setupUi()
     saveForm->addRow(m_autoResumeCheck);
     saveForm->addRow("最大历史记录:", m_maxHistorySpin);
 
+    // 历史数据库的保留策略，由历史页在空闲时于后台执行
+    QGroupBox *retentionGroup = new QGroupBox("历史数据库", progressTab);
+    QFormLayout *retentionForm = new QFormLayout(retentionGroup);
+
+    m_retentionDaysSpin = new QSpinBox(progressTab);
+    m_retentionDaysSpin->setRange(0, 3650);
+    m_retentionDaysSpin->setValue(0);
+    m_retentionDaysSpin->setSpecialValueText("不限制");
+    m_retentionDaysSpin->setSuffix(" 天");
+
+    m_maxResultRowsSpin = new QSpinBox(progressTab);
+    m_maxResultRowsSpin->setRange(0, 100000);
+    m_maxResultRowsSpin->setValue(0);
+    m_maxResultRowsSpin->setSpecialValueText("不限制");
+    m_maxResultRowsSpin->setSuffix(" 万条");
+
+    retentionForm->addRow("保留天数:", m_retentionDaysSpin);
+    retentionForm->addRow("最多保存结果:", m_maxResultRowsSpin);
+
     progressLayout->addWidget(saveGroup);
+    progressLayout->addWidget(retentionGroup);
     progressLayout->addStretch();
 
     QWidget *interfaceTab = new QWidget(this);
@@ -192,6 +212,9 @@ void SettingsWidget::loadSettings()
     m_saveIntervalSpin->setValue(settings.value("progress/save_interval", 30).toInt());
     m_autoResumeCheck->setChecked(settings.value("progress/auto_resume", false).toBool());
     m_maxHistorySpin->setValue(settings.value("progress/max_history", 100).toInt());
+    m_retentionDaysSpin->setValue(settings.value("history/retention_days", 0).toInt());
+    m_maxResultRowsSpin->setValue(static_cast<int>(
+        settings.value("history/max_result_rows", 0).toLongLong() / RESULT_ROWS_UNIT));
 
     m_showProgressBarCheck->setChecked(settings.value("ui/show_progress", true).toBool());
     m_coloredOutputCheck->setChecked(settings.value("ui/colored_output", true).toBool());
@@ -215,6 +238,9 @@ void SettingsWidget::saveSettings()
     settings.setValue("progress/save_interval", m_saveIntervalSpin->value());
     settings.setValue("progress/auto_resume", m_autoResumeCheck->isChecked());
     settings.setValue("progress/max_history", m_maxHistorySpin->value());
+    settings.setValue("history/retention_days", m_retentionDaysSpin->value());
+    settings.setValue("history/max_result_rows",
+                      static_cast<qint64>(m_maxResultRowsSpin->value()) * RESULT_ROWS_UNIT);
 
     settings.setValue("ui/show_progress", m_showProgressBarCheck->isChecked());
     settings.setValue("ui/colored_output", m_coloredOutputCheck->isChecked());
@@ -236,6 +262,8 @@ void SettingsWidget::restoreDefaults()
     m_saveIntervalSpin->setValue(30);
     m_autoResumeCheck->setChecked(false);
     m_maxHistorySpin->setValue(100);
+    m_retentionDaysSpin->setValue(0);
+    m_maxResultRowsSpin->setValue(0);
 
     m_showProgressBarCheck->setChecked(true);
     m_coloredOutputCheck->setChecked(true);
@@ -288,6 +316,8 @@ void SettingsWidget::onExportConfig()
     config["save_interval"] = m_saveIntervalSpin->value();
     config["auto_resume"] = m_autoResumeCheck->isChecked();
     config["max_history"] = m_maxHistorySpin->value();
+    config["retention_days"] = m_retentionDaysSpin->value();
+    config["max_result_rows"] = static_cast<qint64>(m_maxResultRowsSpin->value()) * RESULT_ROWS_UNIT;
     config["show_progress"] = m_showProgressBarCheck->isChecked();
     config["colored_output"] = m_coloredOutputCheck->isChecked();
     config["log_level"] = m_logLevelCombo->currentText();
@@ -340,6 +370,9 @@ void SettingsWidget::onImportConfig()
     m_saveIntervalSpin->setValue(config.value("save_interval").toInt(30));
     m_autoResumeCheck->setChecked(config.value("auto_resume").toBool(false));
     m_maxHistorySpin->setValue(config.value("max_history").toInt(100));
+    m_retentionDaysSpin->setValue(config.value("retention_days").toInt(0));
+    m_maxResultRowsSpin->setValue(static_cast<int>(
+        config.value("max_result_rows").toInteger(0) / RESULT_ROWS_UNIT));
     m_showProgressBarCheck->setChecked(config.value("show_progress").toBool(true));
     m_coloredOutputCheck->setChecked(config.value("colored_output").toBool(true));
     m_logLevelCombo->setCurrentText(config.value("log_level").toString("信息"));
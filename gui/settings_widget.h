@@ -16,6 +16,9 @@ class SettingsWidget : public QWidget
     Q_OBJECT
 
 public:
+    // "最多保存结果"以万条为单位设置，保存为行数
+    static constexpr qint64 RESULT_ROWS_UNIT = 10000;
+
     explicit SettingsWidget(QWidget *parent = nullptr);
 
 private slots:
@@ -44,6 +47,8 @@ private:
     QSpinBox *m_saveIntervalSpin;
     QCheckBox *m_autoResumeCheck;
     QSpinBox *m_maxHistorySpin;
+    QSpinBox *m_retentionDaysSpin;
+    QSpinBox *m_maxResultRowsSpin;
 
     QCheckBox *m_showProgressBarCheck;
     QCheckBox *m_coloredOutputCheck;
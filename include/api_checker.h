@@ -7,9 +7,14 @@
 #include <chrono>
 #include <future>
 #include <optional>
-#include <unordered_set>
 #include <filesystem>
+#include <functional>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "bounded_channel.h"
+#include "key_harvester.h"
+#include "tail_follower.h"
+#include "completion_bitmap.h"
 
 namespace api_checker {
 
@@ -20,14 +25,36 @@ enum class KeyStatus {
     Pending  // 新增：待检测状态
 };
 
+// 检测结果消息的类别，进度日志只保存类别和HTTP状态码，回放时据此还原消息文本
+enum class MessageCode : uint8_t {
+    None,
+    Valid,          // 有效
+    AuthFailed,     // 认证失败 (401)
+    Forbidden,      // 访问被拒绝 (403)
+    RateLimited,    // 请求过多 (429)
+    ServerError,    // 服务器错误 (5xx)
+    HttpError,      // 其他HTTP状态码
+    RequestError,   // 网络或超时等请求错误
+    EmptyKey,       // 空key
+    UnknownFormat   // 无法识别的key格式
+};
+
 struct KeyResult {
     std::string key;
     KeyStatus status;
     std::string message;
     std::chrono::system_clock::time_point checked_at;
     std::optional<std::chrono::milliseconds> response_time;
+    std::string provider{};  // key所属服务商，无法识别时为空
+    std::string source{};    // key的出处（如 "路径:行号"），未知时为空
+    MessageCode message_code = MessageCode::None;
+    uint16_t http_status = 0;  // 未收到HTTP响应时为0
 
     nlohmann::json to_json() const;
+
+    // 按消息类别生成消息文本，detail为请求错误的具体原因
+    static std::string describe(MessageCode code, uint16_t http_status,
+                                const std::string& detail = "");
 };
 
 struct CheckStats {
@@ -43,6 +70,11 @@ struct CheckStats {
     size_t concurrent_used = 0;
     size_t timeout_used = 0;
 
+    CheckStats() = default;
+    // 计数器是原子变量，拷贝时读取当前值（用于生成结果快照）
+    CheckStats(const CheckStats& other);
+    CheckStats& operator=(const CheckStats& other);
+
     nlohmann::json to_json() const;
 };
 
@@ -60,7 +92,7 @@ struct CheckProgress {
     std::string input_file;
     std::vector<std::string> all_keys;
     std::vector<KeyResult> completed_results;
-    std::unordered_set<std::string> processed_keys;
+    CompletionBitmap completed;  // 按all_keys中的序号记录是否已完成
     CheckStats stats;
     std::chrono::system_clock::time_point last_save_time;
     size_t concurrent_used = 1000;
@@ -76,8 +108,27 @@ struct CheckProgress {
     bool is_key_processed(const std::string& key) const;
 };
 
+// 流水线中传递的待检测key
+struct KeyItem {
+    std::string key;
+    std::string source;   // 出处，会原样写入检测结果
+    uint64_t ticket = 0;  // 生产者自定义的标识，原样传给结果回调
+};
+
+// key生产者：向通道写入待检测的key，返回时通道将被关闭
+using KeyProducer = std::function<void(BoundedChannel<KeyItem>& channel)>;
+
+// 单个key检测完成的回调，在工作线程中并发调用
+// 传入回调时结果只交给回调，返回的CheckResults中只有统计信息
+using ResultCallback = std::function<void(const KeyResult& result, const KeyItem& item)>;
+
+class ProgressJournal;
+
 class APIKeyChecker {
 public:
+    // 流水线检测时通道的默认容量
+    static constexpr size_t DEFAULT_CHANNEL_CAPACITY = 4096;
+
     APIKeyChecker(size_t timeout_secs = 10, size_t connect_timeout = 5,
                   size_t concurrent = 1000);
     ~APIKeyChecker();
@@ -90,6 +141,37 @@ public:
                            size_t concurrent = 1000,
                            bool quiet = false);
 
+    // 流水线检测：生产者线程解析key写入有界通道，工作线程边解析边检测
+    CheckResults check_keys_pipelined(const KeyProducer& producer,
+                                      size_t concurrent = 1000,
+                                      size_t channel_capacity = DEFAULT_CHANNEL_CAPACITY,
+                                      bool quiet = false,
+                                      const ResultCallback& on_result = {});
+
+    // 流式检测文件中的API Keys，无需等待整个文件解析完成
+    CheckResults check_file_pipelined(const std::string& input_file,
+                                      size_t concurrent = 1000,
+                                      size_t channel_capacity = DEFAULT_CHANNEL_CAPACITY,
+                                      bool quiet = false,
+                                      const ResultCallback& on_result = {});
+
+    // 并行遍历目录树提取key并流式检测，结果带有 "路径:行号" 出处
+    CheckResults check_directory_pipelined(const std::string& root,
+                                           const HarvestOptions& options = {},
+                                           size_t concurrent = 1000,
+                                           size_t channel_capacity = DEFAULT_CHANNEL_CAPACITY,
+                                           bool quiet = false,
+                                           const ResultCallback& on_result = {});
+
+    // 跟随文件或目录，检测新追加的key，直到调用stop()
+    // 每个key检测完成后才确认其偏移，重启后从已确认的位置继续
+    CheckResults check_file_following(const std::string& path,
+                                      const TailOptions& options = {},
+                                      size_t concurrent = 1000,
+                                      size_t channel_capacity = DEFAULT_CHANNEL_CAPACITY,
+                                      bool quiet = false,
+                                      const ResultCallback& on_result = {});
+
     // 带进度保存的批量检测
     CheckResults check_keys_with_progress(const std::vector<std::string>& api_keys,
                                          const std::string& input_file,
@@ -103,16 +185,30 @@ public:
     // 查找最新的进度文件
     static std::optional<std::string> find_latest_progress_file(const std::string& input_file);
 
+    // 合并同一输入的多个进度文件（崩溃、重启或分片运行留下的部分进度）：
+    // 同一key以检测时间最新的结果为准，写成一份压缩后的进度日志，成功后删除被合并的文件。
+    // 输入与第一个文件不同的进度文件会被跳过；output_file 为空时自动命名，返回合并后的文件
+    static std::optional<std::string> merge_progress_files(const std::vector<std::string>& progress_files,
+                                                           const std::string& output_file = "");
+
+    // 只保留最近保存的max_files个进度文件（AppConfig::max_progress_files），0表示不限制
+    // 返回删除的文件数
+    static size_t prune_progress_files(size_t max_files, const std::string& dir = ".");
+
+    // 进度保存间隔（AppConfig::save_interval_seconds），后台线程按此间隔提交进度日志
+    void set_save_interval(std::chrono::seconds interval);
+    std::chrono::seconds save_interval() const { return save_interval_; }
+
     // 停止检测
     void stop();
 
     // 获取当前统计
     const CheckStats& get_stats() const { return stats_; }
 
-    // 保存当前进度
+    // 把完整进度写成一份进度日志（.journal）快照
     bool save_progress(const CheckProgress& progress, const std::string& progress_file = "");
 
-    // 加载进度文件
+    // 加载进度文件，支持进度日志和旧版JSON格式
     static std::optional<CheckProgress> load_progress(const std::string& progress_file);
 
 private:
@@ -125,13 +221,18 @@ private:
     // 进度保存相关
     std::string current_session_id_;
     std::string current_progress_file_;
-    std::chrono::steady_clock::time_point last_save_time_;
-    static constexpr std::chrono::seconds SAVE_INTERVAL{30}; // 每30秒保存一次
-
-    // 内部检测方法（支持进度保存）
-    CheckResults check_keys_internal(const std::vector<std::string>& api_keys,
-                                   size_t concurrent, bool quiet,
-                                   CheckProgress* progress);
+    std::chrono::seconds save_interval_{30};
+
+    // 将单个检测结果计入统计，results非空时同时加入结果集（调用方负责加锁）
+    void record_result(const KeyResult& result, CheckResults* results);
+
+    // 内部检测方法：检测all_keys中在completed里尚未完成的key，结果追加到进度日志，
+    // 结束时把完成位图写入侧文件
+    CheckResults check_keys_internal(const std::vector<std::string>& all_keys,
+                                     uint64_t fingerprint,
+                                     CompletionBitmap& completed,
+                                     size_t concurrent, bool quiet,
+                                     ProgressJournal& journal);
 };
 
 } // namespace api_checker
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "api_checker.h"
+#include "config_manager.h"
+#include "result_store.h"
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace api_checker {
+
+// 检测结果的接收端
+// CheckSession保证同一时刻只有一个线程调用接收端，实现时无需加锁
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    // 每检测完一个key调用一次，调用顺序即完成顺序
+    virtual void on_result(const KeyResult& result) = 0;
+
+    // 一次运行结束时调用
+    virtual void on_finish(const CheckStats& stats) { (void)stats; }
+};
+
+// 每个结果写一行JSON（NDJSON），写完立即刷新，便于下游边读边处理
+class NdjsonSink : public ResultSink {
+public:
+    explicit NdjsonSink(std::ostream& out, bool only_valid = false);
+
+    void on_result(const KeyResult& result) override;
+
+private:
+    std::ostream& out_;
+    bool only_valid_;
+};
+
+// 把结果按状态收集到内存中，适合数量有限的批量检测
+class CollectingSink : public ResultSink {
+public:
+    void on_result(const KeyResult& result) override;
+    void on_finish(const CheckStats& stats) override;
+
+    const CheckResults& results() const { return results_; }
+    CheckResults take_results() { return std::move(results_); }
+
+private:
+    CheckResults results_;
+};
+
+// 把结果写入列式结果文件（见 result_store.h），每次运行结束时刷新
+class ResultStoreSink : public ResultSink {
+public:
+    explicit ResultStoreSink(const std::string& path);
+
+    bool is_open() const { return writer_.is_open(); }
+
+    void on_result(const KeyResult& result) override;
+    void on_finish(const CheckStats& stats) override;
+
+private:
+    ResultStoreWriter writer_;
+};
+
+struct SessionOptions {
+    size_t concurrent = 1000;
+    size_t timeout_secs = 10;
+    size_t connect_timeout_secs = 5;
+    size_t channel_capacity = APIKeyChecker::DEFAULT_CHANNEL_CAPACITY;
+    size_t save_interval_secs = 30;  // 进度日志的成组提交间隔
+    bool quiet = true;  // 为false时在stdout输出检测过程信息
+
+    // 从应用配置中读取并发数、超时和进度保存间隔
+    static SessionOptions from_config(const AppConfig& config);
+};
+
+// 流式检测会话：从生产者拉取key，边检测边把结果分发给接收端
+// 不依赖Qt，图形界面、命令行和基准程序都通过它使用检测引擎
+class CheckSession {
+public:
+    explicit CheckSession(SessionOptions options = {});
+    ~CheckSession();
+
+    CheckSession(const CheckSession&) = delete;
+    CheckSession& operator=(const CheckSession&) = delete;
+
+    // 添加结果接收端，接收端的生命周期需覆盖整个运行过程
+    void add_sink(ResultSink& sink);
+
+    // 以下方法阻塞运行直到输入结束或调用stop()，返回本次运行的统计
+    // 输入路径不存在时抛出std::runtime_error
+    CheckStats run(const KeyProducer& producer);
+    CheckStats run_keys(const std::vector<std::string>& keys);
+    CheckStats run_file(const std::string& input_file);
+    CheckStats run_directory(const std::string& root, const HarvestOptions& options = {});
+    CheckStats run_following(const std::string& path, const TailOptions& options = {});
+
+    // 请求停止，可在任意线程（包括信号处理函数）中调用；停止后会话不能再次运行
+    void stop();
+
+    // 实时统计，运行过程中可在其他线程读取计数
+    const CheckStats& stats() const;
+
+    const SessionOptions& options() const { return options_; }
+
+    // 底层检测引擎，带进度保存的检测（check_keys_with_progress / resume_from_progress）
+    // 经由它进行，沿用会话的超时和进度保存间隔
+    APIKeyChecker& checker() { return *checker_; }
+
+private:
+    // 把单个结果分发给所有接收端
+    void dispatch(const KeyResult& result);
+    CheckStats finish(const CheckResults& results);
+    ResultCallback make_callback();
+
+    SessionOptions options_;
+    std::unique_ptr<APIKeyChecker> checker_;
+    std::vector<ResultSink*> sinks_;
+    std::mutex sinks_mutex_;
+};
+
+} // namespace api_checker
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace api_checker {
+
+// 按key序号记录是否已完成的位图，每个key占1位
+// 待处理序号按64位字扫描，整字全部完成时一次跳过
+class CompletionBitmap {
+public:
+    CompletionBitmap() = default;
+    explicit CompletionBitmap(size_t size);
+
+    // 调整位数，新增的位为未完成
+    void resize(size_t size);
+
+    size_t size() const { return size_; }
+    bool test(size_t index) const;
+
+    // 标记为已完成，原来未完成时返回true
+    bool set(size_t index);
+
+    // 已完成的数量
+    size_t count() const;
+
+    // 按升序返回所有未完成的序号
+    std::vector<uint32_t> unset_positions() const;
+
+    const std::vector<uint64_t>& words() const { return words_; }
+
+    // 从序列化的字恢复，多余的高位会被清除
+    static CompletionBitmap from_words(size_t size, std::vector<uint64_t> words);
+
+private:
+    std::vector<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+} // namespace api_checker
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstddef>
+
+namespace api_checker {
+
+enum class Compression {
+    None,
+    Gzip,
+    Zstd
+};
+
+// 根据文件头魔数识别压缩格式
+Compression detect_compression(std::string_view header);
+
+// 根据扩展名（.gz / .zst）确定写入时使用的压缩格式
+Compression compression_from_path(const std::string& file_path);
+
+// 流式解压读取器：自动识别gzip/zstd，未压缩文件按原样读取
+class DecompressingReader {
+public:
+    DecompressingReader();
+    ~DecompressingReader();
+
+    DecompressingReader(const DecompressingReader&) = delete;
+    DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+    // 打开文件并根据魔数选择解压方式
+    bool open(const std::string& file_path);
+
+    // 读取最多size字节的解压数据，返回0表示已结束或出错
+    size_t read(char* buffer, size_t size);
+
+    // 是否发生了读取或解压错误
+    bool failed() const;
+    const std::string& error_message() const;
+
+    Compression compression() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+// 流式压缩写入器
+class CompressingWriter {
+public:
+    CompressingWriter();
+    ~CompressingWriter();
+
+    CompressingWriter(const CompressingWriter&) = delete;
+    CompressingWriter& operator=(const CompressingWriter&) = delete;
+
+    bool open(const std::string& file_path, Compression compression);
+
+    bool write(std::string_view data);
+
+    // 写出剩余的压缩数据并关闭文件
+    bool close();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace api_checker
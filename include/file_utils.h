@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <functional>
 
 namespace api_checker {
 
@@ -14,6 +15,16 @@ public:
     // 写入文件内容
     static bool write_file(const std::string& file_path, const std::string& content);
 
+    // 原子写入：先写入同目录的临时文件并同步，再重命名替换目标文件并同步目录，
+    // 崩溃后目标文件要么是旧内容要么是新内容，不会只写了一半（不做压缩）
+    static bool write_file_atomic(const std::string& file_path, const std::string& content);
+
+    // 用已同步的临时文件原子替换目标文件，并同步所在目录使重命名持久化
+    static bool replace_file(const std::string& temp_path, const std::string& file_path);
+
+    // 同步目录，使其中新建、重命名的文件在崩溃后仍然存在（Windows上无需此操作）
+    static bool sync_directory(const std::string& dir_path);
+
     // 检查文件是否存在
     static bool file_exists(const std::string& file_path);
 
@@ -24,9 +35,21 @@ public:
     static std::optional<size_t> get_file_size(const std::string& file_path);
 
     // 从文件加载API Keys
-    static std::vector<std::string> load_api_keys(const std::string& file_path);
+    // 文件无法打开或解压失败时返回空列表，输出错误并把原因写入error_message（非空时）
+    static std::vector<std::string> load_api_keys(const std::string& file_path,
+                                                  std::string* error_message = nullptr);
+
+    // 流式读取API Keys，每解析出一个key即回调，回调返回false时停止读取
+    // 返回已回调的key数量，文件无法打开时返回0
+    // 文件无法打开或解压失败（数据截断/损坏、未启用对应压缩格式）时输出错误，
+    // 并把原因写入error_message（非空时），此前已回调的key不会撤回
+    static size_t for_each_api_key(const std::string& file_path,
+                                   const std::function<bool(std::string)>& on_key,
+                                   std::string* error_message = nullptr);
 
     // 查找API Keys文件
+    // 依次检查常用文件名，再只探测当前目录下 .txt 文件的开头部分，
+    // 探测结果按 (路径, 修改时间, 大小) 缓存，未变化的文件不会重复读取
     static std::optional<std::string> find_api_keys_file();
 
     // 生成时间戳文件名
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace api_checker {
+
+struct HarvestOptions {
+    // 工作线程数，0 表示使用全部CPU核心
+    size_t threads = 0;
+
+    // 按文件名或目录名匹配的忽略规则，支持 * 和 ? 通配符
+    // 默认忽略版本库元数据、依赖目录和常见的二进制/压缩文件
+    std::vector<std::string> ignore_patterns = {
+        ".git", ".hg", ".svn", "node_modules", "__pycache__", ".venv",
+        "*.png", "*.jpg", "*.jpeg", "*.gif", "*.ico", "*.webp", "*.pdf",
+        "*.zip", "*.gz", "*.zst", "*.xz", "*.bz2", "*.7z", "*.tar", "*.jar",
+        "*.so", "*.dll", "*.dylib", "*.exe", "*.o", "*.a", "*.obj", "*.lib", "*.class",
+        "*.woff", "*.woff2", "*.ttf", "*.otf", "*.mp3", "*.mp4"
+    };
+
+    // 检查文件开头这么多字节，出现NUL字节即视为二进制文件
+    size_t binary_probe_bytes = 8192;
+
+    // 超过该大小的文件直接跳过，0 表示不限制
+    size_t max_file_size = 0;
+
+    // 同一个key只回调第一次出现的位置
+    bool deduplicate = true;
+};
+
+// 从目录中提取到的key及其出处
+struct HarvestedKey {
+    std::string key;
+    std::string provider;
+    std::string path;
+    size_t line = 0;  // 从1开始的行号
+
+    // "路径:行号" 形式的出处
+    std::string source() const;
+};
+
+struct HarvestStats {
+    size_t directories = 0;
+    size_t files_scanned = 0;
+    size_t files_skipped = 0;  // 被忽略、二进制、过大或无法打开的文件
+    size_t bytes_scanned = 0;
+    size_t keys_found = 0;
+};
+
+// 并行递归目录扫描器
+// 每个工作线程维护自己的任务队列，从队尾取任务（深度优先，局部性好），
+// 空闲时从其他线程的队首窃取任务（通常是更大的子树）。
+// 候选文件通过内存映射交给 KeyScanner 扫描，不需要先用grep过一遍。
+class KeyHarvester {
+public:
+    // 扫描root（目录或单个文件），每找到一个key回调一次，回调返回false时停止扫描
+    // 回调会在多个工作线程中并发调用，调用方需要自行保证线程安全
+    static HarvestStats harvest(const std::string& root, const HarvestOptions& options,
+                                const std::function<bool(const HarvestedKey&)>& on_key);
+
+    // 通配符匹配，* 匹配任意字符序列，? 匹配单个字符
+    static bool matches_pattern(std::string_view name, std::string_view pattern);
+};
+
+} // namespace api_checker
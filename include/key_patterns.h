@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace api_checker {
+
+// key主体允许的字符集
+enum class KeyCharset {
+    Alnum,                // [A-Za-z0-9]
+    AlnumDashUnderscore,  // [A-Za-z0-9_-]
+    Hex                   // [0-9a-fA-F]
+};
+
+// 单个服务商的key格式：固定前缀 + 指定字符集的主体
+struct KeyPattern {
+    std::string provider;
+    std::string prefix;
+    KeyCharset charset = KeyCharset::Alnum;
+    size_t min_body = 0;
+    size_t max_body = 0;  // 0 表示不限制长度
+
+    // 检测该类key使用的端点和请求头，请求头中的 {key} 会被替换为实际key
+    std::string test_url;
+    std::vector<std::string> headers;
+};
+
+// key格式注册表，扫描器据此编译多模式自动机，检测器据此路由到对应端点
+class KeyPatternRegistry {
+public:
+    explicit KeyPatternRegistry(std::vector<KeyPattern> patterns);
+
+    // 内置的服务商格式（OpenAI、Anthropic、OpenRouter、Google、Groq、xAI、Hugging Face）
+    static const KeyPatternRegistry& defaults();
+
+    const std::vector<KeyPattern>& patterns() const { return patterns_; }
+
+    // 识别完整key所属的格式，无法识别时返回nullptr
+    // 多个前缀同时匹配时，前缀最长的格式优先
+    const KeyPattern* classify(std::string_view key) const;
+
+    // 判断字符是否属于字符集
+    static bool in_charset(char c, KeyCharset charset);
+
+    // 生成某个key的检测请求头
+    static std::vector<std::string> build_headers(const KeyPattern& pattern, const std::string& key);
+
+private:
+    std::vector<KeyPattern> patterns_;
+};
+
+} // namespace api_checker
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "key_patterns.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace api_checker {
+
+// 扫描到的key及其所属的格式
+struct DetectedKey {
+    std::string key;
+    const KeyPattern* pattern = nullptr;
+    size_t offset = 0;  // 在被扫描文本中的字节偏移
+};
+
+// 多服务商API Key扫描器
+// 将注册表中的所有前缀编译为一个Aho-Corasick自动机（完整的DFA转移表），
+// 单遍扫描提取文本中每一个符合格式的key：前缀之前不能是字母数字，
+// 多个前缀在同一位置匹配时前缀最长的格式优先，主体按字符集贪婪匹配。
+// 自动机处于初始状态时用 AVX2/SSE2 按前缀的前两个字节跳过无关内容，
+// 不支持时回退到标量实现。
+class KeyScanner {
+public:
+    // 每个并行分块的最小字节数，低于该值时多线程的开销大于收益
+    static constexpr size_t MIN_PARALLEL_CHUNK = 8 << 20;
+
+    // registry 需要在扫描器的整个生命周期内有效
+    explicit KeyScanner(const KeyPatternRegistry& registry);
+
+    // 使用内置注册表编译的扫描器
+    static const KeyScanner& instance();
+
+    // 扫描文本并追加到keys，返回新增数量
+    // skip_comments为true时按key列表文件处理，跳过行首为#的注释行
+    size_t find(std::string_view text, std::vector<DetectedKey>& keys,
+                bool skip_comments = true) const;
+
+    // 按换行对齐切分为多块并行扫描，结果按文件顺序拼接，与find()一致
+    // threads为0时使用全部CPU核心，文本较小时直接单线程扫描
+    size_t find_parallel(std::string_view text, std::vector<DetectedKey>& keys,
+                         size_t threads = 0, bool skip_comments = true) const;
+
+    // 使用内置注册表扫描key列表文本，只保留key字符串
+    static size_t scan(std::string_view text, std::vector<std::string>& keys);
+    static size_t scan_parallel(std::string_view text, std::vector<std::string>& keys,
+                                size_t threads = 0);
+
+    // 返回文本中完整行（以最后一个换行符结尾）的长度，用于分块流式扫描
+    static size_t complete_lines_length(std::string_view text);
+
+    // 当前编译使用的指令集名称（avx2 / sse2 / scalar）
+    static const char* simd_backend();
+
+private:
+    // 以下模板只在key_scanner.cpp中实例化
+    // emit(results, start, end, pattern) 把每个匹配追加到results
+    template <typename Result, typename Emit>
+    size_t scan_text(const char* base, std::string_view text, bool skip_comments,
+                     std::vector<Result>& results, const Emit& emit) const;
+    template <typename Result, typename Emit>
+    size_t scan_range(const char* base, const char* begin, const char* end, bool skip_comments,
+                      std::vector<Result>& results, const Emit& emit) const;
+    template <typename Result, typename Emit>
+    size_t scan_parallel_impl(std::string_view text, size_t threads, bool skip_comments,
+                              std::vector<Result>& results, const Emit& emit) const;
+
+    // 尝试在start处匹配一个完整key，成功时返回key结束位置，否则返回nullptr
+    const char* match_at(const char* start, const char* end, const KeyPattern*& pattern) const;
+
+    // 跳到下一个可能是前缀开头的位置
+    const char* next_candidate(const char* p, const char* end) const;
+
+    const KeyPatternRegistry* registry_;
+
+    std::vector<uint16_t> transitions_;               // [状态 * 256 + 字节] -> 下一状态
+    std::vector<std::vector<uint8_t>> outputs_;       // 每个状态结束的前缀长度
+    std::array<std::vector<uint16_t>, 256> by_first_byte_;  // 首字节 -> 格式下标（前缀由长到短）
+    std::vector<std::array<char, 2>> prefilter_pairs_;      // 所有前缀的前两个字节
+    bool prefilter_ = false;
+};
+
+} // namespace api_checker
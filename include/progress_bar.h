@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+namespace api_checker {
+
+// 终端进度条，输出到stderr，不占用stdout（命令行版本用stdout输出结果）
+// 可在多个线程中并发调用，刷新频率限制在每秒约10次
+class ProgressBar {
+public:
+    ProgressBar(size_t total, bool enabled = true);
+
+    // 更新已完成数量
+    void update(size_t current);
+
+    // 设置显示在进度条右侧的消息
+    void set_message(const std::string& message);
+
+    // 绘制最终状态并换行
+    void finish(const std::string& message = "");
+
+private:
+    void draw(bool force);
+
+    size_t total_;
+    size_t current_ = 0;
+    bool enabled_;
+    bool finished_ = false;
+    std::string message_;
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point last_draw_{};
+    std::mutex mutex_;
+};
+
+} // namespace api_checker
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace api_checker {
+
+// 进度索引中的一个会话
+struct ProgressSession {
+    std::string file;          // 进度文件路径
+    std::string session_id;
+    std::string input_file;
+    uint64_t fingerprint = 0;  // key列表指纹
+    size_t total = 0;
+    size_t completed = 0;
+    std::chrono::system_clock::time_point last_save;
+
+    // 建立条目时进度文件的大小和修改时间，二者都未变化时直接使用索引中的信息
+    uintmax_t file_size = 0;
+    int64_t file_mtime = 0;
+};
+
+// 工作目录中进度文件的索引（.api_checker_progress_index）
+// 查找进度文件时每个文件只需stat一次，只有新增或变化的文件才读取日志头
+// （旧版JSON进度文件需要完整解析），读取结果写回索引供下次使用；
+// 无法解析的文件按 (路径, 大小, 修改时间) 记入索引，文件变化前不再重复解析
+class ProgressIndex {
+public:
+    // 扫描目录下的进度文件，返回与磁盘一致的会话列表；索引有变化时写回
+    static std::vector<ProgressSession> refresh(const std::string& dir = ".");
+
+    // 读取单个进度文件生成会话信息，无法识别时返回空
+    static std::optional<ProgressSession> describe(const std::string& progress_file);
+};
+
+} // namespace api_checker
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "api_checker.h"
+#include "completion_bitmap.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace api_checker {
+
+// 一条完成记录，在文件中占定长24字节（小端序，带CRC32校验）
+struct JournalRecord {
+    static constexpr uint32_t NO_RESPONSE_TIME = 0xFFFFFFFF;
+
+    uint32_t ordinal = 0;  // key在输入列表中的序号
+    KeyStatus status = KeyStatus::Pending;
+    MessageCode message_code = MessageCode::None;
+    uint16_t http_status = 0;
+    uint32_t response_ms = NO_RESPONSE_TIME;
+    int64_t checked_at_ms = 0;  // Unix时间戳（毫秒）
+
+    static JournalRecord from_result(uint32_t ordinal, const KeyResult& result);
+
+    // 还原检测结果，服务商按key格式重新识别
+    KeyResult to_result(const std::string& key) const;
+};
+
+// 自定义的检测请求（图形界面的端点、方法、请求头和请求体）
+// 命令行检测按key格式路由，不记录；恢复时按创建日志时的请求继续检测
+struct JournalRequest {
+    std::string endpoint;
+    std::string method;
+    std::string headers;
+    std::string body;
+
+    bool operator==(const JournalRequest& other) const {
+        return endpoint == other.endpoint && method == other.method &&
+               headers == other.headers && body == other.body;
+    }
+    bool operator!=(const JournalRequest& other) const { return !(*this == other); }
+};
+
+// 日志头：运行配置、输入指纹和key列表，创建日志时写入一次
+// 输入文件解析出的key列表与本次检测一致时只记录路径和指纹（keys_external），
+// 恢复时重新读取输入文件并校验指纹；否则key列表内嵌在日志头中
+struct JournalHeader {
+    std::string session_id;
+    std::string input_file;
+    uint64_t fingerprint = 0;  // key列表的指纹，见 ProgressJournal::fingerprint
+    uint64_t key_count = 0;
+    bool keys_external = false;
+    size_t concurrent = 1000;
+    size_t timeout = 10;
+    std::optional<JournalRequest> request;
+    std::chrono::system_clock::time_point created_at;
+    std::vector<std::string> keys;  // 只在回放并加载key列表时填充
+};
+
+struct JournalOptions {
+    // 成组提交：后台线程每隔一个间隔，或缓冲的记录数达到上限时，一次写入并同步
+    // 崩溃时最多丢失约一个间隔内完成的记录，已同步的记录不会丢失
+    size_t group_commit_records = 512;
+    std::chrono::milliseconds group_commit_interval{1000};
+
+    // 两次同步之间的最短间隔：检测很快时批量阈值频繁触发，以此限制每秒fsync的次数
+    std::chrono::milliseconds min_sync_interval{100};
+
+    // 提交时是否fsync，关闭后只保证写入操作系统缓存
+    bool sync = true;
+
+    // 同一序号被重新检测时旧记录即被覆盖；被覆盖的记录累计到这么多条时，
+    // 后台线程在提交后把日志压缩为快照，0 表示只在恢复和检测结束时压缩
+    size_t compact_superseded_records = 65536;
+};
+
+// 回放日志得到的状态
+struct JournalReplay {
+    JournalHeader header;
+    std::vector<JournalRecord> records;  // 按序号排序，同一序号只保留最后一条
+    size_t raw_records = 0;              // 文件中有效记录的条数（含重复）
+    size_t records_offset = 0;           // 第一条记录的偏移，即日志头的总长度
+    size_t replayed_from = 0;            // 本次回放开始读取记录的偏移
+    size_t valid_bytes = 0;              // 日志头和有效记录的总长度
+    size_t torn_bytes = 0;               // 末尾不完整或校验失败而丢弃的字节数
+    std::chrono::system_clock::time_point last_checked_at;  // 最后一条记录的检测时间
+};
+
+// 完成位图侧文件（<日志>.bitmap）：日志前 journal_bytes 字节中所有记录的汇总
+// 恢复时先加载侧文件，只需回放其后追加的记录；侧文件缺失或过期时回放整个日志
+struct CompletionSidecar {
+    CompletionBitmap bitmap;
+    uint64_t fingerprint = 0;    // 与日志头的指纹一致才可使用
+    uint64_t journal_bytes = 0;  // 已汇总到的日志长度
+    uint64_t valid = 0;
+    uint64_t invalid = 0;
+    uint64_t error = 0;
+
+    // 写入临时文件后原子替换
+    bool save(const std::string& path) const;
+    static std::optional<CompletionSidecar> load(const std::string& path);
+};
+
+// 仅追加的二进制进度日志
+// 布局：日志头（固定字段 + JSON元数据 + key列表）之后是定长完成记录。
+// 每次保存只追加新完成的记录，开销与本批记录数成正比，与已完成总数无关；
+// 崩溃留下的半条记录在回放时通过长度和校验和识别并丢弃。
+// 记录由打开日志时启动的后台线程写入磁盘，见 JournalOptions。
+class ProgressJournal {
+public:
+    ProgressJournal();
+    ~ProgressJournal();
+
+    ProgressJournal(const ProgressJournal&) = delete;
+    ProgressJournal& operator=(const ProgressJournal&) = delete;
+
+    // 创建新日志（覆盖同名文件），日志头写入后立即同步
+    bool create(const std::string& path, const JournalHeader& header, JournalOptions options = {});
+
+    // 打开已有日志继续追加，末尾损坏的记录会先被截掉
+    bool open(const std::string& path, JournalOptions options = {});
+
+    // 追加一条完成记录，可在多个线程中并发调用；只写入内存缓冲，不等待磁盘I/O
+    void append(const JournalRecord& record);
+
+    // 立即在调用线程中提交缓冲中的记录
+    bool commit();
+
+    // 提交并关闭，析构时自动调用
+    void close();
+
+    bool is_open() const;
+    const std::string& path() const;
+
+    // 回放整个日志：校验日志头，逐条读取记录直到文件末尾或第一条损坏的记录
+    // load_keys 为false时不加载key列表（也不读取外部输入文件），只回放记录
+    // from_offset 为某条记录的起始偏移时只回放其后的记录，否则从第一条记录开始
+    static std::optional<JournalReplay> replay(const std::string& path, bool load_keys = true,
+                                               size_t from_offset = 0);
+
+    // 只读取日志头的固定字段和元数据，不读取key列表和记录
+    static std::optional<JournalHeader> read_header(const std::string& path);
+
+    // 压缩为快照：按序号去重排序后写入临时文件，同步后原子替换原日志
+    // 日志被重写时记录偏移随之改变，位图侧文件会被删除
+    static bool compact(const std::string& path);
+
+    // 把日志头和记录一次写成完整的日志快照：写入临时文件并同步后原子替换，删除过期的位图侧文件
+    // records 中每个序号只应出现一次
+    static bool write_snapshot(const std::string& path, const JournalHeader& header,
+                               const std::vector<JournalRecord>& records);
+
+    // 日志对应的位图侧文件路径
+    static std::string sidecar_path(const std::string& path);
+
+    // key列表的FNV-1a指纹，用于确认恢复时的输入与创建时一致
+    static uint64_t fingerprint(const std::vector<std::string>& keys);
+
+    // 流式解析输入文件并计算其key列表的指纹，不在内存中保留key；文件无法读取时返回空
+    static std::optional<uint64_t> fingerprint_file(const std::string& input_file, uint64_t& key_count);
+
+    // 按文件头魔数判断是否为进度日志
+    static bool is_journal(const std::string& path);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace api_checker
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "api_checker.h"
+#include "mapped_file.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace api_checker {
+
+// 列式结果文件（.apcr）：文件头之后是若干数据块，每块最多 ROWS_PER_BLOCK 行，
+// 块内各列连续存放：检测时间i64[n] 耗时u32[n] key结束偏移u32[n] HTTP状态码u16[n]
+// 状态u8[n] 消息类别u8[n]，最后是所有key拼接成的数据区。
+// 写入时攒满一块追加一次；读取时内存映射文件，只建立块索引，按行访问不需要解析，
+// 块数据的CRC在第一次访问该块时才校验，千万行的结果也能立即打开，内存占用与行数无关。
+class ResultStoreWriter {
+public:
+    static constexpr uint32_t ROWS_PER_BLOCK = 4096;
+
+    ResultStoreWriter();
+    ~ResultStoreWriter();
+
+    ResultStoreWriter(const ResultStoreWriter&) = delete;
+    ResultStoreWriter& operator=(const ResultStoreWriter&) = delete;
+
+    // 创建新文件（覆盖同名文件）
+    bool open(const std::string& path);
+
+    // 追加一行，可在多个线程中并发调用；攒满一块时写入文件
+    void append(const KeyResult& result);
+
+    // 把未满的块也写入文件，之后读取方可以看到目前为止的所有行
+    bool flush();
+
+    // 写入剩余的行并关闭，析构时自动调用
+    void close();
+
+    bool is_open() const;
+    size_t rows() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+class ResultStoreReader {
+public:
+    // 映射文件并校验文件头，按块头建立索引，末尾不完整的块被忽略
+    // 不读取块数据；块数据在第一次访问时校验，校验失败的块中各行读出空key和Pending状态
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return mapped_.is_open(); }
+    size_t size() const { return rows_; }
+    size_t torn_bytes() const { return torn_bytes_; }
+
+    // 行所在的块是否通过CRC校验，尚未校验时立即校验
+    bool intact(size_t row) const;
+
+    std::string_view key(size_t row) const;
+    KeyStatus status(size_t row) const;
+    MessageCode message_code(size_t row) const;
+    uint16_t http_status(size_t row) const;
+    std::optional<std::chrono::milliseconds> response_time(size_t row) const;
+    std::chrono::system_clock::time_point checked_at(size_t row) const;
+
+    // 还原为完整的检测结果，消息按类别重新生成，服务商按key格式重新识别
+    KeyResult result(size_t row) const;
+
+    // 统计某个状态的行数，只扫描状态列
+    size_t count(KeyStatus status) const;
+
+    // 某个状态的所有行号（升序），只扫描状态列
+    std::vector<uint32_t> rows_with_status(KeyStatus status) const;
+
+private:
+    struct Block {
+        const char* body = nullptr;  // 块内第一列的起始位置
+        size_t first_row = 0;
+        uint32_t rows = 0;
+        uint32_t blob_bytes = 0;
+        uint32_t crc = 0;
+    };
+
+    // 查找行所在的块，返回块和块内行号；块数据校验失败时返回空
+    const Block* locate(size_t row, uint32_t& index) const;
+
+    // 第一次访问块时校验CRC并记住结果，之后直接返回
+    bool verify(size_t block) const;
+
+    MappedFile mapped_;
+    std::vector<Block> blocks_;
+    // 各块的校验状态，见 result_store.cpp 中的 BlockState；只读访问可以来自多个线程
+    std::unique_ptr<std::atomic<uint8_t>[]> block_state_;
+    size_t rows_ = 0;
+    size_t torn_bytes_ = 0;
+};
+
+} // namespace api_checker
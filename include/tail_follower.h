@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace api_checker {
+
+struct TailOptions {
+    // 偏移记录文件，每行: inode \t 已确认偏移 \t 下一行行号 \t 路径
+    std::string offsets_file = ".api_checker_tail_offsets";
+
+    // 不支持inotify时的轮询间隔，使用inotify时作为兜底的最长等待时间
+    std::chrono::milliseconds poll_interval{1000};
+
+    // 偏移记录的最短保存间隔
+    std::chrono::milliseconds save_interval{1000};
+
+    // 每次读取的字节数，超长的行会自动扩大缓冲区
+    size_t read_chunk = 1 << 20;
+};
+
+// 跟随过程中发现的key
+struct TailKey {
+    std::string key;
+    std::string source;   // "路径:行号"
+    uint64_t ticket = 0;  // 处理完成后传给 acknowledge()
+};
+
+// 跟随文件或目录，增量提取追加的key
+// Linux上使用inotify等待写入，其他平台按固定间隔轮询。只处理以换行结尾的完整行，
+// 每个key处理完毕并确认后，偏移才推进到该行之后，重启时从已确认的偏移继续；
+// 没有偏移记录的文件从头读取。
+// 文件被截断时从头开始，被轮转（同一路径换了inode）时先读完旧文件再跟随新文件。
+class TailFollower {
+public:
+    // path 可以是单个文件，或者目录（跟随目录下的所有普通文件，包括新建的文件）
+    explicit TailFollower(const std::string& path, TailOptions options = {});
+    ~TailFollower();
+
+    TailFollower(const TailFollower&) = delete;
+    TailFollower& operator=(const TailFollower&) = delete;
+
+    // 阻塞运行，直到调用stop()、should_stop返回true或on_key返回false
+    // on_key只在调用run()的线程中调用；路径不存在时返回false
+    bool run(const std::function<bool(TailKey)>& on_key,
+             const std::function<bool()>& should_stop = {});
+
+    // 确认某个key已处理完毕，可在任意线程调用
+    void acknowledge(uint64_t ticket);
+
+    // 请求run()尽快返回，可在任意线程调用
+    void stop();
+
+    // 当前平台使用的等待方式（inotify / polling）
+    static const char* watch_backend();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace api_checker
@@ -1,6 +1,11 @@
 #include "api_checker.h"
 #include "http_client.h"
+#include "file_utils.h"
+#include "key_patterns.h"
 #include "progress_bar.h"
+#include "progress_journal.h"
+#include "progress_index.h"
+#include <iostream>
 #include <thread>
 #include <future>
 #include <queue>
@@ -10,9 +15,38 @@
 #include <iomanip>
 #include <sstream>
 #include <optional>
+#include <limits>
+#include <unordered_map>
+#include <string_view>
+#include <filesystem>
 
 namespace api_checker {
 
+std::string KeyResult::describe(MessageCode code, uint16_t http_status, const std::string& detail) {
+    switch (code) {
+        case MessageCode::Valid:
+            return "有效";
+        case MessageCode::AuthFailed:
+            return "认证失败";
+        case MessageCode::Forbidden:
+            return "访问被拒绝";
+        case MessageCode::RateLimited:
+            return "请求过多，稍后重试";
+        case MessageCode::ServerError:
+            return "服务器错误 " + std::to_string(http_status);
+        case MessageCode::HttpError:
+            return "HTTP " + std::to_string(http_status);
+        case MessageCode::RequestError:
+            return detail.empty() ? "请求错误" : "请求错误: " + detail;
+        case MessageCode::EmptyKey:
+            return "空 key";
+        case MessageCode::UnknownFormat:
+            return "无法识别的key格式";
+        default:
+            return detail;
+    }
+}
+
 // KeyResult JSON序列化
 nlohmann::json KeyResult::to_json() const {
     nlohmann::json j;
@@ -31,9 +65,42 @@ nlohmann::json KeyResult::to_json() const {
         j["response_time_ms"] = response_time->count();
     }
 
+    if (!provider.empty()) {
+        j["provider"] = provider;
+    }
+
+    if (http_status != 0) {
+        j["http_status"] = http_status;
+    }
+
+    if (!source.empty()) {
+        j["source"] = source;
+    }
+
     return j;
 }
 
+CheckStats::CheckStats(const CheckStats& other) {
+    *this = other;
+}
+
+CheckStats& CheckStats::operator=(const CheckStats& other) {
+    if (this != &other) {
+        total = other.total;
+        checked = other.checked.load();
+        valid = other.valid.load();
+        invalid = other.invalid.load();
+        error = other.error.load();
+        start_time = other.start_time;
+        end_time = other.end_time;
+        duration_secs = other.duration_secs;
+        avg_speed = other.avg_speed;
+        concurrent_used = other.concurrent_used;
+        timeout_used = other.timeout_used;
+    }
+    return *this;
+}
+
 // CheckStats JSON序列化
 nlohmann::json CheckStats::to_json() const {
     nlohmann::json j;
@@ -92,16 +159,12 @@ nlohmann::json CheckProgress::to_json() const {
     j["concurrent_used"] = concurrent_used;
     j["timeout_used"] = timeout_used;
 
+    // processed_keys 与 completed_results 中的key相同，不再重复写入
     j["completed_results"] = nlohmann::json::array();
     for (const auto& result : completed_results) {
         j["completed_results"].push_back(result.to_json());
     }
 
-    j["processed_keys"] = nlohmann::json::array();
-    for (const auto& key : processed_keys) {
-        j["processed_keys"].push_back(key);
-    }
-
     j["stats"] = stats.to_json();
 
     auto time_t = std::chrono::system_clock::to_time_t(last_save_time);
@@ -144,11 +207,43 @@ CheckProgress CheckProgress::from_json(const nlohmann::json& j) {
             result.response_time = std::chrono::milliseconds(result_json["response_time_ms"]);
         }
 
-        progress.completed_results.push_back(result);
+        if (result_json.contains("provider")) {
+            result.provider = result_json["provider"];
+        }
+
+        if (result_json.contains("source")) {
+            result.source = result_json["source"];
+        }
+
+        if (result_json.contains("http_status")) {
+            result.http_status = result_json["http_status"];
+        }
+
+        progress.completed_results.push_back(std::move(result));
     }
 
-    for (const auto& key : j["processed_keys"]) {
-        progress.processed_keys.insert(key);
+    // 旧版文件只按key记录完成状态，这里一次性换算成序号位图
+    std::unordered_map<std::string_view, std::vector<uint32_t>> ordinals;
+    ordinals.reserve(progress.all_keys.size());
+    for (size_t i = 0; i < progress.all_keys.size(); ++i) {
+        ordinals[progress.all_keys[i]].push_back(static_cast<uint32_t>(i));
+    }
+    progress.completed.resize(progress.all_keys.size());
+    auto mark_done = [&](const std::string& key) {
+        auto it = ordinals.find(key);
+        if (it != ordinals.end()) {
+            for (uint32_t ordinal : it->second) {
+                progress.completed.set(ordinal);
+            }
+        }
+    };
+    for (const auto& result : progress.completed_results) {
+        mark_done(result.key);
+    }
+    if (j.contains("processed_keys")) {
+        for (const auto& key : j["processed_keys"]) {
+            mark_done(key.get<std::string>());
+        }
     }
 
     // 解析统计信息
@@ -183,17 +278,22 @@ CheckProgress CheckProgress::from_json(const nlohmann::json& j) {
 // 获取未处理的keys
 std::vector<std::string> CheckProgress::get_pending_keys() const {
     std::vector<std::string> pending;
-    for (const auto& key : all_keys) {
-        if (processed_keys.find(key) == processed_keys.end()) {
-            pending.push_back(key);
+    for (uint32_t ordinal : completed.unset_positions()) {
+        if (ordinal < all_keys.size()) {
+            pending.push_back(all_keys[ordinal]);
         }
     }
     return pending;
 }
 
-// 检查是否已处理某个key
+// 检查是否已处理某个key（需要遍历key列表，批量判断请直接使用completed位图）
 bool CheckProgress::is_key_processed(const std::string& key) const {
-    return processed_keys.find(key) != processed_keys.end();
+    for (size_t i = 0; i < all_keys.size(); ++i) {
+        if (all_keys[i] == key && completed.test(i)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // APIKeyChecker实现
@@ -203,65 +303,80 @@ public:
         : timeout_secs_(timeout_secs), connect_timeout_(connect_timeout) {
 
         // 初始化HTTP客户端
-        http_client_.set_timeout(std::chrono::seconds(timeout_secs));
-        http_client_.set_connect_timeout(std::chrono::seconds(connect_timeout));
-        http_client_.set_user_agent("api-key-checker/1.0");
+        configure_client(http_client_);
+    }
+
+    // 按检测器的超时设置初始化HTTP客户端
+    // curl句柄不能跨线程共享，流水线的每个工作线程各自持有一个客户端
+    void configure_client(HttpClient& client) const {
+        client.set_timeout(std::chrono::seconds(timeout_secs_));
+        client.set_connect_timeout(std::chrono::seconds(connect_timeout_));
+        client.set_user_agent("api-key-checker/1.0");
     }
 
     KeyResult check_single_key(const std::string& api_key) {
+        return check_single_key(http_client_, api_key);
+    }
+
+    KeyResult check_single_key(HttpClient& client, const std::string& api_key) {
         auto start_time = std::chrono::steady_clock::now();
         auto checked_at = std::chrono::system_clock::now();
 
-        std::string trimmed_key = api_key;
+        KeyResult result;
+        result.key = api_key;
+        result.checked_at = checked_at;
+
+        auto finish = [&result](KeyStatus status, MessageCode code, uint16_t http_status = 0,
+                                const std::string& detail = "") {
+            result.status = status;
+            result.message_code = code;
+            result.http_status = http_status;
+            result.message = KeyResult::describe(code, http_status, detail);
+            return result;
+        };
+
         // 去除首尾空白字符
+        std::string& trimmed_key = result.key;
         trimmed_key.erase(0, trimmed_key.find_first_not_of(" \t\r\n"));
         trimmed_key.erase(trimmed_key.find_last_not_of(" \t\r\n") + 1);
 
         if (trimmed_key.empty()) {
-            return {trimmed_key, KeyStatus::Error, "空 key", checked_at, std::nullopt};
+            return finish(KeyStatus::Error, MessageCode::EmptyKey);
         }
 
-        if (trimmed_key.length() < 3 || trimmed_key.substr(0, 3) != "sk-") {
-            return {trimmed_key, KeyStatus::Error, "无效格式 (必须以 sk- 开头)",
-                   checked_at, std::nullopt};
+        // 按key格式识别服务商，路由到对应的检测端点
+        const KeyPattern* pattern = KeyPatternRegistry::defaults().classify(trimmed_key);
+        if (!pattern) {
+            return finish(KeyStatus::Error, MessageCode::UnknownFormat);
         }
+        result.provider = pattern->provider;
 
         // 发送HTTP请求
-        std::vector<std::string> headers = {
-            "Authorization: Bearer " + trimmed_key,
-            "Content-Type: application/json"
-        };
-
-        auto response = http_client_.get("https://api.openai.com/v1/models", headers);
+        auto headers = KeyPatternRegistry::build_headers(*pattern, trimmed_key);
+        auto response = client.get(pattern->test_url, headers);
         auto end_time = std::chrono::steady_clock::now();
-        auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        result.response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
             end_time - start_time);
 
         if (!response.success) {
-            return {trimmed_key, KeyStatus::Error, "请求错误: " + response.error_message,
-                   checked_at, response_time};
+            return finish(KeyStatus::Error, MessageCode::RequestError, 0, response.error_message);
         }
 
+        auto http_status = static_cast<uint16_t>(response.status_code);
         switch (response.status_code) {
             case 200:
-                return {trimmed_key, KeyStatus::Valid, "有效", checked_at, response_time};
+                return finish(KeyStatus::Valid, MessageCode::Valid, http_status);
             case 401:
-                return {trimmed_key, KeyStatus::Invalid, "认证失败", checked_at, response_time};
+                return finish(KeyStatus::Invalid, MessageCode::AuthFailed, http_status);
             case 403:
-                return {trimmed_key, KeyStatus::Invalid, "访问被拒绝", checked_at, response_time};
+                return finish(KeyStatus::Invalid, MessageCode::Forbidden, http_status);
             case 429:
-                return {trimmed_key, KeyStatus::Error, "请求过多，稍后重试",
-                       checked_at, response_time};
+                return finish(KeyStatus::Error, MessageCode::RateLimited, http_status);
             default:
                 if (response.status_code >= 500) {
-                    return {trimmed_key, KeyStatus::Error,
-                           "服务器错误 " + std::to_string(response.status_code),
-                           checked_at, response_time};
-                } else {
-                    return {trimmed_key, KeyStatus::Invalid,
-                           "HTTP " + std::to_string(response.status_code),
-                           checked_at, response_time};
+                    return finish(KeyStatus::Error, MessageCode::ServerError, http_status);
                 }
+                return finish(KeyStatus::Invalid, MessageCode::HttpError, http_status);
         }
     }
 
@@ -283,8 +398,6 @@ APIKeyChecker::APIKeyChecker(size_t timeout_secs, size_t connect_timeout, size_t
     std::stringstream ss;
     ss << "session_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
     current_session_id_ = ss.str();
-
-    last_save_time_ = std::chrono::steady_clock::now();
 }
 
 APIKeyChecker::~APIKeyChecker() = default;
@@ -308,7 +421,7 @@ CheckResults APIKeyChecker::check_keys(const std::vector<std::string>& api_keys,
         std::cout << "🚀 开始检测 " << api_keys.size() << " 个 API keys..." << std::endl;
         std::cout << "⚡ 并发数: " << concurrent << std::endl;
         std::cout << "⏱️  请求超时: " << stats_.timeout_used << " 秒" << std::endl;
-        std::cout << "🌐 目标 API: https://api.openai.com/v1/models" << std::endl;
+        std::cout << "🌐 目标 API: 按key格式路由 (" << KeyPatternRegistry::defaults().patterns().size() << " 种格式)" << std::endl;
         std::cout << std::string(60, '=') << std::endl;
     }
 
@@ -359,6 +472,8 @@ CheckResults APIKeyChecker::check_keys(const std::vector<std::string>& api_keys,
                         stats_.error.fetch_add(1);
                         results.error_keys.push_back(result);
                         break;
+                    default:
+                        break;
                 }
             }
 
@@ -394,183 +509,451 @@ CheckResults APIKeyChecker::check_keys(const std::vector<std::string>& api_keys,
     return results;
 }
 
+CheckResults APIKeyChecker::check_keys_pipelined(const KeyProducer& producer,
+                                                size_t concurrent,
+                                                size_t channel_capacity,
+                                                bool quiet,
+                                                const ResultCallback& on_result) {
+    stats_.total = 0;
+    stats_.start_time = std::chrono::system_clock::now();
+    stats_.checked = 0;
+    stats_.valid = 0;
+    stats_.invalid = 0;
+    stats_.error = 0;
+
+    const size_t worker_count = std::max<size_t>(1, concurrent);
+
+    if (!quiet) {
+        std::cout << "🚀 开始流水线检测..." << std::endl;
+        std::cout << "⚡ 并发数: " << worker_count << std::endl;
+        std::cout << "📦 通道容量: " << channel_capacity << std::endl;
+        std::cout << "⏱️  请求超时: " << stats_.timeout_used << " 秒" << std::endl;
+        std::cout << std::string(60, '=') << std::endl;
+    }
+
+    CheckResults results;
+    std::mutex results_mutex;
+    BoundedChannel<KeyItem> channel(channel_capacity);
+
+    // 生产者线程：解析key写入通道，通道满时阻塞，实现背压
+    std::thread reader([&]() {
+        try {
+            producer(channel);
+        } catch (const std::exception& e) {
+            std::cerr << "读取API Keys失败: " << e.what() << std::endl;
+        }
+        channel.close();
+    });
+
+    // 工作线程：从通道拉取key并检测，第一个key解析出来即开始检测
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back([&]() {
+            HttpClient client;
+            pImpl_->configure_client(client);
+
+            while (!should_stop_.load()) {
+                auto item = channel.pop();
+                if (!item) {
+                    break;
+                }
+
+                auto result = pImpl_->check_single_key(client, item->key);
+                result.source = item->source;
+                stats_.checked.fetch_add(1);
+
+                // 有回调时结果直接交给调用方，不在内存中累积（跟随模式可能永不结束）
+                if (on_result) {
+                    record_result(result, nullptr);
+                    on_result(result, *item);
+                } else {
+                    std::lock_guard<std::mutex> lock(results_mutex);
+                    record_result(result, &results);
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 停止检测时关闭通道，让阻塞中的生产者退出
+    channel.close();
+    reader.join();
+
+    stats_.total = stats_.checked.load();
+    stats_.end_time = std::chrono::system_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        stats_.end_time - stats_.start_time);
+    stats_.duration_secs = duration.count() / 1000.0;
+    stats_.avg_speed = stats_.duration_secs > 0 ? stats_.total / stats_.duration_secs : 0.0;
+
+    if (!quiet) {
+        std::cout << "检测完成! 🟢" << stats_.valid.load()
+                  << " | 🔴" << stats_.invalid.load()
+                  << " | ⚠️" << stats_.error.load() << std::endl;
+    }
+
+    results.stats = stats_;
+    return results;
+}
+
+CheckResults APIKeyChecker::check_file_pipelined(const std::string& input_file,
+                                                size_t concurrent,
+                                                size_t channel_capacity,
+                                                bool quiet,
+                                                const ResultCallback& on_result) {
+    if (!FileUtils::file_exists(input_file)) {
+        throw std::runtime_error("无法打开输入文件: " + input_file);
+    }
+
+    return check_keys_pipelined([&input_file](BoundedChannel<KeyItem>& channel) {
+        FileUtils::for_each_api_key(input_file, [&channel](std::string key) {
+            return channel.push({std::move(key), {}});
+        });
+    }, concurrent, channel_capacity, quiet, on_result);
+}
+
+CheckResults APIKeyChecker::check_directory_pipelined(const std::string& root,
+                                                     const HarvestOptions& options,
+                                                     size_t concurrent,
+                                                     size_t channel_capacity,
+                                                     bool quiet,
+                                                     const ResultCallback& on_result) {
+    if (!std::filesystem::exists(root)) {
+        throw std::runtime_error("输入路径不存在: " + root);
+    }
+
+    // 扫描线程直接写入通道，通道满时扫描随之暂停
+    return check_keys_pipelined([&](BoundedChannel<KeyItem>& channel) {
+        auto harvest_stats = KeyHarvester::harvest(root, options, [&channel](const HarvestedKey& key) {
+            return channel.push({key.key, key.source()});
+        });
+
+        if (!quiet) {
+            std::cout << "📂 扫描了 " << harvest_stats.files_scanned << " 个文件 ("
+                      << harvest_stats.bytes_scanned / (1024 * 1024) << " MB)，跳过 "
+                      << harvest_stats.files_skipped << " 个，发现 "
+                      << harvest_stats.keys_found << " 个key" << std::endl;
+        }
+    }, concurrent, channel_capacity, quiet, on_result);
+}
+
+CheckResults APIKeyChecker::check_file_following(const std::string& path,
+                                                const TailOptions& options,
+                                                size_t concurrent,
+                                                size_t channel_capacity,
+                                                bool quiet,
+                                                const ResultCallback& on_result) {
+    if (!std::filesystem::exists(path)) {
+        throw std::runtime_error("跟随路径不存在: " + path);
+    }
+
+    TailFollower follower(path, options);
+
+    return check_keys_pipelined([&](BoundedChannel<KeyItem>& channel) {
+        if (!quiet) {
+            std::cout << "👀 跟随 " << path << " (" << TailFollower::watch_backend()
+                      << ")，等待新增的key..." << std::endl;
+        }
+
+        follower.run([&channel](TailKey key) {
+            return channel.push({std::move(key.key), std::move(key.source), key.ticket});
+        }, [this]() {
+            return should_stop_.load();
+        });
+    }, concurrent, channel_capacity, quiet, [&](const KeyResult& result, const KeyItem& item) {
+        if (on_result) {
+            on_result(result, item);
+        }
+        // 检测完成（且结果已交给调用方）后才确认，未完成的key在重启后会重新检测
+        follower.acknowledge(item.ticket);
+    });
+}
+
+void APIKeyChecker::record_result(const KeyResult& result, CheckResults* results) {
+    std::vector<KeyResult>* bucket = nullptr;
+    switch (result.status) {
+        case KeyStatus::Valid:
+            stats_.valid.fetch_add(1);
+            bucket = results ? &results->valid_keys : nullptr;
+            break;
+        case KeyStatus::Invalid:
+            stats_.invalid.fetch_add(1);
+            bucket = results ? &results->invalid_keys : nullptr;
+            break;
+        case KeyStatus::Error:
+            stats_.error.fetch_add(1);
+            bucket = results ? &results->error_keys : nullptr;
+            break;
+        default:
+            break;
+    }
+
+    if (bucket) {
+        bucket->push_back(result);
+    }
+}
+
 void APIKeyChecker::stop() {
     should_stop_.store(true);
 }
 
-} // namespace api_checker
+void APIKeyChecker::set_save_interval(std::chrono::seconds interval) {
+    save_interval_ = std::max(interval, std::chrono::seconds(1));
+}
+
+// 序号到记录下标的映射中表示"尚无记录"
+constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+// 输入文件路径转为绝对路径，从其他工作目录恢复时仍能找到并校验输入文件
+static std::string normalized_input_path(const std::string& input_file) {
+    if (input_file.empty()) {
+        return input_file;
+    }
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(input_file, ec);
+    return ec ? input_file : absolute.lexically_normal().string();
+}
+
+// 进度日志头：输入文件解析出的key列表与本次检测的完全一致时，只记录路径和指纹，
+// 恢复时重新读取并校验；否则（手动输入、文件已变化等）把key列表写入日志头
+static JournalHeader make_journal_header(const std::vector<std::string>& keys,
+                                         const std::string& input_file) {
+    JournalHeader header;
+    header.input_file = normalized_input_path(input_file);
+    header.key_count = keys.size();
+    header.fingerprint = ProgressJournal::fingerprint(keys);
+
+    uint64_t file_key_count = 0;
+    auto file_fingerprint = input_file.empty()
+        ? std::nullopt : ProgressJournal::fingerprint_file(header.input_file, file_key_count);
+    header.keys_external = file_fingerprint && *file_fingerprint == header.fingerprint &&
+                           file_key_count == keys.size();
+    if (!header.keys_external) {
+        header.keys = keys;
+    }
+    return header;
+}
+
 // 带进度保存的批量检测
 CheckResults APIKeyChecker::check_keys_with_progress(const std::vector<std::string>& api_keys,
                                                     const std::string& input_file,
                                                     size_t concurrent, bool quiet) {
-    // 生成进度文件名
-    current_progress_file_ = "progress_" + current_session_id_ + ".json";
+    current_progress_file_ = "progress_" + current_session_id_ + ".journal";
+
+    // 日志头只在创建时写入一次，之后每个完成的key追加一条定长记录
+    JournalHeader header = make_journal_header(api_keys, input_file);
+    header.session_id = current_session_id_;
+    header.concurrent = concurrent;
+    header.timeout = stats_.timeout_used;
+    header.created_at = std::chrono::system_clock::now();
+
+    JournalOptions options;
+    options.group_commit_interval = save_interval_;
+    ProgressJournal journal;
+    if (!journal.create(current_progress_file_, header, options)) {
+        throw std::runtime_error("无法创建进度文件: " + current_progress_file_);
+    }
 
-    // 初始化进度
-    CheckProgress progress;
-    progress.session_id = current_session_id_;
-    progress.input_file = input_file;
-    progress.all_keys = api_keys;
-    progress.concurrent_used = concurrent;
-    progress.timeout_used = stats_.timeout_used;
-    progress.stats = stats_;
-    progress.stats.total = api_keys.size();
-    progress.stats.start_time = std::chrono::system_clock::now();
-    progress.last_save_time = std::chrono::system_clock::now();
-
-    // 保存初始进度
-    save_progress(progress, current_progress_file_);
-
-    return check_keys_internal(api_keys, concurrent, quiet, &progress);
+    stats_.total = api_keys.size();
+    stats_.start_time = header.created_at;
+    stats_.checked = 0;
+    stats_.valid = 0;
+    stats_.invalid = 0;
+    stats_.error = 0;
+
+    CompletionBitmap completed(api_keys.size());
+    return check_keys_internal(api_keys, header.fingerprint, completed, concurrent, quiet, journal);
 }
 
 // 从进度文件恢复检测
 CheckResults APIKeyChecker::resume_from_progress(const std::string& progress_file, bool quiet) {
-    auto progress_opt = load_progress(progress_file);
-    if (!progress_opt) {
-        throw std::runtime_error("无法加载进度文件: " + progress_file);
+    std::string journal_file = progress_file;
+
+    // 旧版JSON进度文件先转换为日志，之后按日志继续
+    if (!ProgressJournal::is_journal(progress_file)) {
+        auto legacy = load_progress(progress_file);
+        if (!legacy) {
+            throw std::runtime_error("无法加载进度文件: " + progress_file);
+        }
+        journal_file = "progress_" + legacy->session_id + ".journal";
+        if (!save_progress(*legacy, journal_file)) {
+            throw std::runtime_error("无法转换进度文件: " + progress_file);
+        }
     }
 
-    CheckProgress progress = *progress_opt;
-    current_progress_file_ = progress_file;
-    current_session_id_ = progress.session_id;
+    // 去掉崩溃留下的残缺记录和重复记录后再回放（重写日志时会删除过期的位图侧文件）
+    ProgressJournal::compact(journal_file);
 
-    // 获取未处理的keys
-    auto pending_keys = progress.get_pending_keys();
+    // 位图侧文件有效时只需回放其后追加的记录
+    auto header_only = ProgressJournal::read_header(journal_file);
+    auto sidecar = CompletionSidecar::load(ProgressJournal::sidecar_path(journal_file));
+    if (sidecar && !(header_only && sidecar->fingerprint == header_only->fingerprint &&
+                     sidecar->bitmap.size() == header_only->key_count)) {
+        sidecar.reset();
+    }
+
+    auto state = ProgressJournal::replay(journal_file, true, sidecar ? sidecar->journal_bytes : 0);
+    if (!state) {
+        throw std::runtime_error("无法加载进度文件: " + journal_file);
+    }
+    if (sidecar && state->replayed_from != sidecar->journal_bytes) {
+        sidecar.reset();
+        state = ProgressJournal::replay(journal_file);
+        if (!state) {
+            throw std::runtime_error("无法加载进度文件: " + journal_file);
+        }
+    }
+
+    const JournalHeader& header = state->header;
+    current_progress_file_ = journal_file;
+    current_session_id_ = header.session_id;
+
+    // 恢复统计信息和完成位图
+    CompletionBitmap completed(header.keys.size());
+    stats_.total = header.keys.size();
+    stats_.start_time = header.created_at;
+    stats_.valid = 0;
+    stats_.invalid = 0;
+    stats_.error = 0;
+    if (sidecar) {
+        completed = std::move(sidecar->bitmap);
+        stats_.valid = sidecar->valid;
+        stats_.invalid = sidecar->invalid;
+        stats_.error = sidecar->error;
+    }
+
+    for (const auto& record : state->records) {
+        if (!completed.set(record.ordinal)) {
+            continue;
+        }
+        switch (record.status) {
+            case KeyStatus::Valid:
+                stats_.valid.fetch_add(1);
+                break;
+            case KeyStatus::Invalid:
+                stats_.invalid.fetch_add(1);
+                break;
+            case KeyStatus::Error:
+                stats_.error.fetch_add(1);
+                break;
+            default:
+                break;
+        }
+    }
+    stats_.checked = completed.count();
+    size_t pending_count = completed.size() - stats_.checked.load();
 
     if (!quiet) {
         std::cout << "🔄 恢复检测进度..." << std::endl;
-        std::cout << "📁 原始文件: " << progress.input_file << std::endl;
-        std::cout << "📊 总计: " << progress.all_keys.size() << " 个" << std::endl;
-        std::cout << "✅ 已完成: " << progress.completed_results.size() << " 个" << std::endl;
-        std::cout << "⏳ 待处理: " << pending_keys.size() << " 个" << std::endl;
-        std::cout << "🕐 上次保存: " << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(progress.last_save_time)), "%Y-%m-%d %H:%M:%S") << std::endl;
+        std::cout << "📁 原始文件: " << header.input_file << std::endl;
+        std::cout << "📊 总计: " << header.keys.size() << " 个" << std::endl;
+        std::cout << "✅ 已完成: " << stats_.checked.load() << " 个" << std::endl;
+        std::cout << "⏳ 待处理: " << pending_count << " 个" << std::endl;
+        std::error_code ec;
+        auto modified = std::filesystem::last_write_time(journal_file, ec);
+        if (!ec) {
+            auto last_save = std::chrono::system_clock::to_time_t(
+                std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                    std::chrono::file_clock::to_sys(modified)));
+            std::cout << "🕐 上次保存: " << std::put_time(std::localtime(&last_save), "%Y-%m-%d %H:%M:%S") << std::endl;
+        }
         std::cout << std::string(60, '=') << std::endl;
     }
 
-    if (pending_keys.empty()) {
+    if (pending_count == 0) {
         if (!quiet) {
             std::cout << "✅ 所有API Keys已检测完成！" << std::endl;
         }
 
-        // 构建最终结果
-        CheckResults results;
-        results.stats = progress.stats;
-
-        for (const auto& result : progress.completed_results) {
-            switch (result.status) {
-                case KeyStatus::Valid:
-                    results.valid_keys.push_back(result);
-                    break;
-                case KeyStatus::Invalid:
-                    results.invalid_keys.push_back(result);
-                    break;
-                case KeyStatus::Error:
-                    results.error_keys.push_back(result);
-                    break;
-                default:
-                    break;
-            }
+        // 需要全部记录来构建结果，只回放了部分记录时重新读取一遍
+        std::vector<JournalRecord> records;
+        if (state->replayed_from == state->records_offset) {
+            records = std::move(state->records);
+        } else if (auto full = ProgressJournal::replay(journal_file, false)) {
+            records = std::move(full->records);
         }
 
+        // 构建最终结果，record_result 会重新计数
+        CheckResults results;
+        stats_.valid = 0;
+        stats_.invalid = 0;
+        stats_.error = 0;
+        for (const auto& record : records) {
+            record_result(record.to_result(header.keys[record.ordinal]), &results);
+        }
+        results.stats = stats_;
         return results;
     }
 
-    // 恢复统计信息
-    stats_ = progress.stats;
+    JournalOptions options;
+    options.group_commit_interval = save_interval_;
+    ProgressJournal journal;
+    if (!journal.open(journal_file, options)) {
+        throw std::runtime_error("无法打开进度文件: " + journal_file);
+    }
 
-    return check_keys_internal(pending_keys, progress.concurrent_used, quiet, &progress);
+    return check_keys_internal(header.keys, header.fingerprint, completed, header.concurrent,
+                               quiet, journal);
 }
 
-// 内部检测方法（支持进度保存）
-CheckResults APIKeyChecker::check_keys_internal(const std::vector<std::string>& api_keys,
+// 内部检测方法：检测all_keys中尚未完成的key，每个结果追加到进度日志
+CheckResults APIKeyChecker::check_keys_internal(const std::vector<std::string>& all_keys,
+                                               uint64_t fingerprint,
+                                               CompletionBitmap& completed,
                                                size_t concurrent, bool quiet,
-                                               CheckProgress* progress) {
-    if (api_keys.empty()) {
-        CheckResults empty_results;
-        empty_results.stats = stats_;
-        return empty_results;
-    }
-
-    if (!progress) {
-        // 如果没有进度对象，使用原始方法
-        return check_keys(api_keys, concurrent, quiet);
-    }
+                                               ProgressJournal& journal) {
+    const std::vector<uint32_t> pending = completed.unset_positions();
 
     if (!quiet) {
-        std::cout << "🚀 开始检测 " << api_keys.size() << " 个 API keys..." << std::endl;
+        std::cout << "🚀 开始检测 " << pending.size() << " 个 API keys..." << std::endl;
         std::cout << "⚡ 并发数: " << concurrent << std::endl;
         std::cout << "⏱️  请求超时: " << stats_.timeout_used << " 秒" << std::endl;
-        std::cout << "🌐 目标 API: https://api.openai.com/v1/models" << std::endl;
+        std::cout << "🌐 目标 API: 按key格式路由 (" << KeyPatternRegistry::defaults().patterns().size() << " 种格式)" << std::endl;
         std::cout << "💾 进度文件: " << current_progress_file_ << std::endl;
         std::cout << std::string(60, '=') << std::endl;
     }
 
     // 创建进度条
-    ProgressBar progress_bar(progress->all_keys.size(), !quiet);
-    progress_bar.update(progress->completed_results.size());
+    ProgressBar progress_bar(all_keys.size(), !quiet);
+    progress_bar.update(stats_.checked.load());
 
     CheckResults results;
-    results.stats = stats_;
 
     // 使用线程池进行并发检测
-    std::vector<std::future<KeyResult>> futures;
+    std::vector<std::future<void>> futures;
     std::mutex results_mutex;
 
     // 创建线程池控制并发数量
     std::atomic<size_t> active_threads{0};
-    const size_t max_concurrent = concurrent;
+    const size_t max_concurrent = std::max<size_t>(1, concurrent);
 
-    for (const auto& key : api_keys) {
+    for (uint32_t ordinal : pending) {
         if (should_stop_.load()) {
             break;
         }
 
-        futures.emplace_back(std::async(std::launch::async, [&, key]() {
+        futures.emplace_back(std::async(std::launch::async, [&, ordinal]() {
             // 等待可用线程槽位
             while (active_threads.load() >= max_concurrent) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
 
             active_threads.fetch_add(1);
-            auto result = pImpl_->check_single_key(key);
+            auto result = pImpl_->check_single_key(all_keys[ordinal]);
             active_threads.fetch_sub(1);
 
-            // 更新统计
+            // 追加到进度日志，日志内部成组提交，不会每条都落盘
+            journal.append(JournalRecord::from_result(ordinal, result));
             stats_.checked.fetch_add(1);
 
             {
                 std::lock_guard<std::mutex> lock(results_mutex);
-
-                // 添加到进度中
-                progress->completed_results.push_back(result);
-                progress->processed_keys.insert(key);
-
-                switch (result.status) {
-                    case KeyStatus::Valid:
-                        stats_.valid.fetch_add(1);
-                        results.valid_keys.push_back(result);
-                        break;
-                    case KeyStatus::Invalid:
-                        stats_.invalid.fetch_add(1);
-                        results.invalid_keys.push_back(result);
-                        break;
-                    case KeyStatus::Error:
-                        stats_.error.fetch_add(1);
-                        results.error_keys.push_back(result);
-                        break;
-                    default:
-                        break;
-                }
-
-                // 定期保存进度
-                auto now = std::chrono::steady_clock::now();
-                if (now - last_save_time_ >= SAVE_INTERVAL) {
-                    progress->stats = stats_;
-                    progress->last_save_time = std::chrono::system_clock::now();
-                    save_progress(*progress, current_progress_file_);
-                    last_save_time_ = now;
-                }
+                completed.set(ordinal);
+                record_result(result, &results);
             }
 
             // 更新进度条
@@ -579,10 +962,8 @@ CheckResults APIKeyChecker::check_keys_internal(const std::vector<std::string>&
                                     " | 🔴" + std::to_string(stats_.invalid.load()) +
                                     " | ⚠️" + std::to_string(stats_.error.load());
                 progress_bar.set_message(message);
-                progress_bar.update(progress->completed_results.size());
+                progress_bar.update(stats_.checked.load());
             }
-
-            return result;
         }));
     }
 
@@ -599,31 +980,113 @@ CheckResults APIKeyChecker::check_keys_internal(const std::vector<std::string>&
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         stats_.end_time - stats_.start_time);
     stats_.duration_secs = duration.count() / 1000.0;
-    stats_.avg_speed = stats_.total / stats_.duration_secs;
-
-    // 最终保存进度
-    progress->stats = stats_;
-    progress->last_save_time = std::chrono::system_clock::now();
-    save_progress(*progress, current_progress_file_);
+    stats_.avg_speed = stats_.duration_secs > 0 ? stats_.checked.load() / stats_.duration_secs : 0.0;
+
+    // 提交剩余记录，并压缩为快照
+    journal.close();
+    ProgressJournal::compact(current_progress_file_);
+
+    // 保存完成位图，下次恢复时不必回放已汇总的记录
+    CompletionSidecar sidecar;
+    sidecar.fingerprint = fingerprint;
+    sidecar.valid = stats_.valid.load();
+    sidecar.invalid = stats_.invalid.load();
+    sidecar.error = stats_.error.load();
+    std::error_code ec;
+    sidecar.journal_bytes = std::filesystem::file_size(current_progress_file_, ec);
+    sidecar.bitmap = std::move(completed);
+    if (!ec) {
+        sidecar.save(ProgressJournal::sidecar_path(current_progress_file_));
+    }
 
     results.stats = stats_;
     return results;
 }
 
-// 保存当前进度
+// 保存完整进度：把CheckProgress写成一份进度日志快照
 bool APIKeyChecker::save_progress(const CheckProgress& progress, const std::string& progress_file) {
-    try {
-        std::string filename = progress_file.empty() ? current_progress_file_ : progress_file;
-        auto json_content = progress.to_json().dump(2);
-        return FileUtils::write_file(filename, json_content);
-    } catch (const std::exception& e) {
-        std::cerr << "保存进度失败: " << e.what() << std::endl;
-        return false;
+    std::string filename = progress_file.empty() ? current_progress_file_ : progress_file;
+
+    JournalHeader header = make_journal_header(progress.all_keys, progress.input_file);
+    header.session_id = progress.session_id;
+    header.concurrent = progress.concurrent_used;
+    header.timeout = progress.timeout_used;
+    header.created_at = progress.stats.start_time;
+
+    std::unordered_map<std::string_view, uint32_t> ordinals;
+    ordinals.reserve(progress.all_keys.size());
+    for (size_t i = 0; i < progress.all_keys.size(); ++i) {
+        ordinals.emplace(progress.all_keys[i], static_cast<uint32_t>(i));
+    }
+
+    // 同一key出现多次时保留最后一条
+    std::vector<JournalRecord> records;
+    std::vector<uint32_t> slots(progress.all_keys.size(), NO_SLOT);
+    for (const auto& result : progress.completed_results) {
+        auto it = ordinals.find(result.key);
+        if (it == ordinals.end()) {
+            continue;
+        }
+        uint32_t& slot = slots[it->second];
+        if (slot == NO_SLOT) {
+            slot = static_cast<uint32_t>(records.size());
+            records.push_back(JournalRecord::from_result(it->second, result));
+        } else {
+            records[slot] = JournalRecord::from_result(it->second, result);
+        }
     }
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.ordinal < b.ordinal;
+    });
+
+    // 快照先写入临时文件并同步后再替换，覆盖已有进度时崩溃也不会留下半份文件
+    return ProgressJournal::write_snapshot(filename, header, records);
 }
 
-// 加载进度文件
+// 加载进度文件，支持进度日志和旧版JSON格式
 std::optional<CheckProgress> APIKeyChecker::load_progress(const std::string& progress_file) {
+    if (ProgressJournal::is_journal(progress_file)) {
+        auto state = ProgressJournal::replay(progress_file);
+        if (!state) {
+            return std::nullopt;
+        }
+
+        CheckProgress progress;
+        progress.session_id = state->header.session_id;
+        progress.input_file = state->header.input_file;
+        progress.concurrent_used = state->header.concurrent;
+        progress.timeout_used = state->header.timeout;
+        progress.last_save_time = state->last_checked_at;
+        progress.all_keys = std::move(state->header.keys);
+        progress.completed.resize(progress.all_keys.size());
+
+        progress.stats.total = progress.all_keys.size();
+        progress.stats.start_time = state->header.created_at;
+        progress.stats.concurrent_used = progress.concurrent_used;
+        progress.stats.timeout_used = progress.timeout_used;
+        progress.completed_results.reserve(state->records.size());
+        for (const auto& record : state->records) {
+            const auto& key = progress.all_keys[record.ordinal];
+            progress.completed_results.push_back(record.to_result(key));
+            progress.completed.set(record.ordinal);
+            switch (record.status) {
+                case KeyStatus::Valid:
+                    progress.stats.valid.fetch_add(1);
+                    break;
+                case KeyStatus::Invalid:
+                    progress.stats.invalid.fetch_add(1);
+                    break;
+                case KeyStatus::Error:
+                    progress.stats.error.fetch_add(1);
+                    break;
+                default:
+                    break;
+            }
+        }
+        progress.stats.checked = progress.completed_results.size();
+        return progress;
+    }
+
     try {
         auto content = FileUtils::read_file(progress_file);
         if (!content) {
@@ -638,38 +1101,209 @@ std::optional<CheckProgress> APIKeyChecker::load_progress(const std::string& pro
     }
 }
 
-// 查找最新的进度文件
+// 查找最新的进度文件（通过进度索引，未变化的文件不会重新读取）
 std::optional<std::string> APIKeyChecker::find_latest_progress_file(const std::string& input_file) {
-    try {
-        std::vector<std::pair<std::string, std::chrono::system_clock::time_point>> progress_files;
-
-        // 查找所有进度文件
-        for (const auto& entry : std::filesystem::directory_iterator(".")) {
-            if (entry.is_regular_file()) {
-                auto filename = entry.path().filename().string();
-                if (filename.length() > 9 && filename.substr(0, 9) == "progress_" &&
-                    filename.length() > 5 && filename.substr(filename.length() - 5) == ".json") {
-                    // 尝试加载并检查是否匹配输入文件
-                    auto progress_opt = load_progress(filename);
-                    if (progress_opt && progress_opt->input_file == input_file) {
-                        progress_files.emplace_back(filename, progress_opt->last_save_time);
-                    }
+    // 旧的进度文件可能记录的是相对路径，两边都转为绝对路径再比较
+    const std::string input_path = normalized_input_path(input_file);
+    std::optional<ProgressSession> latest;
+    for (auto& session : ProgressIndex::refresh(".")) {
+        if (normalized_input_path(session.input_file) == input_path &&
+            (!latest || session.last_save > latest->last_save)) {
+            latest = std::move(session);
+        }
+    }
+
+    if (!latest) {
+        return std::nullopt;
+    }
+    return latest->file;
+}
+
+// 合并同一输入的多个进度文件：逐个序号取检测时间最新的结果，写成一份压缩后的进度日志
+std::optional<std::string> APIKeyChecker::merge_progress_files(const std::vector<std::string>& progress_files,
+                                                               const std::string& output_file) {
+    std::optional<JournalHeader> merged_header;
+    std::string keys_source;  // 日志头未内嵌key列表时，从这个进度日志读取
+    std::vector<JournalRecord> records;
+    std::vector<uint32_t> slots;
+    std::vector<std::string> merged_files;
+
+    for (const auto& file : progress_files) {
+        // 进度日志只回放记录；旧版JSON转换为日志头和记录
+        JournalHeader header;
+        std::vector<JournalRecord> file_records;
+        if (ProgressJournal::is_journal(file)) {
+            auto state = ProgressJournal::replay(file, false);
+            if (!state) {
+                std::cerr << "无法加载进度文件，已跳过: " << file << std::endl;
+                continue;
+            }
+            header = std::move(state->header);
+            file_records = std::move(state->records);
+        } else {
+            auto legacy = load_progress(file);
+            if (!legacy) {
+                std::cerr << "无法加载进度文件，已跳过: " << file << std::endl;
+                continue;
+            }
+            header = make_journal_header(legacy->all_keys, legacy->input_file);
+            header.session_id = legacy->session_id;
+            header.concurrent = legacy->concurrent_used;
+            header.timeout = legacy->timeout_used;
+            header.created_at = legacy->stats.start_time;
+
+            std::unordered_map<std::string_view, uint32_t> ordinals;
+            ordinals.reserve(legacy->all_keys.size());
+            for (size_t i = 0; i < legacy->all_keys.size(); ++i) {
+                ordinals.emplace(legacy->all_keys[i], static_cast<uint32_t>(i));
+            }
+            for (const auto& result : legacy->completed_results) {
+                auto it = ordinals.find(result.key);
+                if (it != ordinals.end()) {
+                    file_records.push_back(JournalRecord::from_result(it->second, result));
                 }
             }
         }
 
-        if (progress_files.empty()) {
+        // 只有key列表完全一致（指纹和数量相同）时序号才能对应
+        if (!merged_header) {
+            merged_header = header;
+            slots.assign(header.key_count, NO_SLOT);
+        } else if (header.fingerprint != merged_header->fingerprint ||
+                   header.key_count != merged_header->key_count) {
+            std::cerr << "进度文件的输入与其他文件不同，已跳过: " << file << std::endl;
+            continue;
+        } else if (header.request != merged_header->request) {
+            // 不同请求设置下的结果不能混在一起
+            std::cerr << "进度文件的检测请求与其他文件不同，已跳过: " << file << std::endl;
+            continue;
+        } else {
+            merged_header->created_at = std::min(merged_header->created_at, header.created_at);
+            merged_header->concurrent = header.concurrent;
+            merged_header->timeout = header.timeout;
+            // 优先保留只记录输入文件路径的日志头
+            if (header.keys_external && !merged_header->keys_external) {
+                merged_header->keys_external = true;
+                merged_header->input_file = header.input_file;
+                merged_header->keys.clear();
+            }
+        }
+        if (keys_source.empty() && !header.keys_external && ProgressJournal::is_journal(file)) {
+            keys_source = file;
+        }
+        if (merged_header->keys.empty() && !header.keys.empty()) {
+            merged_header->keys = std::move(header.keys);
+        }
+
+        for (const auto& record : file_records) {
+            if (record.ordinal >= slots.size()) {
+                continue;
+            }
+            uint32_t& slot = slots[record.ordinal];
+            if (slot == NO_SLOT) {
+                slot = static_cast<uint32_t>(records.size());
+                records.push_back(record);
+                continue;
+            }
+            // 同一key在多个文件中都有结果时以检测时间最新的为准，时间相同时取后面的文件
+            if (record.checked_at_ms >= records[slot].checked_at_ms) {
+                records[slot] = record;
+            }
+        }
+        merged_files.push_back(file);
+    }
+
+    if (!merged_header) {
+        std::cerr << "没有可合并的进度文件" << std::endl;
+        return std::nullopt;
+    }
+
+    // 内嵌key列表的日志头需要写出完整的key列表
+    if (!merged_header->keys_external && merged_header->keys.empty() && merged_header->key_count > 0) {
+        auto state = keys_source.empty() ? std::nullopt : ProgressJournal::replay(keys_source);
+        if (!state || state->header.keys.size() != merged_header->key_count) {
+            std::cerr << "无法读取进度文件中的key列表" << std::endl;
             return std::nullopt;
         }
+        merged_header->keys = std::move(state->header.keys);
+    }
+    if (merged_header->keys_external) {
+        merged_header->keys.clear();
+    }
 
-        // 找到最新的进度文件
-        auto latest = std::max_element(progress_files.begin(), progress_files.end(),
-            [](const auto& a, const auto& b) {
-                return a.second < b.second;
-            });
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << "session_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S") << "_merged";
+    merged_header->session_id = ss.str();
+    std::string output = output_file.empty() ? "progress_" + merged_header->session_id + ".journal"
+                                             : output_file;
 
-        return latest->first;
-    } catch (const std::exception&) {
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.ordinal < b.ordinal;
+    });
+    if (!ProgressJournal::write_snapshot(output, *merged_header, records)) {
         return std::nullopt;
     }
-}
\ No newline at end of file
+
+    // 同时写出完成位图，恢复时无需回放记录
+    CompletionSidecar sidecar;
+    sidecar.bitmap.resize(merged_header->key_count);
+    sidecar.fingerprint = merged_header->fingerprint;
+    for (const auto& record : records) {
+        sidecar.bitmap.set(record.ordinal);
+        switch (record.status) {
+            case KeyStatus::Valid:
+                ++sidecar.valid;
+                break;
+            case KeyStatus::Invalid:
+                ++sidecar.invalid;
+                break;
+            default:
+                ++sidecar.error;
+                break;
+        }
+    }
+    std::error_code ec;
+    sidecar.journal_bytes = std::filesystem::file_size(output, ec);
+    if (!ec) {
+        sidecar.save(ProgressJournal::sidecar_path(output));
+    }
+
+    // 合并后的日志已包含全部结果，删除被合并的进度文件
+    for (const auto& file : merged_files) {
+        if (std::filesystem::equivalent(file, output, ec)) {
+            continue;
+        }
+        std::filesystem::remove(file, ec);
+        std::filesystem::remove(ProgressJournal::sidecar_path(file), ec);
+    }
+    return output;
+}
+
+// 进度文件保留策略：按上次保存时间只保留最近的max_files个
+size_t APIKeyChecker::prune_progress_files(size_t max_files, const std::string& dir) {
+    auto sessions = ProgressIndex::refresh(dir);
+    if (max_files == 0 || sessions.size() <= max_files) {
+        return 0;
+    }
+
+    std::sort(sessions.begin(), sessions.end(), [](const auto& a, const auto& b) {
+        return a.last_save > b.last_save;
+    });
+
+    size_t removed = 0;
+    for (size_t i = max_files; i < sessions.size(); ++i) {
+        std::error_code ec;
+        if (std::filesystem::remove(sessions[i].file, ec)) {
+            std::filesystem::remove(ProgressJournal::sidecar_path(sessions[i].file), ec);
+            ++removed;
+        }
+    }
+
+    // 同步索引，去掉已删除的文件
+    ProgressIndex::refresh(dir);
+    return removed;
+}
+
+} // namespace api_checker
@@ -0,0 +1,144 @@
+#include "check_session.h"
+#include <string>
+
+namespace api_checker {
+
+NdjsonSink::NdjsonSink(std::ostream& out, bool only_valid)
+    : out_(out), only_valid_(only_valid) {}
+
+void NdjsonSink::on_result(const KeyResult& result) {
+    if (only_valid_ && result.status != KeyStatus::Valid) {
+        return;
+    }
+    std::string line = result.to_json().dump();
+    line.push_back('\n');
+    out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+    out_.flush();
+}
+
+void CollectingSink::on_result(const KeyResult& result) {
+    switch (result.status) {
+        case KeyStatus::Valid:
+            results_.valid_keys.push_back(result);
+            break;
+        case KeyStatus::Invalid:
+            results_.invalid_keys.push_back(result);
+            break;
+        case KeyStatus::Error:
+            results_.error_keys.push_back(result);
+            break;
+        default:
+            break;
+    }
+}
+
+void CollectingSink::on_finish(const CheckStats& stats) {
+    results_.stats = stats;
+}
+
+ResultStoreSink::ResultStoreSink(const std::string& path) {
+    writer_.open(path);
+}
+
+void ResultStoreSink::on_result(const KeyResult& result) {
+    writer_.append(result);
+}
+
+void ResultStoreSink::on_finish(const CheckStats& stats) {
+    (void)stats;
+    writer_.flush();
+}
+
+SessionOptions SessionOptions::from_config(const AppConfig& config) {
+    SessionOptions options;
+    options.concurrent = config.default_concurrent;
+    options.timeout_secs = config.default_timeout;
+    options.connect_timeout_secs = config.default_connect_timeout;
+    options.save_interval_secs = config.save_interval_seconds;
+    return options;
+}
+
+CheckSession::CheckSession(SessionOptions options)
+    : options_(options),
+      checker_(std::make_unique<APIKeyChecker>(options.timeout_secs,
+                                               options.connect_timeout_secs,
+                                               options.concurrent)) {
+    checker_->set_save_interval(std::chrono::seconds(options.save_interval_secs));
+}
+
+CheckSession::~CheckSession() = default;
+
+void CheckSession::add_sink(ResultSink& sink) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    sinks_.push_back(&sink);
+}
+
+CheckStats CheckSession::run(const KeyProducer& producer) {
+    auto results = checker_->check_keys_pipelined(producer, options_.concurrent,
+                                                  options_.channel_capacity, options_.quiet,
+                                                  make_callback());
+    return finish(results);
+}
+
+CheckStats CheckSession::run_keys(const std::vector<std::string>& keys) {
+    return run([&keys](BoundedChannel<KeyItem>& channel) {
+        for (const auto& key : keys) {
+            if (!channel.push({key, {}})) {
+                break;
+            }
+        }
+    });
+}
+
+CheckStats CheckSession::run_file(const std::string& input_file) {
+    auto results = checker_->check_file_pipelined(input_file, options_.concurrent,
+                                                  options_.channel_capacity, options_.quiet,
+                                                  make_callback());
+    return finish(results);
+}
+
+CheckStats CheckSession::run_directory(const std::string& root, const HarvestOptions& options) {
+    auto results = checker_->check_directory_pipelined(root, options, options_.concurrent,
+                                                       options_.channel_capacity, options_.quiet,
+                                                       make_callback());
+    return finish(results);
+}
+
+CheckStats CheckSession::run_following(const std::string& path, const TailOptions& options) {
+    auto results = checker_->check_file_following(path, options, options_.concurrent,
+                                                  options_.channel_capacity, options_.quiet,
+                                                  make_callback());
+    return finish(results);
+}
+
+void CheckSession::stop() {
+    checker_->stop();
+}
+
+const CheckStats& CheckSession::stats() const {
+    return checker_->get_stats();
+}
+
+void CheckSession::dispatch(const KeyResult& result) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    for (auto* sink : sinks_) {
+        sink->on_result(result);
+    }
+}
+
+CheckStats CheckSession::finish(const CheckResults& results) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    for (auto* sink : sinks_) {
+        sink->on_finish(results.stats);
+    }
+    return results.stats;
+}
+
+ResultCallback CheckSession::make_callback() {
+    // 总是传入回调，结果只经由接收端输出，引擎内部不累积
+    return [this](const KeyResult& result, const KeyItem&) {
+        dispatch(result);
+    };
+}
+
+} // namespace api_checker
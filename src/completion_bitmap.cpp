@@ -0,0 +1,67 @@
+#include "completion_bitmap.h"
+#include <bit>
+
+namespace api_checker {
+
+CompletionBitmap::CompletionBitmap(size_t size) {
+    resize(size);
+}
+
+void CompletionBitmap::resize(size_t size) {
+    words_.resize((size + 63) / 64, 0);
+    // 缩小时清掉越界的位，保证count()和unset_positions()不受影响
+    if (size % 64 != 0 && !words_.empty()) {
+        words_.back() &= (uint64_t{1} << (size % 64)) - 1;
+    }
+    size_ = size;
+}
+
+bool CompletionBitmap::test(size_t index) const {
+    return index < size_ && (words_[index / 64] >> (index % 64)) & 1;
+}
+
+bool CompletionBitmap::set(size_t index) {
+    if (index >= size_) {
+        return false;
+    }
+    uint64_t mask = uint64_t{1} << (index % 64);
+    uint64_t& word = words_[index / 64];
+    bool newly = (word & mask) == 0;
+    word |= mask;
+    return newly;
+}
+
+size_t CompletionBitmap::count() const {
+    size_t total = 0;
+    for (uint64_t word : words_) {
+        total += static_cast<size_t>(std::popcount(word));
+    }
+    return total;
+}
+
+std::vector<uint32_t> CompletionBitmap::unset_positions() const {
+    std::vector<uint32_t> positions;
+    positions.reserve(size_ - count());
+
+    for (size_t w = 0; w < words_.size(); ++w) {
+        uint64_t pending = ~words_[w];
+        if (w + 1 == words_.size() && size_ % 64 != 0) {
+            pending &= (uint64_t{1} << (size_ % 64)) - 1;
+        }
+        // 每次取出最低的未完成位
+        while (pending != 0) {
+            positions.push_back(static_cast<uint32_t>(w * 64 + std::countr_zero(pending)));
+            pending &= pending - 1;
+        }
+    }
+    return positions;
+}
+
+CompletionBitmap CompletionBitmap::from_words(size_t size, std::vector<uint64_t> words) {
+    CompletionBitmap bitmap;
+    bitmap.words_ = std::move(words);
+    bitmap.resize(size);
+    return bitmap;
+}
+
+} // namespace api_checker
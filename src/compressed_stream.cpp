@@ -0,0 +1,484 @@
+#include "compressed_stream.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#ifdef API_CHECKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef API_CHECKER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace api_checker {
+
+namespace {
+
+constexpr size_t IO_BUFFER_SIZE = 256 * 1024;
+
+bool ends_with(const std::string& s, std::string_view suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+Compression detect_compression(std::string_view header) {
+    if (header.size() >= 2 &&
+        static_cast<unsigned char>(header[0]) == 0x1F &&
+        static_cast<unsigned char>(header[1]) == 0x8B) {
+        return Compression::Gzip;
+    }
+    if (header.size() >= 4 &&
+        static_cast<unsigned char>(header[0]) == 0x28 &&
+        static_cast<unsigned char>(header[1]) == 0xB5 &&
+        static_cast<unsigned char>(header[2]) == 0x2F &&
+        static_cast<unsigned char>(header[3]) == 0xFD) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+Compression compression_from_path(const std::string& file_path) {
+    if (ends_with(file_path, ".gz")) {
+        return Compression::Gzip;
+    }
+    if (ends_with(file_path, ".zst")) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+// DecompressingReader实现
+class DecompressingReader::Impl {
+public:
+    ~Impl() {
+        close();
+    }
+
+    bool open(const std::string& file_path) {
+        close();
+
+        file_ = std::fopen(file_path.c_str(), "rb");
+        if (!file_) {
+            error_ = "无法打开文件: " + file_path;
+            return false;
+        }
+
+        in_buf_.resize(IO_BUFFER_SIZE);
+        in_len_ = std::fread(in_buf_.data(), 1, in_buf_.size(), file_);
+        in_pos_ = 0;
+        compression_ = detect_compression(std::string_view(in_buf_.data(), in_len_));
+
+        switch (compression_) {
+            case Compression::Gzip:
+#ifdef API_CHECKER_HAVE_ZLIB
+                zstream_ = z_stream{};
+                // 15+32: 自动识别 gzip/zlib 头
+                if (inflateInit2(&zstream_, 15 + 32) != Z_OK) {
+                    return fail("初始化gzip解压失败");
+                }
+                zlib_ready_ = true;
+                zstream_.next_in = reinterpret_cast<Bytef*>(in_buf_.data());
+                zstream_.avail_in = static_cast<uInt>(in_len_);
+                in_member_ = true;
+                return true;
+#else
+                return fail("未启用gzip支持");
+#endif
+            case Compression::Zstd:
+#ifdef API_CHECKER_HAVE_ZSTD
+                dctx_ = ZSTD_createDCtx();
+                if (!dctx_) {
+                    return fail("初始化zstd解压失败");
+                }
+                frame_complete_ = false;
+                return true;
+#else
+                return fail("未启用zstd支持");
+#endif
+            default:
+                return true;
+        }
+    }
+
+    size_t read(char* buffer, size_t size) {
+        if (!file_ || failed_ || size == 0) {
+            return 0;
+        }
+
+        switch (compression_) {
+            case Compression::Gzip:
+                return read_gzip(buffer, size);
+            case Compression::Zstd:
+                return read_zstd(buffer, size);
+            default:
+                return read_raw(buffer, size);
+        }
+    }
+
+    void close() {
+#ifdef API_CHECKER_HAVE_ZLIB
+        if (zlib_ready_) {
+            inflateEnd(&zstream_);
+            zlib_ready_ = false;
+        }
+#endif
+#ifdef API_CHECKER_HAVE_ZSTD
+        if (dctx_) {
+            ZSTD_freeDCtx(dctx_);
+            dctx_ = nullptr;
+        }
+#endif
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        failed_ = false;
+        error_.clear();
+    }
+
+    bool failed() const { return failed_; }
+    const std::string& error_message() const { return error_; }
+    Compression compression() const { return compression_; }
+
+private:
+    bool fail(const std::string& message) {
+        failed_ = true;
+        error_ = message;
+        return false;
+    }
+
+    // 从文件读取下一块压缩数据，返回是否读到了数据
+    bool refill() {
+        if (!file_ || std::feof(file_)) {
+            return false;
+        }
+        in_len_ = std::fread(in_buf_.data(), 1, in_buf_.size(), file_);
+        in_pos_ = 0;
+        if (std::ferror(file_)) {
+            fail("读取文件失败");
+            return false;
+        }
+        return in_len_ > 0;
+    }
+
+    size_t read_raw(char* buffer, size_t size) {
+        size_t copied = 0;
+        if (in_pos_ < in_len_) {
+            copied = std::min(size, in_len_ - in_pos_);
+            std::copy_n(in_buf_.data() + in_pos_, copied, buffer);
+            in_pos_ += copied;
+        }
+        if (copied < size) {
+            copied += std::fread(buffer + copied, 1, size - copied, file_);
+            if (std::ferror(file_)) {
+                fail("读取文件失败");
+            }
+        }
+        return copied;
+    }
+
+    size_t read_gzip(char* buffer, size_t size) {
+#ifdef API_CHECKER_HAVE_ZLIB
+        zstream_.next_out = reinterpret_cast<Bytef*>(buffer);
+        zstream_.avail_out = static_cast<uInt>(std::min<size_t>(size, UINT32_MAX));
+        const uInt requested = zstream_.avail_out;
+
+        while (zstream_.avail_out > 0) {
+            if (zstream_.avail_in == 0 && refill()) {
+                zstream_.next_in = reinterpret_cast<Bytef*>(in_buf_.data());
+                zstream_.avail_in = static_cast<uInt>(in_len_);
+            }
+
+            if (!in_member_) {
+                // 上一个gzip成员已结束，还有输入时继续解压拼接的下一个成员
+                if (zstream_.avail_in == 0) {
+                    break;
+                }
+                inflateReset(&zstream_);
+                in_member_ = true;
+            }
+
+            int ret = inflate(&zstream_, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                in_member_ = false;
+                continue;
+            }
+            if (ret == Z_BUF_ERROR) {
+                if (zstream_.avail_in == 0) {
+                    fail("gzip数据不完整");
+                }
+                break;
+            }
+            if (ret != Z_OK) {
+                fail(std::string("gzip解压失败: ") + (zstream_.msg ? zstream_.msg : "数据损坏"));
+                break;
+            }
+        }
+
+        return requested - zstream_.avail_out;
+#else
+        (void)buffer;
+        (void)size;
+        return 0;
+#endif
+    }
+
+    size_t read_zstd(char* buffer, size_t size) {
+#ifdef API_CHECKER_HAVE_ZSTD
+        ZSTD_outBuffer out{buffer, size, 0};
+
+        while (out.pos < out.size) {
+            bool have_input = in_pos_ < in_len_ || refill();
+            ZSTD_inBuffer in{in_buf_.data(), in_len_, in_pos_};
+            size_t before = out.pos;
+
+            size_t ret = ZSTD_decompressStream(dctx_, &out, &in);
+            in_pos_ = in.pos;
+            if (ZSTD_isError(ret)) {
+                fail(std::string("zstd解压失败: ") + ZSTD_getErrorName(ret));
+                break;
+            }
+
+            // 输入耗尽且解码器没有剩余输出：最后一帧未解码完成说明数据不完整
+            if (!have_input && out.pos == before) {
+                if (!frame_complete_) {
+                    fail("zstd数据不完整");
+                }
+                break;
+            }
+            frame_complete_ = ret == 0;
+        }
+
+        return out.pos;
+#else
+        (void)buffer;
+        (void)size;
+        return 0;
+#endif
+    }
+
+    std::FILE* file_ = nullptr;
+    Compression compression_ = Compression::None;
+    std::vector<char> in_buf_;
+    size_t in_len_ = 0;
+    size_t in_pos_ = 0;
+    bool failed_ = false;
+    std::string error_;
+
+#ifdef API_CHECKER_HAVE_ZLIB
+    z_stream zstream_{};
+    bool zlib_ready_ = false;
+    bool in_member_ = false;
+#endif
+#ifdef API_CHECKER_HAVE_ZSTD
+    ZSTD_DCtx* dctx_ = nullptr;
+    bool frame_complete_ = false;
+#endif
+};
+
+DecompressingReader::DecompressingReader() : pImpl_(std::make_unique<Impl>()) {}
+
+DecompressingReader::~DecompressingReader() = default;
+
+bool DecompressingReader::open(const std::string& file_path) {
+    return pImpl_->open(file_path);
+}
+
+size_t DecompressingReader::read(char* buffer, size_t size) {
+    return pImpl_->read(buffer, size);
+}
+
+bool DecompressingReader::failed() const {
+    return pImpl_->failed();
+}
+
+const std::string& DecompressingReader::error_message() const {
+    return pImpl_->error_message();
+}
+
+Compression DecompressingReader::compression() const {
+    return pImpl_->compression();
+}
+
+// CompressingWriter实现
+class CompressingWriter::Impl {
+public:
+    ~Impl() {
+        close();
+    }
+
+    bool open(const std::string& file_path, Compression compression) {
+        close();
+
+        compression_ = compression;
+        file_ = std::fopen(file_path.c_str(), "wb");
+        if (!file_) {
+            return false;
+        }
+        out_buf_.resize(IO_BUFFER_SIZE);
+
+        switch (compression_) {
+            case Compression::Gzip:
+#ifdef API_CHECKER_HAVE_ZLIB
+                zstream_ = z_stream{};
+                // 15+16: 输出gzip格式
+                if (deflateInit2(&zstream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                                 Z_DEFAULT_STRATEGY) != Z_OK) {
+                    close();
+                    return false;
+                }
+                zlib_ready_ = true;
+                return true;
+#else
+                close();
+                return false;
+#endif
+            case Compression::Zstd:
+#ifdef API_CHECKER_HAVE_ZSTD
+                cctx_ = ZSTD_createCCtx();
+                if (!cctx_) {
+                    close();
+                    return false;
+                }
+                return true;
+#else
+                close();
+                return false;
+#endif
+            default:
+                return true;
+        }
+    }
+
+    bool write(std::string_view data) {
+        if (!file_) {
+            return false;
+        }
+
+        switch (compression_) {
+            case Compression::Gzip:
+                return write_gzip(data, false);
+            case Compression::Zstd:
+                return write_zstd(data, false);
+            default:
+                return std::fwrite(data.data(), 1, data.size(), file_) == data.size();
+        }
+    }
+
+    bool close() {
+        if (!file_) {
+            return true;
+        }
+
+        bool ok = true;
+        if (compression_ == Compression::Gzip) {
+            ok = write_gzip({}, true);
+        } else if (compression_ == Compression::Zstd) {
+            ok = write_zstd({}, true);
+        }
+
+#ifdef API_CHECKER_HAVE_ZLIB
+        if (zlib_ready_) {
+            deflateEnd(&zstream_);
+            zlib_ready_ = false;
+        }
+#endif
+#ifdef API_CHECKER_HAVE_ZSTD
+        if (cctx_) {
+            ZSTD_freeCCtx(cctx_);
+            cctx_ = nullptr;
+        }
+#endif
+
+        ok = std::fclose(file_) == 0 && ok;
+        file_ = nullptr;
+        return ok;
+    }
+
+private:
+    bool write_gzip(std::string_view data, bool finish) {
+#ifdef API_CHECKER_HAVE_ZLIB
+        zstream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        zstream_.avail_in = static_cast<uInt>(data.size());
+
+        int ret;
+        do {
+            zstream_.next_out = reinterpret_cast<Bytef*>(out_buf_.data());
+            zstream_.avail_out = static_cast<uInt>(out_buf_.size());
+            ret = deflate(&zstream_, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR) {
+                return false;
+            }
+            size_t produced = out_buf_.size() - zstream_.avail_out;
+            if (std::fwrite(out_buf_.data(), 1, produced, file_) != produced) {
+                return false;
+            }
+        } while (zstream_.avail_out == 0 || (finish && ret != Z_STREAM_END));
+
+        return true;
+#else
+        (void)data;
+        (void)finish;
+        return false;
+#endif
+    }
+
+    bool write_zstd(std::string_view data, bool finish) {
+#ifdef API_CHECKER_HAVE_ZSTD
+        ZSTD_inBuffer in{data.data(), data.size(), 0};
+        const ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+
+        size_t remaining;
+        do {
+            ZSTD_outBuffer out{out_buf_.data(), out_buf_.size(), 0};
+            remaining = ZSTD_compressStream2(cctx_, &out, &in, mode);
+            if (ZSTD_isError(remaining)) {
+                return false;
+            }
+            if (std::fwrite(out_buf_.data(), 1, out.pos, file_) != out.pos) {
+                return false;
+            }
+        } while (finish ? remaining != 0 : in.pos < in.size);
+
+        return true;
+#else
+        (void)data;
+        (void)finish;
+        return false;
+#endif
+    }
+
+    std::FILE* file_ = nullptr;
+    Compression compression_ = Compression::None;
+    std::vector<char> out_buf_;
+
+#ifdef API_CHECKER_HAVE_ZLIB
+    z_stream zstream_{};
+    bool zlib_ready_ = false;
+#endif
+#ifdef API_CHECKER_HAVE_ZSTD
+    ZSTD_CCtx* cctx_ = nullptr;
+#endif
+};
+
+CompressingWriter::CompressingWriter() : pImpl_(std::make_unique<Impl>()) {}
+
+CompressingWriter::~CompressingWriter() = default;
+
+bool CompressingWriter::open(const std::string& file_path, Compression compression) {
+    return pImpl_->open(file_path, compression);
+}
+
+bool CompressingWriter::write(std::string_view data) {
+    return pImpl_->write(data);
+}
+
+bool CompressingWriter::close() {
+    return pImpl_->close();
+}
+
+} // namespace api_checker
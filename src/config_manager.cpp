@@ -157,7 +157,7 @@ bool ConfigManager::save_config(const std::string& config_file) const {
 
     try {
         auto json_content = config_.to_json().dump(2);
-        return FileUtils::write_file(file_path, json_content);
+        return FileUtils::write_file_atomic(file_path, json_content);
     } catch (const std::exception& e) {
         std::cerr << "保存配置文件失败: " << e.what() << std::endl;
         return false;
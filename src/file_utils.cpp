@@ -1,22 +1,50 @@
 #include "file_utils.h"
+#include "compressed_stream.h"
+#include "key_scanner.h"
+#include "mapped_file.h"
 #include <fstream>
+#include <iostream>
 #include <filesystem>
 #include <sstream>
-#include <regex>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
 #include <chrono>
 #include <iomanip>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace api_checker {
 
 std::optional<std::string> FileUtils::read_file(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
+    // gzip/zstd压缩的文件在读取时透明解压
+    DecompressingReader reader;
+    if (!reader.open(file_path)) {
         return std::nullopt;
     }
 
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
+    std::string content;
+    if (reader.compression() == Compression::None) {
+        if (auto size = get_file_size(file_path)) {
+            content.reserve(*size);
+        }
+    }
+
+    char buffer[64 * 1024];
+    while (size_t n = reader.read(buffer, sizeof(buffer))) {
+        content.append(buffer, n);
+    }
+
+    if (reader.failed()) {
+        return std::nullopt;
+    }
+    return content;
 }
 
 bool FileUtils::write_file(const std::string& file_path, const std::string& content) {
@@ -27,6 +55,17 @@ bool FileUtils::write_file(const std::string& file_path, const std::string& cont
             std::filesystem::create_directories(parent_path);
         }
 
+        // 扩展名为 .gz / .zst 时压缩写入
+        auto compression = compression_from_path(file_path);
+        if (compression != Compression::None) {
+            CompressingWriter writer;
+            if (!writer.open(file_path, compression)) {
+                return false;
+            }
+            bool ok = writer.write(content);
+            return writer.close() && ok;
+        }
+
         std::ofstream file(file_path, std::ios::binary);
         if (!file.is_open()) {
             return false;
@@ -39,6 +78,57 @@ bool FileUtils::write_file(const std::string& file_path, const std::string& cont
     }
 }
 
+bool FileUtils::write_file_atomic(const std::string& file_path, const std::string& content) {
+    std::string temp_path = file_path + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = std::fwrite(content.data(), 1, content.size(), file) == content.size() &&
+              std::fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && ::fsync(fileno(file)) == 0;
+#endif
+    ok = (std::fclose(file) == 0) && ok;
+
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return replace_file(temp_path, file_path);
+}
+
+bool FileUtils::replace_file(const std::string& temp_path, const std::string& file_path) {
+    std::error_code ec;
+    std::filesystem::rename(temp_path, file_path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    auto parent_path = std::filesystem::path(file_path).parent_path();
+    return sync_directory(parent_path.empty() ? "." : parent_path.string());
+}
+
+bool FileUtils::sync_directory(const std::string& dir_path) {
+#ifdef _WIN32
+    (void)dir_path;
+    return true;
+#else
+    int fd = ::open(dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
 bool FileUtils::file_exists(const std::string& file_path) {
     return std::filesystem::exists(file_path) && std::filesystem::is_regular_file(file_path);
 }
@@ -62,40 +152,165 @@ std::optional<size_t> FileUtils::get_file_size(const std::string& file_path) {
     }
 }
 
-std::vector<std::string> FileUtils::load_api_keys(const std::string& file_path) {
+std::vector<std::string> FileUtils::load_api_keys(const std::string& file_path,
+                                                  std::string* error_message) {
     std::vector<std::string> keys;
 
-    auto content = read_file(file_path);
-    if (!content) {
+    // 内存映射整个文件，大文件按行对齐分块后在所有核心上并行扫描
+    MappedFile mapped;
+    if (!mapped.open(file_path)) {
+        std::cerr << "读取API Keys失败: " << file_path << ": 无法打开文件" << std::endl;
+        if (error_message) {
+            *error_message = "无法打开文件";
+        }
         return keys;
     }
 
-    std::istringstream stream(*content);
-    std::string line;
-    std::regex sk_pattern(R"(sk-[a-zA-Z0-9]{48,})");
+    // 压缩文件无法按偏移切分，改为边解压边扫描
+    if (detect_compression(mapped.view().substr(0, 4)) != Compression::None) {
+        mapped.close();
+        std::string read_error;
+        for_each_api_key(file_path, [&keys](std::string key) {
+            keys.push_back(std::move(key));
+            return true;
+        }, &read_error);
+        // 与文件无法打开时一致，解压失败时不返回截断前的部分key
+        if (!read_error.empty()) {
+            keys.clear();
+            if (error_message) {
+                *error_message = read_error;
+            }
+        }
+        return keys;
+    }
 
-    while (std::getline(stream, line)) {
-        // 去除首尾空白字符
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    KeyScanner::scan_parallel(mapped.view(), keys);
+    return keys;
+}
 
-        if (line.empty() || line[0] == '#') {
-            continue; // 跳过空行和注释行
+size_t FileUtils::for_each_api_key(const std::string& file_path,
+                                   const std::function<bool(std::string)>& on_key,
+                                   std::string* error_message) {
+    auto report_failure = [&](const DecompressingReader& reader) {
+        std::cerr << "读取API Keys失败: " << file_path << ": " << reader.error_message() << std::endl;
+        if (error_message) {
+            *error_message = reader.error_message();
         }
+    };
+
+    // gzip/zstd文件直接从解压流中解析，无需先解压到临时文件
+    DecompressingReader reader;
+    if (!reader.open(file_path)) {
+        report_failure(reader);
+        return 0;
+    }
 
-        // 检查是否是有效的API Key格式
-        if (std::regex_search(line, sk_pattern)) {
-            // 提取sk-开头的部分
-            std::smatch match;
-            if (std::regex_search(line, match, sk_pattern)) {
-                keys.push_back(match.str());
+    // 分块读取，只扫描完整的行，不完整的行留到下一块，内存占用与文件大小无关
+    constexpr size_t CHUNK_SIZE = 1 << 20;
+    std::string buffer;
+    std::vector<std::string> keys;
+    size_t count = 0;
+    size_t pending = 0;
+    bool eof = false;
+
+    while (!eof) {
+        if (buffer.size() < pending + CHUNK_SIZE) {
+            buffer.resize(pending + CHUNK_SIZE);
+        }
+        size_t filled = pending;
+        while (filled < pending + CHUNK_SIZE) {
+            size_t n = reader.read(buffer.data() + filled, pending + CHUNK_SIZE - filled);
+            if (n == 0) {
+                eof = true;
+                break;
+            }
+            filled += n;
+        }
+
+        std::string_view view(buffer.data(), filled);
+        size_t complete = eof ? filled : KeyScanner::complete_lines_length(view);
+
+        keys.clear();
+        KeyScanner::scan(view.substr(0, complete), keys);
+        for (auto& key : keys) {
+            ++count;
+            if (!on_key(std::move(key))) {
+                return count;
             }
         }
+
+        pending = filled - complete;
+        std::memmove(buffer.data(), buffer.data() + complete, pending);
     }
 
-    return keys;
+    // read() 在数据损坏或截断时同样返回0，需要与正常结束区分
+    if (reader.failed()) {
+        report_failure(reader);
+    }
+    return count;
+}
+
+namespace {
+
+// 探测时最多读取的文件前缀字节数
+constexpr size_t KEY_PROBE_BYTES = 64 * 1024;
+
+// 探测结果缓存文件，每行: 文件大小 \t 修改时间 \t 是否包含key \t 路径
+constexpr const char* KEY_PROBE_CACHE_FILE = ".api_checker_probe_cache";
+
+struct ProbeCacheEntry {
+    uintmax_t size = 0;
+    int64_t mtime = 0;
+    bool has_keys = false;
+};
+
+std::unordered_map<std::string, ProbeCacheEntry> load_probe_cache() {
+    std::unordered_map<std::string, ProbeCacheEntry> cache;
+
+    std::ifstream file(KEY_PROBE_CACHE_FILE);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        ProbeCacheEntry entry;
+        int has_keys = 0;
+        std::string path;
+        if (fields >> entry.size >> entry.mtime >> has_keys && fields.get() == '\t' &&
+            std::getline(fields, path) && !path.empty()) {
+            entry.has_keys = has_keys != 0;
+            cache[path] = entry;
+        }
+    }
+
+    return cache;
+}
+
+void save_probe_cache(const std::unordered_map<std::string, ProbeCacheEntry>& cache) {
+    std::ostringstream ss;
+    for (const auto& [path, entry] : cache) {
+        // 丢弃已删除文件的条目，避免缓存无限增长
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec)) {
+            continue;
+        }
+        ss << entry.size << '\t' << entry.mtime << '\t' << (entry.has_keys ? 1 : 0)
+           << '\t' << path << '\n';
+    }
+    // 写入中断时不能留下半个缓存文件，否则下次启动会读到截断的条目
+    FileUtils::write_file_atomic(KEY_PROBE_CACHE_FILE, ss.str());
+}
+
+// 只映射并检查文件开头的有限字节，避免读取整个大文件
+bool probe_file_for_keys(const std::string& file_path) {
+    MappedFile mapped;
+    if (!mapped.open(file_path)) {
+        return false;
+    }
+    std::vector<std::string> keys;
+    return KeyScanner::scan(mapped.view().substr(0, KEY_PROBE_BYTES), keys) > 0;
 }
 
+} // namespace
+
 std::optional<std::string> FileUtils::find_api_keys_file() {
     // 按优先级查找API Keys文件
     std::vector<std::string> candidates = {
@@ -112,24 +327,46 @@ std::optional<std::string> FileUtils::find_api_keys_file() {
         }
     }
 
-    // 在当前目录查找任何包含sk-的txt文件
+    // 在当前目录查找开头包含API Key的txt文件，未变化的文件直接使用缓存结果
+    auto cache = load_probe_cache();
+    bool cache_dirty = false;
+    std::optional<std::string> found;
+
     try {
         for (const auto& entry : std::filesystem::directory_iterator(".")) {
-            if (entry.is_regular_file()) {
-                auto path = entry.path();
-                if (path.extension() == ".txt") {
-                    auto content = read_file(path.string());
-                    if (content && content->find("sk-") != std::string::npos) {
-                        return path.string();
-                    }
-                }
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+
+            auto path = entry.path().string();
+            ProbeCacheEntry current;
+            current.size = entry.file_size();
+            current.mtime = static_cast<int64_t>(entry.last_write_time().time_since_epoch().count());
+
+            auto it = cache.find(path);
+            if (it != cache.end() && it->second.size == current.size &&
+                it->second.mtime == current.mtime) {
+                current.has_keys = it->second.has_keys;
+            } else {
+                current.has_keys = probe_file_for_keys(path);
+                cache[path] = current;
+                cache_dirty = true;
+            }
+
+            if (current.has_keys) {
+                found = path;
+                break;
             }
         }
     } catch (const std::exception&) {
         // 忽略目录访问错误
     }
 
-    return std::nullopt;
+    if (cache_dirty) {
+        save_probe_cache(cache);
+    }
+
+    return found;
 }
 
 std::string FileUtils::generate_timestamp_filename(const std::string& prefix,
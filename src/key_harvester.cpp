@@ -0,0 +1,302 @@
+#include "key_harvester.h"
+#include "key_scanner.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+
+namespace api_checker {
+
+namespace {
+
+struct WorkItem {
+    std::filesystem::path path;
+    bool is_directory = false;
+};
+
+// 单个工作线程的任务队列
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<WorkItem> items;
+};
+
+// 工作窃取的目录遍历器
+class ParallelWalker {
+public:
+    ParallelWalker(const HarvestOptions& options,
+                   const std::function<bool(const HarvestedKey&)>& on_key,
+                   size_t threads)
+        : options_(options), on_key_(on_key), queues_(threads) {}
+
+    HarvestStats run(const std::filesystem::path& root, bool root_is_directory) {
+        push(0, {root, root_is_directory});
+
+        std::vector<std::thread> workers;
+        workers.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers.emplace_back([this, i]() { work(i); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        HarvestStats stats;
+        stats.directories = directories_.load();
+        stats.files_scanned = files_scanned_.load();
+        stats.files_skipped = files_skipped_.load();
+        stats.bytes_scanned = bytes_scanned_.load();
+        stats.keys_found = keys_found_.load();
+        return stats;
+    }
+
+private:
+    void push(size_t worker, WorkItem item) {
+        pending_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+            queues_[worker].items.push_back(std::move(item));
+        }
+        queued_.fetch_add(1);
+        // 只有存在空闲线程时才需要唤醒，忙碌时入队不碰 idle_mutex_
+        if (idle_workers_.load() > 0) {
+            wake(false);
+        }
+    }
+
+    // 先修改状态再在锁内通知，保证等待线程检查条件与进入等待之间不会丢失唤醒
+    void wake(bool all) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        if (all) {
+            idle_cv_.notify_all();
+        } else {
+            idle_cv_.notify_one();
+        }
+    }
+
+    // 所有队列都为空时休眠，直到有新任务入队、遍历结束或被回调停止
+    void wait_for_work() {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_workers_.fetch_add(1);
+        idle_cv_.wait(lock, [this]() {
+            return queued_.load() > 0 || pending_.load() == 0 || stopped_.load();
+        });
+        idle_workers_.fetch_sub(1);
+    }
+
+    std::optional<WorkItem> pop(size_t worker) {
+        {
+            auto& own = queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                WorkItem item = std::move(own.items.back());
+                own.items.pop_back();
+                queued_.fetch_sub(1);
+                return item;
+            }
+        }
+
+        // 自己的队列为空时，从其他线程的队首窃取
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            auto& victim = queues_[(worker + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                WorkItem item = std::move(victim.items.front());
+                victim.items.pop_front();
+                queued_.fetch_sub(1);
+                return item;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void work(size_t worker) {
+        std::vector<DetectedKey> detected;
+
+        while (!stopped_.load()) {
+            auto item = pop(worker);
+            if (!item) {
+                // 任务数在子任务入队之后才减少，为0时说明遍历已经结束
+                if (pending_.load() == 0) {
+                    break;
+                }
+                wait_for_work();
+                continue;
+            }
+
+            if (item->is_directory) {
+                walk_directory(worker, item->path);
+            } else {
+                scan_file(item->path, detected);
+            }
+            if (pending_.fetch_sub(1) == 1) {
+                wake(true);
+            }
+        }
+    }
+
+    bool is_ignored(const std::filesystem::path& path) const {
+        const std::string name = path.filename().string();
+        return std::any_of(options_.ignore_patterns.begin(), options_.ignore_patterns.end(),
+            [&name](const std::string& pattern) {
+                return KeyHarvester::matches_pattern(name, pattern);
+            });
+    }
+
+    void walk_directory(size_t worker, const std::filesystem::path& dir) {
+        directories_.fetch_add(1);
+
+        std::error_code ec;
+        std::filesystem::directory_iterator it(
+            dir, std::filesystem::directory_options::skip_permission_denied, ec);
+
+        for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            const auto& entry = *it;
+            if (is_ignored(entry.path())) {
+                if (!entry.is_directory(ec)) {
+                    files_skipped_.fetch_add(1);
+                }
+                continue;
+            }
+
+            // 不跟随符号链接，避免目录循环和重复扫描
+            if (entry.is_symlink(ec)) {
+                continue;
+            }
+            if (entry.is_directory(ec)) {
+                push(worker, {entry.path(), true});
+            } else if (entry.is_regular_file(ec)) {
+                push(worker, {entry.path(), false});
+            }
+        }
+    }
+
+    void scan_file(const std::filesystem::path& path, std::vector<DetectedKey>& detected) {
+        const std::string path_str = path.string();
+
+        MappedFile mapped;
+        if (!mapped.open(path_str) ||
+            (options_.max_file_size != 0 && mapped.size() > options_.max_file_size)) {
+            files_skipped_.fetch_add(1);
+            return;
+        }
+
+        std::string_view text = mapped.view();
+        size_t probe = std::min(text.size(), options_.binary_probe_bytes);
+        if (probe > 0 && std::memchr(text.data(), '\0', probe) != nullptr) {
+            files_skipped_.fetch_add(1);
+            return;
+        }
+
+        files_scanned_.fetch_add(1);
+        bytes_scanned_.fetch_add(text.size());
+
+        // 源码和日志里的key经常出现在注释中，不跳过#开头的行
+        detected.clear();
+        KeyScanner::instance().find(text, detected, false);
+
+        // key按偏移递增排列，行号只需从上一个key处继续累计
+        size_t line = 1;
+        size_t counted_to = 0;
+        for (auto& item : detected) {
+            line += static_cast<size_t>(std::count(text.begin() + counted_to,
+                                                   text.begin() + item.offset, '\n'));
+            counted_to = item.offset;
+
+            if (options_.deduplicate) {
+                std::lock_guard<std::mutex> lock(seen_mutex_);
+                if (!seen_keys_.insert(item.key).second) {
+                    continue;
+                }
+            }
+
+            keys_found_.fetch_add(1);
+            HarvestedKey key{std::move(item.key), item.pattern->provider, path_str, line};
+            if (!on_key_(key)) {
+                stopped_.store(true);
+                wake(true);
+                return;
+            }
+        }
+    }
+
+    const HarvestOptions& options_;
+    const std::function<bool(const HarvestedKey&)>& on_key_;
+
+    std::vector<WorkQueue> queues_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> stopped_{false};
+
+    // 各队列中尚未取出的任务数，空闲线程据此判断是否有可窃取的任务
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> idle_workers_{0};
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+
+    std::mutex seen_mutex_;
+    std::unordered_set<std::string> seen_keys_;
+
+    std::atomic<size_t> directories_{0};
+    std::atomic<size_t> files_scanned_{0};
+    std::atomic<size_t> files_skipped_{0};
+    std::atomic<size_t> bytes_scanned_{0};
+    std::atomic<size_t> keys_found_{0};
+};
+
+} // namespace
+
+std::string HarvestedKey::source() const {
+    return path + ":" + std::to_string(line);
+}
+
+HarvestStats KeyHarvester::harvest(const std::string& root, const HarvestOptions& options,
+                                   const std::function<bool(const HarvestedKey&)>& on_key) {
+    std::error_code ec;
+    std::filesystem::path root_path(root);
+    bool is_directory = std::filesystem::is_directory(root_path, ec);
+    if (!is_directory && !std::filesystem::is_regular_file(root_path, ec)) {
+        return {};
+    }
+
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ParallelWalker walker(options, on_key, is_directory ? threads : 1);
+    return walker.run(root_path, is_directory);
+}
+
+bool KeyHarvester::matches_pattern(std::string_view name, std::string_view pattern) {
+    // 经典的回溯通配符匹配，只需记住最近一个*的位置
+    size_t n = 0, p = 0;
+    size_t star = std::string_view::npos, star_match = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++n;
+            ++p;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_match = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_match;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+} // namespace api_checker
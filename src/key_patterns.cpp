@@ -0,0 +1,101 @@
+#include "key_patterns.h"
+#include <algorithm>
+
+namespace api_checker {
+
+KeyPatternRegistry::KeyPatternRegistry(std::vector<KeyPattern> patterns)
+    : patterns_(std::move(patterns)) {
+    // 前缀更长的格式排在前面，保证 sk-proj- 等优先于通用的 sk-
+    std::stable_sort(patterns_.begin(), patterns_.end(),
+        [](const KeyPattern& a, const KeyPattern& b) {
+            return a.prefix.size() > b.prefix.size();
+        });
+}
+
+const KeyPatternRegistry& KeyPatternRegistry::defaults() {
+    static const std::vector<std::string> bearer = {
+        "Authorization: Bearer {key}",
+        "Content-Type: application/json"
+    };
+    static const std::vector<std::string> anthropic = {
+        "x-api-key: {key}",
+        "anthropic-version: 2023-06-01"
+    };
+
+    static const KeyPatternRegistry registry({
+        {"openai", "sk-proj-", KeyCharset::AlnumDashUnderscore, 40, 0,
+         "https://api.openai.com/v1/models", bearer},
+        {"openai", "sk-svcacct-", KeyCharset::AlnumDashUnderscore, 40, 0,
+         "https://api.openai.com/v1/models", bearer},
+        {"openai", "sk-admin-", KeyCharset::AlnumDashUnderscore, 40, 0,
+         "https://api.openai.com/v1/models", bearer},
+        {"openai", "sk-", KeyCharset::Alnum, 48, 0,
+         "https://api.openai.com/v1/models", bearer},
+        {"anthropic", "sk-ant-api03-", KeyCharset::AlnumDashUnderscore, 80, 0,
+         "https://api.anthropic.com/v1/models", anthropic},
+        {"openrouter", "sk-or-v1-", KeyCharset::Hex, 64, 64,
+         "https://openrouter.ai/api/v1/key", bearer},
+        {"google", "AIza", KeyCharset::AlnumDashUnderscore, 35, 35,
+         "https://generativelanguage.googleapis.com/v1beta/models", {"x-goog-api-key: {key}"}},
+        {"groq", "gsk_", KeyCharset::Alnum, 52, 52,
+         "https://api.groq.com/openai/v1/models", bearer},
+        {"xai", "xai-", KeyCharset::Alnum, 80, 0,
+         "https://api.x.ai/v1/models", bearer},
+        {"huggingface", "hf_", KeyCharset::Alnum, 34, 34,
+         "https://huggingface.co/api/whoami-v2", bearer},
+    });
+
+    return registry;
+}
+
+bool KeyPatternRegistry::in_charset(char c, KeyCharset charset) {
+    bool digit = c >= '0' && c <= '9';
+    switch (charset) {
+        case KeyCharset::Alnum:
+            return digit || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        case KeyCharset::AlnumDashUnderscore:
+            return digit || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                   c == '-' || c == '_';
+        case KeyCharset::Hex:
+            return digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+    return false;
+}
+
+const KeyPattern* KeyPatternRegistry::classify(std::string_view key) const {
+    for (const auto& pattern : patterns_) {
+        if (!key.starts_with(pattern.prefix)) {
+            continue;
+        }
+
+        std::string_view body = key.substr(pattern.prefix.size());
+        if (body.size() < pattern.min_body ||
+            (pattern.max_body != 0 && body.size() > pattern.max_body)) {
+            continue;
+        }
+
+        bool valid = std::all_of(body.begin(), body.end(), [&](char c) {
+            return in_charset(c, pattern.charset);
+        });
+        if (valid) {
+            return &pattern;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> KeyPatternRegistry::build_headers(const KeyPattern& pattern,
+                                                           const std::string& key) {
+    std::vector<std::string> headers;
+    headers.reserve(pattern.headers.size());
+    for (auto header : pattern.headers) {
+        auto pos = header.find("{key}");
+        if (pos != std::string::npos) {
+            header.replace(pos, 5, key);
+        }
+        headers.push_back(std::move(header));
+    }
+    return headers;
+}
+
+} // namespace api_checker
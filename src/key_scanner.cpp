@@ -0,0 +1,478 @@
+#include "key_scanner.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+// API_CHECKER_DISABLE_AVX2 / API_CHECKER_DISABLE_SIMD 强制使用较低的实现，单元测试据此比较各实现的结果
+#if defined(API_CHECKER_DISABLE_SIMD)
+#elif defined(__AVX2__) && !defined(API_CHECKER_DISABLE_AVX2)
+#include <immintrin.h>
+#define API_CHECKER_SIMD_AVX2 1
+#define API_CHECKER_SIMD_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define API_CHECKER_SIMD_SSE2 1
+#endif
+
+namespace api_checker {
+
+namespace {
+
+// 单个SIMD循环内最多比较的前缀字节对数，超过时不启用预过滤
+constexpr size_t MAX_PREFILTER_PAIRS = 16;
+
+inline bool is_alnum_ascii(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+#ifdef API_CHECKER_SIMD_SSE2
+// 16字节的字符集掩码；大于0x7F的字节按有符号比较为负数，不会落入任何区间
+inline unsigned charset_mask_sse2(__m128i v, KeyCharset charset) {
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i accept;
+    if (charset == KeyCharset::Hex) {
+        accept = _mm_or_si128(digit,
+                     _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1))));
+    } else {
+        accept = _mm_or_si128(digit,
+                     _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+        if (charset == KeyCharset::AlnumDashUnderscore) {
+            accept = _mm_or_si128(accept,
+                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                                      _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+        }
+    }
+    return static_cast<unsigned>(_mm_movemask_epi8(accept));
+}
+#endif
+
+#ifdef API_CHECKER_SIMD_AVX2
+inline uint32_t charset_mask_avx2(__m256i v, KeyCharset charset) {
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i accept;
+    if (charset == KeyCharset::Hex) {
+        accept = _mm256_or_si256(digit,
+                     _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower)));
+    } else {
+        accept = _mm256_or_si256(digit,
+                     _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)));
+        if (charset == KeyCharset::AlnumDashUnderscore) {
+            accept = _mm256_or_si256(accept,
+                         _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))));
+        }
+    }
+    return static_cast<uint32_t>(_mm256_movemask_epi8(accept));
+}
+#endif
+
+// 查找下一个换行符，找不到时返回end
+const char* find_newline(const char* p, const char* end) {
+#ifdef API_CHECKER_SIMD_AVX2
+    const __m256i nl32 = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl32)));
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+        p += 32;
+    }
+#endif
+#ifdef API_CHECKER_SIMD_SSE2
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl16)));
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+// 从p开始连续属于字符集的字符个数
+size_t charset_run_length(const char* p, const char* end, KeyCharset charset) {
+    const char* start = p;
+#ifdef API_CHECKER_SIMD_AVX2
+    while (end - p >= 32) {
+        uint32_t mask = charset_mask_avx2(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), charset);
+        if (mask != 0xFFFFFFFFu) {
+            return static_cast<size_t>(p - start) + std::countr_zero(~mask);
+        }
+        p += 32;
+    }
+#endif
+#ifdef API_CHECKER_SIMD_SSE2
+    while (end - p >= 16) {
+        unsigned mask = charset_mask_sse2(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), charset);
+        if (mask != 0xFFFFu) {
+            return static_cast<size_t>(p - start) + std::countr_zero(~mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && KeyPatternRegistry::in_charset(*p, charset)) {
+        ++p;
+    }
+    return static_cast<size_t>(p - start);
+}
+
+} // namespace
+
+KeyScanner::KeyScanner(const KeyPatternRegistry& registry)
+    : registry_(&registry) {
+    const auto& patterns = registry.patterns();
+
+    // 1. 构建前缀字典树，状态0为根
+    std::vector<std::array<int, 256>> trie(1);
+    trie[0].fill(-1);
+    outputs_.resize(1);
+
+    for (const auto& pattern : patterns) {
+        if (pattern.prefix.empty() || pattern.prefix.size() > 255) {
+            throw std::invalid_argument("key前缀长度必须在1到255之间: " + pattern.provider);
+        }
+
+        int state = 0;
+        for (char ch : pattern.prefix) {
+            auto byte = static_cast<uint8_t>(ch);
+            if (trie[state][byte] < 0) {
+                trie[state][byte] = static_cast<int>(trie.size());
+                trie.emplace_back();
+                trie.back().fill(-1);
+                outputs_.emplace_back();
+            }
+            state = trie[state][byte];
+        }
+
+        auto length = static_cast<uint8_t>(pattern.prefix.size());
+        if (std::find(outputs_[state].begin(), outputs_[state].end(), length) == outputs_[state].end()) {
+            outputs_[state].push_back(length);
+        }
+    }
+
+    if (trie.size() > UINT16_MAX) {
+        throw std::invalid_argument("key前缀总长度过大");
+    }
+
+    // 2. 按广度优先计算失败链接，同时补全为DFA转移表
+    transitions_.assign(trie.size() * 256, 0);
+    std::vector<uint16_t> fail(trie.size(), 0);
+    std::deque<uint16_t> queue;
+
+    for (int byte = 0; byte < 256; ++byte) {
+        int next = trie[0][byte];
+        if (next > 0) {
+            transitions_[byte] = static_cast<uint16_t>(next);
+            queue.push_back(static_cast<uint16_t>(next));
+        }
+    }
+
+    while (!queue.empty()) {
+        uint16_t state = queue.front();
+        queue.pop_front();
+
+        // 失败状态上能结束的前缀在当前状态同样结束
+        const auto& inherited = outputs_[fail[state]];
+        for (uint8_t length : inherited) {
+            if (std::find(outputs_[state].begin(), outputs_[state].end(), length) == outputs_[state].end()) {
+                outputs_[state].push_back(length);
+            }
+        }
+
+        for (int byte = 0; byte < 256; ++byte) {
+            int next = trie[state][byte];
+            uint16_t fallback = transitions_[fail[state] * 256 + byte];
+            if (next > 0) {
+                fail[next] = fallback;
+                transitions_[state * 256 + byte] = static_cast<uint16_t>(next);
+                queue.push_back(static_cast<uint16_t>(next));
+            } else {
+                transitions_[state * 256 + byte] = fallback;
+            }
+        }
+    }
+
+    // 3. 按首字节分组，注册表已按前缀长度降序排列
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        by_first_byte_[static_cast<uint8_t>(patterns[i].prefix[0])].push_back(static_cast<uint16_t>(i));
+    }
+
+    // 4. 所有前缀都至少两个字节时，用前两个字节做向量化预过滤
+    prefilter_ = !patterns.empty();
+    for (const auto& pattern : patterns) {
+        if (pattern.prefix.size() < 2) {
+            prefilter_ = false;
+            break;
+        }
+        std::array<char, 2> pair{pattern.prefix[0], pattern.prefix[1]};
+        if (std::find(prefilter_pairs_.begin(), prefilter_pairs_.end(), pair) == prefilter_pairs_.end()) {
+            prefilter_pairs_.push_back(pair);
+        }
+    }
+    if (prefilter_pairs_.size() > MAX_PREFILTER_PAIRS) {
+        prefilter_ = false;
+    }
+}
+
+const KeyScanner& KeyScanner::instance() {
+    static const KeyScanner scanner(KeyPatternRegistry::defaults());
+    return scanner;
+}
+
+const char* KeyScanner::next_candidate(const char* p, const char* end) const {
+#ifdef API_CHECKER_SIMD_AVX2
+    while (end - p >= 33) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        __m256i hit = _mm256_setzero_si256();
+        for (const auto& pair : prefilter_pairs_) {
+            hit = _mm256_or_si256(hit,
+                      _mm256_and_si256(_mm256_cmpeq_epi8(a, _mm256_set1_epi8(pair[0])),
+                                       _mm256_cmpeq_epi8(b, _mm256_set1_epi8(pair[1]))));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+        p += 32;
+    }
+#endif
+#ifdef API_CHECKER_SIMD_SSE2
+    while (end - p >= 17) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        __m128i hit = _mm_setzero_si128();
+        for (const auto& pair : prefilter_pairs_) {
+            hit = _mm_or_si128(hit,
+                      _mm_and_si128(_mm_cmpeq_epi8(a, _mm_set1_epi8(pair[0])),
+                                    _mm_cmpeq_epi8(b, _mm_set1_epi8(pair[1]))));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; end - p >= 2; ++p) {
+        for (const auto& pair : prefilter_pairs_) {
+            if (p[0] == pair[0] && p[1] == pair[1]) {
+                return p;
+            }
+        }
+    }
+    return end;
+}
+
+const char* KeyScanner::match_at(const char* start, const char* end,
+                                 const KeyPattern*& pattern) const {
+    const auto& patterns = registry_->patterns();
+    size_t available = static_cast<size_t>(end - start);
+
+    for (uint16_t index : by_first_byte_[static_cast<uint8_t>(*start)]) {
+        const auto& candidate = patterns[index];
+        size_t prefix_len = candidate.prefix.size();
+        if (available < prefix_len ||
+            std::memcmp(start, candidate.prefix.data(), prefix_len) != 0) {
+            continue;
+        }
+
+        size_t body = charset_run_length(start + prefix_len, end, candidate.charset);
+        if (body < candidate.min_body ||
+            (candidate.max_body != 0 && body > candidate.max_body)) {
+            continue;
+        }
+
+        pattern = &candidate;
+        return start + prefix_len + body;
+    }
+    return nullptr;
+}
+
+template <typename Result, typename Emit>
+size_t KeyScanner::scan_range(const char* base, const char* begin, const char* end,
+                              bool skip_comments, std::vector<Result>& results,
+                              const Emit& emit) const {
+    size_t found = 0;
+    const char* p = begin;
+    const char* last_start = nullptr;
+    uint16_t state = 0;
+
+    // 注释行只在找到key时才回溯判断，同一行上的后续key复用结果
+    const char* line_scanned = begin;
+    bool line_known = false;
+    bool comment_line = false;
+
+    while (p < end) {
+        if (state == 0 && prefilter_) {
+            p = next_candidate(p, end);
+            if (p == end) {
+                break;
+            }
+        }
+
+        state = transitions_[state * 256 + static_cast<uint8_t>(*p)];
+        ++p;
+
+        for (uint8_t length : outputs_[state]) {
+            const char* start = p - length;
+            // 同一起点只判断一次，且前一个字符不能是字母数字
+            if (start == last_start || (start > base && is_alnum_ascii(start[-1]))) {
+                continue;
+            }
+            last_start = start;
+
+            const KeyPattern* pattern = nullptr;
+            const char* key_end = match_at(start, end, pattern);
+            if (!key_end) {
+                continue;
+            }
+
+            if (skip_comments) {
+                const char* line_begin = start;
+                while (line_begin > line_scanned && line_begin[-1] != '\n') {
+                    --line_begin;
+                }
+                if (line_begin > line_scanned || !line_known) {
+                    while (line_begin < start && (*line_begin == ' ' || *line_begin == '\t' ||
+                                                  *line_begin == '\r')) {
+                        ++line_begin;
+                    }
+                    comment_line = *line_begin == '#';
+                    line_known = true;
+                }
+                line_scanned = key_end;
+            }
+
+            if (!comment_line) {
+                emit(results, start, key_end, pattern);
+                ++found;
+            }
+
+            // key之间不重叠，从key结尾处重新开始匹配
+            p = key_end;
+            state = 0;
+            break;
+        }
+    }
+
+    return found;
+}
+
+template <typename Result, typename Emit>
+size_t KeyScanner::scan_text(const char* base, std::string_view text, bool skip_comments,
+                             std::vector<Result>& results, const Emit& emit) const {
+    // key中不会出现换行符，整段文本作为一个区间扫描，注释行在匹配时判断
+    return scan_range(base, text.data(), text.data() + text.size(), skip_comments, results, emit);
+}
+
+template <typename Result, typename Emit>
+size_t KeyScanner::scan_parallel_impl(std::string_view text, size_t threads, bool skip_comments,
+                                      std::vector<Result>& results, const Emit& emit) const {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, std::max<size_t>(1, text.size() / MIN_PARALLEL_CHUNK));
+    if (threads <= 1) {
+        return scan_text(text.data(), text, skip_comments, results, emit);
+    }
+
+    // 分块边界对齐到换行符之后，保证每一行完整地落在某一块中
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < threads; ++i) {
+        size_t pos = std::max(text.size() / threads * i, bounds.back());
+        const char* nl = find_newline(text.data() + pos, text.data() + text.size());
+        bounds.push_back(std::min(text.size(), static_cast<size_t>(nl - text.data()) + 1));
+    }
+    bounds.push_back(text.size());
+
+    std::vector<std::vector<Result>> chunk_results(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            scan_text(text.data(), text.substr(bounds[i], bounds[i + 1] - bounds[i]),
+                      skip_comments, chunk_results[i], emit);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 按文件顺序拼接各块结果
+    size_t found = 0;
+    for (const auto& chunk : chunk_results) {
+        found += chunk.size();
+    }
+    results.reserve(results.size() + found);
+    for (auto& chunk : chunk_results) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(results));
+    }
+
+    return found;
+}
+
+size_t KeyScanner::find(std::string_view text, std::vector<DetectedKey>& keys,
+                        bool skip_comments) const {
+    return find_parallel(text, keys, 1, skip_comments);
+}
+
+size_t KeyScanner::find_parallel(std::string_view text, std::vector<DetectedKey>& keys,
+                                 size_t threads, bool skip_comments) const {
+    const char* base = text.data();
+    return scan_parallel_impl(text, threads, skip_comments, keys,
+        [base](std::vector<DetectedKey>& out, const char* start, const char* end,
+               const KeyPattern* pattern) {
+            out.push_back({std::string(start, end), pattern, static_cast<size_t>(start - base)});
+        });
+}
+
+size_t KeyScanner::scan(std::string_view text, std::vector<std::string>& keys) {
+    return scan_parallel(text, keys, 1);
+}
+
+size_t KeyScanner::scan_parallel(std::string_view text, std::vector<std::string>& keys,
+                                 size_t threads) {
+    return instance().scan_parallel_impl(text, threads, true, keys,
+        [](std::vector<std::string>& out, const char* start, const char* end, const KeyPattern*) {
+            out.emplace_back(start, end);
+        });
+}
+
+size_t KeyScanner::complete_lines_length(std::string_view text) {
+    size_t pos = text.rfind('\n');
+    return pos == std::string_view::npos ? 0 : pos + 1;
+}
+
+const char* KeyScanner::simd_backend() {
+#if defined(API_CHECKER_SIMD_AVX2)
+    return "avx2";
+#elif defined(API_CHECKER_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace api_checker
@@ -0,0 +1,69 @@
+#include "progress_bar.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace api_checker {
+
+namespace {
+
+constexpr size_t BAR_WIDTH = 30;
+constexpr std::chrono::milliseconds REDRAW_INTERVAL{100};
+
+} // namespace
+
+ProgressBar::ProgressBar(size_t total, bool enabled)
+    : total_(total), enabled_(enabled), start_time_(std::chrono::steady_clock::now()) {}
+
+void ProgressBar::update(size_t current) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ = std::max(current_, current);
+    draw(false);
+}
+
+void ProgressBar::set_message(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    message_ = message;
+}
+
+void ProgressBar::finish(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+        return;
+    }
+    if (!message.empty()) {
+        message_ = message;
+    }
+    draw(true);
+    if (enabled_) {
+        std::fputc('\n', stderr);
+        std::fflush(stderr);
+    }
+    finished_ = true;
+}
+
+void ProgressBar::draw(bool force) {
+    if (!enabled_ || finished_) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - last_draw_ < REDRAW_INTERVAL && current_ < total_) {
+        return;
+    }
+    last_draw_ = now;
+
+    double ratio = total_ == 0 ? 1.0 : std::min(1.0, static_cast<double>(current_) / total_);
+    size_t filled = static_cast<size_t>(ratio * BAR_WIDTH);
+    double elapsed = std::chrono::duration<double>(now - start_time_).count();
+    double speed = elapsed > 0 ? current_ / elapsed : 0.0;
+
+    std::string bar(filled, '#');
+    bar.append(BAR_WIDTH - filled, '-');
+
+    std::fprintf(stderr, "\r[%s] %zu/%zu %5.1f%% %.1f/s %s\033[K",
+                 bar.c_str(), current_, total_, ratio * 100.0, speed, message_.c_str());
+    std::fflush(stderr);
+}
+
+} // namespace api_checker
@@ -0,0 +1,196 @@
+#include "progress_index.h"
+#include "api_checker.h"
+#include "file_utils.h"
+#include "progress_journal.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace api_checker {
+
+namespace {
+
+// 索引文件，每行: 文件大小 \t 修改时间 \t 指纹 \t 总数 \t 已完成 \t 保存时间(毫秒)
+//                \t 进度文件 \t 会话ID \t 输入文件
+// 无法解析的进度文件记为: ! \t 文件大小 \t 修改时间 \t 进度文件，文件不变时不再重复解析和报错
+constexpr const char* PROGRESS_INDEX_FILE = ".api_checker_progress_index";
+constexpr char UNREADABLE_MARK = '!';
+
+// 无法解析的进度文件在索引中只记录大小和修改时间
+struct UnreadableFile {
+    uintmax_t file_size = 0;
+    int64_t file_mtime = 0;
+};
+
+struct IndexContents {
+    std::unordered_map<std::string, ProgressSession> sessions;
+    std::unordered_map<std::string, UnreadableFile> unreadable;
+};
+
+bool is_progress_file(const std::string& filename) {
+    if (!filename.starts_with("progress_")) {
+        return false;
+    }
+    return filename.ends_with(".journal") || filename.ends_with(".json") ||
+           filename.ends_with(".json.gz") || filename.ends_with(".json.zst");
+}
+
+int64_t to_millis(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+IndexContents load_index(const std::string& index_path) {
+    IndexContents index;
+
+    std::ifstream file(index_path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        if (!line.empty() && line[0] == UNREADABLE_MARK) {
+            UnreadableFile unreadable;
+            std::string path;
+            fields.ignore(1);
+            if (fields >> unreadable.file_size >> unreadable.file_mtime && fields.get() == '\t' &&
+                std::getline(fields, path) && !path.empty()) {
+                index.unreadable[path] = unreadable;
+            }
+            continue;
+        }
+
+        ProgressSession session;
+        int64_t last_save_ms = 0;
+        if (fields >> session.file_size >> session.file_mtime >> session.fingerprint >>
+                session.total >> session.completed >> last_save_ms &&
+            fields.get() == '\t' && std::getline(fields, session.file, '\t') &&
+            std::getline(fields, session.session_id, '\t') &&
+            std::getline(fields, session.input_file) && !session.file.empty()) {
+            session.last_save = std::chrono::system_clock::time_point(
+                std::chrono::milliseconds(last_save_ms));
+            index.sessions[session.file] = session;
+        }
+    }
+
+    return index;
+}
+
+void save_index(const std::string& index_path, const std::vector<ProgressSession>& sessions,
+                const std::unordered_map<std::string, UnreadableFile>& unreadable) {
+    std::ostringstream ss;
+    for (const auto& [path, file] : unreadable) {
+        ss << UNREADABLE_MARK << '\t' << file.file_size << '\t' << file.file_mtime << '\t'
+           << path << '\n';
+    }
+    for (const auto& session : sessions) {
+        ss << session.file_size << '\t' << session.file_mtime << '\t' << session.fingerprint
+           << '\t' << session.total << '\t' << session.completed << '\t'
+           << to_millis(session.last_save) << '\t' << session.file << '\t'
+           << session.session_id << '\t' << session.input_file << '\n';
+    }
+    FileUtils::write_file_atomic(index_path, ss.str());
+}
+
+} // namespace
+
+std::optional<ProgressSession> ProgressIndex::describe(const std::string& progress_file) {
+    ProgressSession session;
+    session.file = progress_file;
+
+    if (ProgressJournal::is_journal(progress_file)) {
+        auto header = ProgressJournal::read_header(progress_file);
+        if (!header) {
+            return std::nullopt;
+        }
+        session.session_id = header->session_id;
+        session.input_file = header->input_file;
+        session.fingerprint = header->fingerprint;
+        session.total = header->key_count;
+
+        // 完成数优先取位图侧文件，侧文件过期时只回放记录（不加载key列表）
+        std::error_code ec;
+        auto size = std::filesystem::file_size(progress_file, ec);
+        auto sidecar = CompletionSidecar::load(ProgressJournal::sidecar_path(progress_file));
+        if (!ec && sidecar && sidecar->fingerprint == header->fingerprint &&
+            sidecar->journal_bytes == size) {
+            session.completed = sidecar->bitmap.count();
+        } else if (auto state = ProgressJournal::replay(progress_file, false)) {
+            session.completed = state->records.size();
+        }
+
+        // 日志每次提交都会更新修改时间，以此作为上次保存时间
+        auto modified = std::filesystem::last_write_time(progress_file, ec);
+        session.last_save = ec ? header->created_at
+                               : std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                                     std::chrono::file_clock::to_sys(modified));
+        return session;
+    }
+
+    auto progress = APIKeyChecker::load_progress(progress_file);
+    if (!progress) {
+        return std::nullopt;
+    }
+    session.session_id = progress->session_id;
+    session.input_file = progress->input_file;
+    session.fingerprint = ProgressJournal::fingerprint(progress->all_keys);
+    session.total = progress->all_keys.size();
+    session.completed = progress->completed.count();
+    session.last_save = progress->last_save_time;
+    return session;
+}
+
+std::vector<ProgressSession> ProgressIndex::refresh(const std::string& dir) {
+    std::string index_path = (std::filesystem::path(dir) / PROGRESS_INDEX_FILE).string();
+    auto index = load_index(index_path);
+    size_t indexed = index.sessions.size();
+    bool index_dirty = false;
+
+    std::vector<ProgressSession> sessions;
+    std::unordered_map<std::string, UnreadableFile> unreadable;
+    try {
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (!entry.is_regular_file() || !is_progress_file(entry.path().filename().string())) {
+                continue;
+            }
+
+            // 当前目录下保持与原来相同的相对文件名
+            auto path = dir == "." ? entry.path().filename().string() : entry.path().string();
+            auto file_size = entry.file_size();
+            auto file_mtime = static_cast<int64_t>(entry.last_write_time().time_since_epoch().count());
+
+            auto it = index.sessions.find(path);
+            if (it != index.sessions.end() && it->second.file_size == file_size &&
+                it->second.file_mtime == file_mtime) {
+                sessions.push_back(it->second);
+                continue;
+            }
+
+            // 上次无法解析且之后没有变化的文件直接跳过，不再重复解析和报错
+            auto bad = index.unreadable.find(path);
+            if (bad != index.unreadable.end() && bad->second.file_size == file_size &&
+                bad->second.file_mtime == file_mtime) {
+                unreadable.insert(*bad);
+                continue;
+            }
+
+            index_dirty = true;
+            if (auto session = describe(path)) {
+                session->file_size = file_size;
+                session->file_mtime = file_mtime;
+                sessions.push_back(std::move(*session));
+            } else {
+                unreadable[path] = {file_size, file_mtime};
+            }
+        }
+    } catch (const std::exception&) {
+        // 忽略目录访问错误
+    }
+
+    // 有文件被删除时也需要重写索引
+    if (index_dirty || sessions.size() != indexed || unreadable.size() != index.unreadable.size()) {
+        save_index(index_path, sessions, unreadable);
+    }
+
+    return sessions;
+}
+
+} // namespace api_checker
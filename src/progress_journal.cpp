@@ -0,0 +1,776 @@
+#include "progress_journal.h"
+#include "binary_io.h"
+#include "file_utils.h"
+#include "key_patterns.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace api_checker {
+
+namespace {
+
+// 日志头固定部分：
+//   0  魔数[8]   8  版本u32   12 元数据长度u32   16 指纹u64   24 key数量u64
+//   32 key列表长度u64   40 标志u32   44 CRC32(前44字节 + 元数据)u32
+// 之后依次是JSON元数据、以'\n'分隔的key列表（引用外部输入时为空）和定长记录
+constexpr char MAGIC[8] = {'A', 'P', 'C', 'J', 'R', 'N', 'L', '\x01'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t FIXED_HEADER_SIZE = 48;
+constexpr uint32_t FLAG_KEYS_EXTERNAL = 1;
+
+// 记录：0 序号u32  4 状态u8  5 消息类别u8  6 HTTP状态码u16
+//       8 耗时u32  12 检测时间i64  20 CRC32(前20字节)u32
+constexpr size_t RECORD_SIZE = 24;
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+// 每个key之后追加一个'\n'参与哈希，避免 ["ab","c"] 与 ["a","bc"] 冲突
+uint64_t fingerprint_append(uint64_t hash, std::string_view key) {
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * FNV_PRIME;
+    }
+    return (hash ^ '\n') * FNV_PRIME;
+}
+
+void encode_record(const JournalRecord& record, char* out) {
+    put_le<uint32_t>(out, record.ordinal);
+    out[4] = static_cast<char>(record.status);
+    out[5] = static_cast<char>(record.message_code);
+    put_le<uint16_t>(out + 6, record.http_status);
+    put_le<uint32_t>(out + 8, record.response_ms);
+    put_le<int64_t>(out + 12, record.checked_at_ms);
+    put_le<uint32_t>(out + 20, crc32(out, 20));
+}
+
+bool decode_record(const char* in, JournalRecord& record) {
+    if (get_le<uint32_t>(in + 20) != crc32(in, 20)) {
+        return false;
+    }
+    record.ordinal = get_le<uint32_t>(in);
+    record.status = static_cast<KeyStatus>(static_cast<uint8_t>(in[4]));
+    record.message_code = static_cast<MessageCode>(static_cast<uint8_t>(in[5]));
+    record.http_status = get_le<uint16_t>(in + 6);
+    record.response_ms = get_le<uint32_t>(in + 8);
+    record.checked_at_ms = get_le<int64_t>(in + 12);
+    return true;
+}
+
+int64_t to_millis(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_millis(int64_t ms) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+std::string encode_header(const JournalHeader& header) {
+    nlohmann::json meta;
+    meta["session_id"] = header.session_id;
+    meta["input_file"] = header.input_file;
+    meta["concurrent"] = header.concurrent;
+    meta["timeout"] = header.timeout;
+    meta["created_at_ms"] = to_millis(header.created_at);
+    if (header.request) {
+        meta["request"] = {
+            {"endpoint", header.request->endpoint},
+            {"method", header.request->method},
+            {"headers", header.request->headers},
+            {"body", header.request->body}
+        };
+    }
+    std::string meta_str = meta.dump();
+
+    size_t keys_bytes = 0;
+    if (!header.keys_external) {
+        for (const auto& key : header.keys) {
+            keys_bytes += key.size() + 1;
+        }
+    }
+
+    std::string out(FIXED_HEADER_SIZE, '\0');
+    std::memcpy(out.data(), MAGIC, sizeof(MAGIC));
+    put_le<uint32_t>(out.data() + 8, VERSION);
+    put_le<uint32_t>(out.data() + 12, static_cast<uint32_t>(meta_str.size()));
+    put_le<uint64_t>(out.data() + 16, header.fingerprint);
+    put_le<uint64_t>(out.data() + 24, header.key_count);
+    put_le<uint64_t>(out.data() + 32, keys_bytes);
+    put_le<uint32_t>(out.data() + 40, header.keys_external ? FLAG_KEYS_EXTERNAL : 0);
+
+    uint32_t crc = crc32(out.data(), 44);
+    crc = crc32(meta_str.data(), meta_str.size(), crc);
+    put_le<uint32_t>(out.data() + 44, crc);
+
+    out.reserve(FIXED_HEADER_SIZE + meta_str.size() + keys_bytes);
+    out += meta_str;
+    if (!header.keys_external) {
+        for (const auto& key : header.keys) {
+            out += key;
+            out.push_back('\n');
+        }
+    }
+    return out;
+}
+
+// 解析日志头的固定部分和元数据，返回key列表的起始偏移，失败时返回0
+size_t decode_header(std::string_view data, JournalHeader& header, size_t& keys_bytes) {
+    if (data.size() < FIXED_HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+        get_le<uint32_t>(data.data() + 8) != VERSION) {
+        return 0;
+    }
+
+    uint32_t meta_len = get_le<uint32_t>(data.data() + 12);
+    if (data.size() < FIXED_HEADER_SIZE + meta_len) {
+        return 0;
+    }
+
+    uint32_t crc = crc32(data.data(), 44);
+    crc = crc32(data.data() + FIXED_HEADER_SIZE, meta_len, crc);
+    if (crc != get_le<uint32_t>(data.data() + 44)) {
+        return 0;
+    }
+
+    header.fingerprint = get_le<uint64_t>(data.data() + 16);
+    header.key_count = get_le<uint64_t>(data.data() + 24);
+    keys_bytes = get_le<uint64_t>(data.data() + 32);
+    header.keys_external = (get_le<uint32_t>(data.data() + 40) & FLAG_KEYS_EXTERNAL) != 0;
+
+    try {
+        auto meta = nlohmann::json::parse(data.substr(FIXED_HEADER_SIZE, meta_len));
+        header.session_id = meta.value("session_id", "");
+        header.input_file = meta.value("input_file", "");
+        header.concurrent = meta.value("concurrent", size_t{1000});
+        header.timeout = meta.value("timeout", size_t{10});
+        header.created_at = from_millis(meta.value("created_at_ms", int64_t{0}));
+        if (meta.contains("request") && meta["request"].is_object()) {
+            const auto& request = meta["request"];
+            header.request = JournalRequest{
+                request.value("endpoint", ""),
+                request.value("method", ""),
+                request.value("headers", ""),
+                request.value("body", "")
+            };
+        }
+    } catch (const std::exception&) {
+        return 0;
+    }
+
+    return FIXED_HEADER_SIZE + meta_len;
+}
+
+bool sync_file(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+} // namespace
+
+JournalRecord JournalRecord::from_result(uint32_t ordinal, const KeyResult& result) {
+    JournalRecord record;
+    record.ordinal = ordinal;
+    record.status = result.status;
+    record.message_code = result.message_code;
+    record.http_status = result.http_status;
+    if (result.response_time) {
+        record.response_ms = static_cast<uint32_t>(
+            std::min<int64_t>(result.response_time->count(), NO_RESPONSE_TIME - 1));
+    }
+    record.checked_at_ms = to_millis(result.checked_at);
+    return record;
+}
+
+KeyResult JournalRecord::to_result(const std::string& key) const {
+    KeyResult result;
+    result.key = key;
+    result.status = status;
+    result.message_code = message_code;
+    result.http_status = http_status;
+    result.message = KeyResult::describe(message_code, http_status);
+    result.checked_at = from_millis(checked_at_ms);
+    if (response_ms != NO_RESPONSE_TIME) {
+        result.response_time = std::chrono::milliseconds(response_ms);
+    }
+    if (const KeyPattern* pattern = KeyPatternRegistry::defaults().classify(key)) {
+        result.provider = pattern->provider;
+    }
+    return result;
+}
+
+// 侧文件布局：0 魔数[8]  8 位数u64  16 日志长度u64  24 指纹u64
+//             32 有效数u64  40 无效数u64  48 错误数u64  56 位图字...  末尾 CRC32u32
+constexpr char SIDECAR_MAGIC[8] = {'A', 'P', 'C', 'B', 'M', 'A', 'P', '\x01'};
+constexpr size_t SIDECAR_HEADER_SIZE = 56;
+
+bool CompletionSidecar::save(const std::string& path) const {
+    const auto& words = bitmap.words();
+    std::string data(SIDECAR_HEADER_SIZE + words.size() * 8 + 4, '\0');
+    std::memcpy(data.data(), SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+    put_le<uint64_t>(data.data() + 8, bitmap.size());
+    put_le<uint64_t>(data.data() + 16, journal_bytes);
+    put_le<uint64_t>(data.data() + 24, fingerprint);
+    put_le<uint64_t>(data.data() + 32, valid);
+    put_le<uint64_t>(data.data() + 40, invalid);
+    put_le<uint64_t>(data.data() + 48, error);
+    for (size_t i = 0; i < words.size(); ++i) {
+        put_le<uint64_t>(data.data() + SIDECAR_HEADER_SIZE + i * 8, words[i]);
+    }
+    size_t body = data.size() - 4;
+    put_le<uint32_t>(data.data() + body, crc32(data.data(), body));
+
+    // 侧文件只是加速恢复的缓存，丢失时回放整个日志即可，因此不单独fsync
+    std::string temp_path = path + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = (std::fclose(file) == 0) && ok;
+
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!ok || ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<CompletionSidecar> CompletionSidecar::load(const std::string& path) {
+    MappedFile mapped;
+    if (!mapped.open(path) || mapped.size() < SIDECAR_HEADER_SIZE + 4) {
+        return std::nullopt;
+    }
+    const char* data = mapped.data();
+    size_t body = mapped.size() - 4;
+    if (std::memcmp(data, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC)) != 0 ||
+        get_le<uint32_t>(data + body) != crc32(data, body)) {
+        return std::nullopt;
+    }
+
+    uint64_t bits = get_le<uint64_t>(data + 8);
+    size_t word_count = (body - SIDECAR_HEADER_SIZE) / 8;
+    if (word_count != (bits + 63) / 64) {
+        return std::nullopt;
+    }
+
+    CompletionSidecar sidecar;
+    sidecar.journal_bytes = get_le<uint64_t>(data + 16);
+    sidecar.fingerprint = get_le<uint64_t>(data + 24);
+    sidecar.valid = get_le<uint64_t>(data + 32);
+    sidecar.invalid = get_le<uint64_t>(data + 40);
+    sidecar.error = get_le<uint64_t>(data + 48);
+
+    std::vector<uint64_t> words(word_count);
+    for (size_t i = 0; i < word_count; ++i) {
+        words[i] = get_le<uint64_t>(data + SIDECAR_HEADER_SIZE + i * 8);
+    }
+    sidecar.bitmap = CompletionBitmap::from_words(bits, std::move(words));
+    return sidecar;
+}
+
+// 双缓冲写入：检测线程只把记录编码进前台缓冲，后台线程按间隔或批量阈值交换缓冲后
+// 写入并同步，磁盘I/O期间不持有前台缓冲的锁，检测线程不会因保存进度而等待
+class ProgressJournal::Impl {
+public:
+    ~Impl() {
+        close();
+    }
+
+    bool open_file(const std::string& path, const char* mode, JournalOptions options) {
+        close();
+        file_ = std::fopen(path.c_str(), mode);
+        if (!file_) {
+            std::cerr << "无法打开进度日志: " << path << std::endl;
+            return false;
+        }
+        path_ = path;
+        options_ = options;
+        live_ = CompletionBitmap();
+        superseded_ = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accepting_ = true;
+            stopping_ = false;
+        }
+        writer_ = std::thread([this]() { writer_loop(); });
+        return true;
+    }
+
+    void append(const JournalRecord& record) {
+        bool batch_full = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!accepting_) {
+                return;
+            }
+
+            size_t offset = front_.size();
+            front_.resize(offset + RECORD_SIZE);
+            encode_record(record, front_.data() + offset);
+            batch_full = front_.size() >= options_.group_commit_records * RECORD_SIZE;
+        }
+
+        // 攒够一批时提前唤醒后台线程，否则等到下一个提交间隔
+        if (batch_full) {
+            wake_.notify_one();
+        }
+    }
+
+    bool commit() {
+        return flush();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accepting_ = false;
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        if (file_) {
+            flush_locked();
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    bool write_raw(const std::string& data) {
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        return file_ && std::fwrite(data.data(), 1, data.size(), file_) == data.size() &&
+               sync_file(file_);
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return accepting_;
+    }
+
+    // 打开已有日志时登记其中已有的序号和被覆盖的记录数，供后台压缩判断
+    void track_existing(const JournalReplay& state) {
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        for (const auto& record : state.records) {
+            mark_live(record.ordinal);
+        }
+        superseded_ = state.raw_records - state.records.size();
+    }
+
+    std::string path_;
+
+private:
+    void writer_loop() {
+        auto last_flush = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, options_.group_commit_interval, [this]() {
+                return stopping_ || front_.size() >= options_.group_commit_records * RECORD_SIZE;
+            });
+
+            // 批量阈值提前触发时，距上次同步不足最短间隔就先等够，限制fsync频率
+            auto earliest = last_flush + options_.min_sync_interval;
+            if (!stopping_ && std::chrono::steady_clock::now() < earliest) {
+                wake_.wait_until(lock, earliest, [this]() { return stopping_; });
+            }
+            if (stopping_) {
+                break;
+            }
+
+            lock.unlock();
+            flush();
+            last_flush = std::chrono::steady_clock::now();
+            lock.lock();
+        }
+    }
+
+    bool flush() {
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        return flush_locked();
+    }
+
+    // 交换前后台缓冲后写入后台缓冲，调用方持有 io_mutex_
+    bool flush_locked() {
+        if (!file_) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            back_.swap(front_);
+        }
+        if (back_.empty()) {
+            return true;
+        }
+
+        bool ok = std::fwrite(back_.data(), 1, back_.size(), file_) == back_.size();
+        ok = ok && (options_.sync ? sync_file(file_) : std::fflush(file_) == 0);
+        if (!ok) {
+            std::cerr << "写入进度日志失败: " << path_ << std::endl;
+        }
+        for (size_t offset = 0; offset < back_.size(); offset += RECORD_SIZE) {
+            if (!mark_live(get_le<uint32_t>(back_.data() + offset))) {
+                ++superseded_;
+            }
+        }
+        back_.clear();
+
+        if (ok && options_.compact_superseded_records > 0 &&
+            superseded_ >= options_.compact_superseded_records) {
+            ok = compact_locked();
+        }
+        return ok;
+    }
+
+    // 记录序号已有记录，原来没有时返回true
+    bool mark_live(uint32_t ordinal) {
+        if (ordinal >= live_.size()) {
+            live_.resize(std::max<size_t>(ordinal + 1, live_.size() * 2));
+        }
+        return live_.set(ordinal);
+    }
+
+    // 关闭文件压缩为快照后重新打开继续追加，调用方持有 io_mutex_
+    // 压缩期间新完成的记录留在前台缓冲中，等下一次提交
+    bool compact_locked() {
+        std::fclose(file_);
+        file_ = nullptr;
+        bool ok = ProgressJournal::compact(path_);
+        if (ok) {
+            superseded_ = 0;
+        }
+
+        file_ = std::fopen(path_.c_str(), "ab");
+        if (!file_) {
+            std::cerr << "无法打开进度日志: " << path_ << std::endl;
+            return false;
+        }
+        return ok;
+    }
+
+    JournalOptions options_;
+
+    // 前台缓冲及后台线程状态，由 mutex_ 保护
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<char> front_;
+    bool accepting_ = false;
+    bool stopping_ = false;
+
+    // 文件和后台缓冲，由 io_mutex_ 保护
+    std::mutex io_mutex_;
+    std::FILE* file_ = nullptr;
+    std::vector<char> back_;
+    CompletionBitmap live_;    // 日志中已有记录的序号
+    size_t superseded_ = 0;    // 日志中被同一序号的后续记录覆盖的记录数
+
+    std::thread writer_;
+};
+
+ProgressJournal::ProgressJournal() : pImpl_(std::make_unique<Impl>()) {}
+
+ProgressJournal::~ProgressJournal() = default;
+
+bool ProgressJournal::create(const std::string& path, const JournalHeader& header,
+                             JournalOptions options) {
+    if (!pImpl_->open_file(path, "wb", options)) {
+        return false;
+    }
+    if (!pImpl_->write_raw(encode_header(header))) {
+        std::cerr << "写入进度日志头失败: " << path << std::endl;
+        pImpl_->close();
+        return false;
+    }
+
+    // 同步目录，崩溃后新建的日志文件本身也要存在
+    auto parent_path = std::filesystem::path(path).parent_path();
+    FileUtils::sync_directory(parent_path.empty() ? "." : parent_path.string());
+    return true;
+}
+
+bool ProgressJournal::open(const std::string& path, JournalOptions options) {
+    auto state = replay(path, false);
+    if (!state) {
+        return false;
+    }
+
+    // 截掉崩溃时写了一半的记录，新记录接在最后一条完整记录之后
+    if (state->torn_bytes > 0) {
+        std::error_code ec;
+        std::filesystem::resize_file(path, state->valid_bytes, ec);
+        if (ec) {
+            std::cerr << "截断进度日志失败: " << path << ": " << ec.message() << std::endl;
+            return false;
+        }
+    }
+    if (!pImpl_->open_file(path, "ab", options)) {
+        return false;
+    }
+    pImpl_->track_existing(*state);
+    return true;
+}
+
+void ProgressJournal::append(const JournalRecord& record) {
+    pImpl_->append(record);
+}
+
+bool ProgressJournal::commit() {
+    return pImpl_->commit();
+}
+
+void ProgressJournal::close() {
+    pImpl_->close();
+}
+
+bool ProgressJournal::is_open() const {
+    return pImpl_->is_open();
+}
+
+const std::string& ProgressJournal::path() const {
+    return pImpl_->path_;
+}
+
+std::optional<JournalReplay> ProgressJournal::replay(const std::string& path, bool load_keys,
+                                                     size_t from_offset) {
+    MappedFile mapped;
+    if (!mapped.open(path)) {
+        return std::nullopt;
+    }
+    std::string_view data = mapped.view();
+
+    JournalReplay state;
+    size_t keys_bytes = 0;
+    size_t offset = decode_header(data, state.header, keys_bytes);
+    if (offset == 0 || data.size() - offset < keys_bytes) {
+        std::cerr << "进度日志头损坏: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    if (load_keys) {
+        auto& keys = state.header.keys;
+        if (state.header.keys_external) {
+            // 只记录了输入路径，重新读取并确认内容没有变化
+            keys = FileUtils::load_api_keys(state.header.input_file);
+        } else {
+            std::string_view keys_block = data.substr(offset, keys_bytes);
+            keys.reserve(state.header.key_count);
+            size_t pos = 0;
+            while (pos < keys_block.size()) {
+                size_t end = keys_block.find('\n', pos);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                keys.emplace_back(keys_block.substr(pos, end - pos));
+                pos = end + 1;
+            }
+        }
+
+        if (keys.size() != state.header.key_count || fingerprint(keys) != state.header.fingerprint) {
+            if (state.header.keys_external) {
+                std::cerr << "输入文件不存在或内容已变化，无法恢复: " << state.header.input_file << std::endl;
+            } else {
+                std::cerr << "进度日志中的key列表损坏: " << path << std::endl;
+            }
+            return std::nullopt;
+        }
+    }
+    offset += keys_bytes;
+    state.records_offset = offset;
+
+    // 从指定记录处继续，偏移不在记录边界上时从头回放
+    if (from_offset > offset && from_offset <= data.size() &&
+        (from_offset - offset) % RECORD_SIZE == 0) {
+        offset = from_offset;
+    }
+    state.replayed_from = offset;
+
+    // 逐条读取记录，遇到不完整或校验失败的记录即停止
+    std::vector<JournalRecord> records;
+    records.reserve((data.size() - offset) / RECORD_SIZE);
+    int64_t last_checked_ms = to_millis(state.header.created_at);
+    while (data.size() - offset >= RECORD_SIZE) {
+        JournalRecord record;
+        if (!decode_record(data.data() + offset, record) || record.ordinal >= state.header.key_count) {
+            break;
+        }
+        last_checked_ms = std::max(last_checked_ms, record.checked_at_ms);
+        records.push_back(record);
+        offset += RECORD_SIZE;
+    }
+
+    state.raw_records = records.size();
+    state.valid_bytes = offset;
+    state.torn_bytes = data.size() - offset;
+    state.last_checked_at = from_millis(last_checked_ms);
+
+    // 同一序号以最后写入的为准
+    std::stable_sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.ordinal < b.ordinal;
+    });
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i + 1 < records.size() && records[i + 1].ordinal == records[i].ordinal) {
+            continue;
+        }
+        state.records.push_back(records[i]);
+    }
+
+    return state;
+}
+
+std::optional<JournalHeader> ProgressJournal::read_header(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(path, ec);
+
+    std::string data(FIXED_HEADER_SIZE, '\0');
+    size_t n = std::fread(data.data(), 1, FIXED_HEADER_SIZE, file);
+    std::optional<JournalHeader> result;
+    if (!ec && n == FIXED_HEADER_SIZE && std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0) {
+        // 长度字段来自文件本身，损坏或不相关的文件可能声称有几GB，先与文件大小比较再分配
+        uint32_t meta_len = get_le<uint32_t>(data.data() + 12);
+        if (file_size >= FIXED_HEADER_SIZE && meta_len <= file_size - FIXED_HEADER_SIZE) {
+            data.resize(FIXED_HEADER_SIZE + meta_len);
+            if (std::fread(data.data() + FIXED_HEADER_SIZE, 1, meta_len, file) == meta_len) {
+                JournalHeader header;
+                size_t keys_bytes = 0;
+                if (decode_header(data, header, keys_bytes) != 0) {
+                    result = std::move(header);
+                }
+            }
+        }
+    }
+
+    std::fclose(file);
+    return result;
+}
+
+bool ProgressJournal::compact(const std::string& path) {
+    auto state = replay(path, false);
+    if (!state) {
+        return false;
+    }
+
+    // 没有残缺和重复记录时无需重写
+    if (state->torn_bytes == 0 && state->raw_records == state->records.size()) {
+        return true;
+    }
+
+    // 日志头原样复制，其后写入去重后的记录
+    std::string snapshot;
+    {
+        MappedFile mapped;
+        if (!mapped.open(path) || mapped.size() < state->records_offset) {
+            return false;
+        }
+        snapshot.assign(mapped.data(), state->records_offset);
+    }
+    size_t offset = snapshot.size();
+    snapshot.resize(offset + state->records.size() * RECORD_SIZE);
+    for (const auto& record : state->records) {
+        encode_record(record, snapshot.data() + offset);
+        offset += RECORD_SIZE;
+    }
+
+    // 先完整写入并同步临时文件，再原子替换，任何时刻磁盘上都有一份完整的日志
+    if (!FileUtils::write_file_atomic(path, snapshot)) {
+        std::cerr << "写入进度快照失败: " << path << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(sidecar_path(path), ec);
+    return true;
+}
+
+bool ProgressJournal::write_snapshot(const std::string& path, const JournalHeader& header,
+                                     const std::vector<JournalRecord>& records) {
+    std::string snapshot = encode_header(header);
+    size_t offset = snapshot.size();
+    snapshot.resize(offset + records.size() * RECORD_SIZE);
+    for (const auto& record : records) {
+        encode_record(record, snapshot.data() + offset);
+        offset += RECORD_SIZE;
+    }
+
+    if (!FileUtils::write_file_atomic(path, snapshot)) {
+        std::cerr << "写入进度快照失败: " << path << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(sidecar_path(path), ec);
+    return true;
+}
+
+std::string ProgressJournal::sidecar_path(const std::string& path) {
+    return path + ".bitmap";
+}
+
+uint64_t ProgressJournal::fingerprint(const std::vector<std::string>& keys) {
+    uint64_t hash = FNV_OFFSET;
+    for (const auto& key : keys) {
+        hash = fingerprint_append(hash, key);
+    }
+    return hash;
+}
+
+std::optional<uint64_t> ProgressJournal::fingerprint_file(const std::string& input_file,
+                                                          uint64_t& key_count) {
+    if (!FileUtils::file_exists(input_file)) {
+        return std::nullopt;
+    }
+
+    uint64_t hash = FNV_OFFSET;
+    std::string error_message;
+    key_count = FileUtils::for_each_api_key(input_file, [&hash](std::string key) {
+        hash = fingerprint_append(hash, key);
+        return true;
+    }, &error_message);
+    // 截断的压缩文件只能读出一部分key，不能当作完整的输入
+    if (!error_message.empty()) {
+        return std::nullopt;
+    }
+    return hash;
+}
+
+bool ProgressJournal::is_journal(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[sizeof(MAGIC)] = {};
+    bool ok = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+              std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+} // namespace api_checker
@@ -0,0 +1,384 @@
+#include "result_store.h"
+#include "binary_io.h"
+#include "progress_journal.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace api_checker {
+
+namespace {
+
+// 文件头：0 魔数[8]  8 版本u32  12 保留u32
+constexpr char MAGIC[8] = {'A', 'P', 'C', 'R', 'S', 'L', 'T', '\x01'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t FILE_HEADER_SIZE = 16;
+
+// 块头：0 行数u32  4 key数据长度u32  8 CRC32(块内数据)u32  12 保留u32
+// 块内数据按8字节对齐，列的偏移（n为行数）：
+//   0 检测时间i64  8n 耗时u32  12n key结束偏移u32  16n HTTP状态码u16  18n 状态u8  19n 消息类别u8  20n key数据
+constexpr size_t BLOCK_HEADER_SIZE = 16;
+constexpr size_t ROW_FIXED_BYTES = 20;
+
+// 块数据的校验状态
+enum BlockState : uint8_t {
+    BLOCK_UNCHECKED = 0,
+    BLOCK_INTACT = 1,
+    BLOCK_CORRUPT = 2
+};
+
+size_t block_body_size(uint32_t rows, uint32_t blob_bytes) {
+    size_t size = static_cast<size_t>(rows) * ROW_FIXED_BYTES + blob_bytes;
+    return (size + 7) & ~size_t{7};
+}
+
+} // namespace
+
+class ResultStoreWriter::Impl {
+public:
+    ~Impl() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+            std::cerr << "无法创建结果文件: " << path << std::endl;
+            return false;
+        }
+        path_ = path;
+
+        char header[FILE_HEADER_SIZE] = {};
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        put_le<uint32_t>(header + 8, VERSION);
+        if (std::fwrite(header, 1, sizeof(header), file_) != sizeof(header)) {
+            std::cerr << "写入结果文件失败: " << path << std::endl;
+            close();
+            return false;
+        }
+        rows_ = 0;
+        return true;
+    }
+
+    void append(const KeyResult& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_) {
+            return;
+        }
+
+        auto record = JournalRecord::from_result(0, result);
+        checked_at_.push_back(record.checked_at_ms);
+        response_ms_.push_back(record.response_ms);
+        http_status_.push_back(record.http_status);
+        status_.push_back(static_cast<uint8_t>(record.status));
+        message_code_.push_back(static_cast<uint8_t>(record.message_code));
+        blob_.append(result.key);
+        key_end_.push_back(static_cast<uint32_t>(blob_.size()));
+        ++rows_;
+
+        if (status_.size() >= ROWS_PER_BLOCK) {
+            write_block_locked();
+        }
+    }
+
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return write_block_locked() && file_ && std::fflush(file_) == 0;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_) {
+            write_block_locked();
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return file_ != nullptr;
+    }
+
+    size_t rows() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rows_;
+    }
+
+private:
+    bool write_block_locked() {
+        if (!file_ || status_.empty()) {
+            return file_ != nullptr;
+        }
+
+        auto rows = static_cast<uint32_t>(status_.size());
+        auto blob_bytes = static_cast<uint32_t>(blob_.size());
+        size_t body_size = block_body_size(rows, blob_bytes);
+        block_.assign(BLOCK_HEADER_SIZE + body_size, '\0');
+
+        char* body = block_.data() + BLOCK_HEADER_SIZE;
+        for (uint32_t i = 0; i < rows; ++i) {
+            put_le<int64_t>(body + i * 8, checked_at_[i]);
+            put_le<uint32_t>(body + rows * 8 + i * 4, response_ms_[i]);
+            put_le<uint32_t>(body + rows * 12 + i * 4, key_end_[i]);
+            put_le<uint16_t>(body + rows * 16 + i * 2, http_status_[i]);
+            body[rows * 18 + i] = static_cast<char>(status_[i]);
+            body[rows * 19 + i] = static_cast<char>(message_code_[i]);
+        }
+        std::memcpy(body + rows * ROW_FIXED_BYTES, blob_.data(), blob_.size());
+
+        put_le<uint32_t>(block_.data(), rows);
+        put_le<uint32_t>(block_.data() + 4, blob_bytes);
+        put_le<uint32_t>(block_.data() + 8, crc32(body, body_size));
+
+        checked_at_.clear();
+        response_ms_.clear();
+        key_end_.clear();
+        http_status_.clear();
+        status_.clear();
+        message_code_.clear();
+        blob_.clear();
+
+        if (std::fwrite(block_.data(), 1, block_.size(), file_) != block_.size()) {
+            std::cerr << "写入结果文件失败: " << path_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    size_t rows_ = 0;
+
+    // 当前块的各列
+    std::vector<int64_t> checked_at_;
+    std::vector<uint32_t> response_ms_;
+    std::vector<uint32_t> key_end_;
+    std::vector<uint16_t> http_status_;
+    std::vector<uint8_t> status_;
+    std::vector<uint8_t> message_code_;
+    std::string blob_;
+    std::vector<char> block_;
+
+    mutable std::mutex mutex_;
+};
+
+ResultStoreWriter::ResultStoreWriter() : pImpl_(std::make_unique<Impl>()) {}
+
+ResultStoreWriter::~ResultStoreWriter() = default;
+
+bool ResultStoreWriter::open(const std::string& path) {
+    return pImpl_->open(path);
+}
+
+void ResultStoreWriter::append(const KeyResult& result) {
+    pImpl_->append(result);
+}
+
+bool ResultStoreWriter::flush() {
+    return pImpl_->flush();
+}
+
+void ResultStoreWriter::close() {
+    pImpl_->close();
+}
+
+bool ResultStoreWriter::is_open() const {
+    return pImpl_->is_open();
+}
+
+size_t ResultStoreWriter::rows() const {
+    return pImpl_->rows();
+}
+
+bool ResultStoreReader::open(const std::string& path) {
+    close();
+    if (!mapped_.open(path)) {
+        return false;
+    }
+
+    const char* data = mapped_.data();
+    size_t size = mapped_.size();
+    if (size < FILE_HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        get_le<uint32_t>(data + 8) != VERSION) {
+        std::cerr << "不是有效的结果文件: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // 只读取块头建立索引，不触及块数据；写入中途崩溃留下的残缺块到此为止
+    size_t offset = FILE_HEADER_SIZE;
+    while (offset + BLOCK_HEADER_SIZE <= size) {
+        uint32_t rows = get_le<uint32_t>(data + offset);
+        uint32_t blob_bytes = get_le<uint32_t>(data + offset + 4);
+        size_t body_size = block_body_size(rows, blob_bytes);
+        if (rows == 0 || body_size > size - offset - BLOCK_HEADER_SIZE) {
+            break;
+        }
+
+        uint32_t crc = get_le<uint32_t>(data + offset + 8);
+        blocks_.push_back({data + offset + BLOCK_HEADER_SIZE, rows_, rows, blob_bytes, crc});
+        rows_ += rows;
+        offset += BLOCK_HEADER_SIZE + body_size;
+    }
+    torn_bytes_ = size - offset;
+
+    block_state_ = std::make_unique<std::atomic<uint8_t>[]>(blocks_.size());
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        block_state_[i].store(BLOCK_UNCHECKED, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ResultStoreReader::close() {
+    mapped_.close();
+    blocks_.clear();
+    block_state_.reset();
+    rows_ = 0;
+    torn_bytes_ = 0;
+}
+
+bool ResultStoreReader::verify(size_t block) const {
+    uint8_t state = block_state_[block].load(std::memory_order_acquire);
+    if (state == BLOCK_UNCHECKED) {
+        // 多个线程同时校验同一块时结果相同，无需加锁
+        const Block& b = blocks_[block];
+        bool ok = crc32(b.body, block_body_size(b.rows, b.blob_bytes)) == b.crc;
+        state = ok ? BLOCK_INTACT : BLOCK_CORRUPT;
+        if (block_state_[block].exchange(state, std::memory_order_acq_rel) == BLOCK_UNCHECKED && !ok) {
+            std::cerr << "结果文件数据块校验失败，第 " << b.first_row + 1 << " 至 "
+                      << b.first_row + b.rows << " 行已忽略" << std::endl;
+        }
+    }
+    return state == BLOCK_INTACT;
+}
+
+const ResultStoreReader::Block* ResultStoreReader::locate(size_t row, uint32_t& index) const {
+    // 除最后一块和中途flush的块外每块都是满的，先按满块直接定位，不对时再二分查找
+    size_t block = row / ResultStoreWriter::ROWS_PER_BLOCK;
+    if (!(block < blocks_.size() && blocks_[block].first_row <= row &&
+          row - blocks_[block].first_row < blocks_[block].rows)) {
+        auto it = std::upper_bound(blocks_.begin(), blocks_.end(), row,
+            [](size_t value, const Block& b) { return value < b.first_row; });
+        block = static_cast<size_t>(it - blocks_.begin()) - 1;
+    }
+
+    index = static_cast<uint32_t>(row - blocks_[block].first_row);
+    return verify(block) ? &blocks_[block] : nullptr;
+}
+
+bool ResultStoreReader::intact(size_t row) const {
+    uint32_t i = 0;
+    return locate(row, i) != nullptr;
+}
+
+std::string_view ResultStoreReader::key(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    if (!block) {
+        return {};
+    }
+    const char* ends = block->body + block->rows * 12;
+    uint32_t begin = i == 0 ? 0 : get_le<uint32_t>(ends + (i - 1) * 4);
+    uint32_t end = get_le<uint32_t>(ends + i * 4);
+    return {block->body + block->rows * ROW_FIXED_BYTES + begin, end - begin};
+}
+
+KeyStatus ResultStoreReader::status(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    return block ? static_cast<KeyStatus>(block->body[block->rows * 18 + i]) : KeyStatus::Pending;
+}
+
+MessageCode ResultStoreReader::message_code(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    return block ? static_cast<MessageCode>(block->body[block->rows * 19 + i]) : MessageCode::None;
+}
+
+uint16_t ResultStoreReader::http_status(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    return block ? get_le<uint16_t>(block->body + block->rows * 16 + i * 2) : 0;
+}
+
+std::optional<std::chrono::milliseconds> ResultStoreReader::response_time(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    if (!block) {
+        return std::nullopt;
+    }
+    uint32_t ms = get_le<uint32_t>(block->body + block->rows * 8 + i * 4);
+    if (ms == JournalRecord::NO_RESPONSE_TIME) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(ms);
+}
+
+std::chrono::system_clock::time_point ResultStoreReader::checked_at(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+    auto ms = std::chrono::milliseconds(block ? get_le<int64_t>(block->body + i * 8) : 0);
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(ms));
+}
+
+KeyResult ResultStoreReader::result(size_t row) const {
+    uint32_t i = 0;
+    const Block* block = locate(row, i);
+
+    JournalRecord record;
+    record.ordinal = static_cast<uint32_t>(row);
+    if (block) {
+        record.checked_at_ms = get_le<int64_t>(block->body + i * 8);
+        record.response_ms = get_le<uint32_t>(block->body + block->rows * 8 + i * 4);
+        record.http_status = get_le<uint16_t>(block->body + block->rows * 16 + i * 2);
+        record.status = static_cast<KeyStatus>(block->body[block->rows * 18 + i]);
+        record.message_code = static_cast<MessageCode>(block->body[block->rows * 19 + i]);
+    }
+    return record.to_result(std::string(key(row)));
+}
+
+size_t ResultStoreReader::count(KeyStatus status) const {
+    size_t total = 0;
+    for (size_t b = 0; b < blocks_.size(); ++b) {
+        const Block& block = blocks_[b];
+        if (!verify(b)) {
+            // 与 rows_with_status 一致，校验失败的块按Pending状态计
+            total += status == KeyStatus::Pending ? block.rows : 0;
+            continue;
+        }
+        const char* column = block.body + block.rows * 18;
+        total += static_cast<size_t>(
+            std::count(column, column + block.rows, static_cast<char>(status)));
+    }
+    return total;
+}
+
+std::vector<uint32_t> ResultStoreReader::rows_with_status(KeyStatus status) const {
+    std::vector<uint32_t> rows;
+    for (size_t b = 0; b < blocks_.size(); ++b) {
+        const Block& block = blocks_[b];
+        if (!verify(b)) {
+            // 校验失败的块按Pending状态计
+            if (status == KeyStatus::Pending) {
+                for (uint32_t i = 0; i < block.rows; ++i) {
+                    rows.push_back(static_cast<uint32_t>(block.first_row + i));
+                }
+            }
+            continue;
+        }
+        const char* column = block.body + block.rows * 18;
+        for (uint32_t i = 0; i < block.rows; ++i) {
+            if (column[i] == static_cast<char>(status)) {
+                rows.push_back(static_cast<uint32_t>(block.first_row + i));
+            }
+        }
+    }
+    return rows;
+}
+
+} // namespace api_checker
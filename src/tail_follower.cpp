@@ -0,0 +1,575 @@
+#include "tail_follower.h"
+#include "file_utils.h"
+#include "key_scanner.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace api_checker {
+
+namespace {
+
+// 等待期间检查停止请求的最长间隔
+constexpr std::chrono::milliseconds STOP_CHECK_INTERVAL{200};
+
+// 已打开文件的inode；Windows上没有inode，轮转只能通过截断检测
+uint64_t file_identity(std::FILE* file) {
+#ifdef _WIN32
+    (void)file;
+    return 0;
+#else
+    struct stat st {};
+    return ::fstat(fileno(file), &st) == 0 ? static_cast<uint64_t>(st.st_ino) : 0;
+#endif
+}
+
+std::optional<std::pair<uint64_t, uint64_t>> path_identity_and_size(const std::string& path) {
+#ifdef _WIN32
+    struct _stat64 st {};
+    if (::_stat64(path.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+    return std::make_pair(uint64_t{0}, static_cast<uint64_t>(st.st_size));
+#else
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+    return std::make_pair(static_cast<uint64_t>(st.st_ino), static_cast<uint64_t>(st.st_size));
+#endif
+}
+
+bool seek_to(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return ::_fseeki64(file, static_cast<int64_t>(offset), SEEK_SET) == 0;
+#else
+    return ::fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+// 已确认偏移的推进点：某个key所在行之后，或一段没有待确认key的已读内容之后
+struct Watermark {
+    uint64_t ticket = 0;
+    uint64_t offset = 0;
+    size_t line = 1;
+    bool done = false;
+};
+
+struct SavedOffset {
+    uint64_t inode = 0;
+    uint64_t offset = 0;
+    size_t line = 1;
+};
+
+struct FileState {
+    std::FILE* file = nullptr;
+    uint64_t inode = 0;
+
+    uint64_t read_offset = 0;
+    size_t read_line = 1;  // read_offset处的行号
+
+    uint64_t committed_offset = 0;
+    size_t committed_line = 1;
+
+    std::deque<Watermark> pending;
+};
+
+} // namespace
+
+class TailFollower::Impl {
+public:
+    Impl(const std::string& path, TailOptions options)
+        : root_(std::filesystem::absolute(path).lexically_normal().string()),
+          options_(std::move(options)) {}
+
+    ~Impl() {
+        // 析构时所有确认都已完成，保存最终的偏移
+        save_offsets();
+
+        for (auto& [path, state] : files_) {
+            if (state.file) {
+                std::fclose(state.file);
+            }
+        }
+#ifdef __linux__
+        if (inotify_fd_ >= 0) {
+            ::close(inotify_fd_);
+        }
+#endif
+    }
+
+    bool run(const std::function<bool(TailKey)>& on_key, const std::function<bool()>& should_stop) {
+        std::error_code ec;
+        if (!std::filesystem::exists(root_, ec)) {
+            std::cerr << "跟随路径不存在: " << root_ << std::endl;
+            return false;
+        }
+        root_is_directory_ = std::filesystem::is_directory(root_, ec);
+
+        load_offsets();
+        setup_watch();
+
+        auto stop_requested = [&]() {
+            return stopped_.load() || (should_stop && should_stop());
+        };
+
+        while (!stop_requested()) {
+            auto paths = list_files();
+            bool keep_going = true;
+            for (const auto& path : paths) {
+                if (!follow_file(path, on_key)) {
+                    keep_going = false;
+                    break;
+                }
+            }
+            if (keep_going && root_is_directory_) {
+                keep_going = close_removed_files(paths, on_key);
+            }
+            if (!keep_going) {
+                stopped_.store(true);
+                break;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_save_ >= options_.save_interval) {
+                save_offsets();
+                last_save_ = now;
+            }
+
+            if (!stop_requested()) {
+                wait_for_change(stop_requested);
+            }
+        }
+
+        save_offsets();
+        return true;
+    }
+
+    void acknowledge(uint64_t ticket) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ticket_files_.find(ticket);
+        if (it == ticket_files_.end()) {
+            return;  // 文件已被截断或轮转，旧的确认直接忽略
+        }
+
+        auto file_it = files_.find(it->second);
+        ticket_files_.erase(it);
+        if (file_it == files_.end()) {
+            return;
+        }
+
+        auto& state = file_it->second;
+        for (auto& mark : state.pending) {
+            if (mark.ticket == ticket) {
+                mark.done = true;
+                break;
+            }
+        }
+        commit(state);
+    }
+
+    void stop() {
+        stopped_.store(true);
+    }
+
+private:
+    // 已确认的推进点从队首依次出队，偏移只会推进到第一个未确认的key之前
+    void commit(FileState& state) {
+        while (!state.pending.empty() && state.pending.front().done) {
+            state.committed_offset = state.pending.front().offset;
+            state.committed_line = state.pending.front().line;
+            state.pending.pop_front();
+            dirty_ = true;
+        }
+    }
+
+    std::vector<std::string> list_files() const {
+        if (!root_is_directory_) {
+            return {root_};
+        }
+
+        std::vector<std::string> paths;
+        std::error_code ec;
+        const auto offsets_path = std::filesystem::absolute(options_.offsets_file, ec).lexically_normal();
+        // 偏移记录文件以临时文件 + 重命名的方式保存，两者都不跟随
+        const auto offsets_temp = std::filesystem::path(offsets_path.string() + ".tmp");
+        for (std::filesystem::directory_iterator it(root_, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec) && it->path() != offsets_path && it->path() != offsets_temp) {
+                paths.push_back(it->path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    // 读取文件新增的完整行，返回false表示on_key要求停止
+    bool follow_file(const std::string& path, const std::function<bool(TailKey)>& on_key) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = files_.find(path);
+
+        if (it == files_.end() || !it->second.file) {
+            auto identity = path_identity_and_size(path);
+            if (!identity) {
+                return true;  // 文件尚不存在，等待创建
+            }
+            if (it == files_.end()) {
+                it = files_.try_emplace(path).first;
+            }
+            if (!open_file(path, it->second, identity->second)) {
+                return true;
+            }
+        }
+        FileState& state = it->second;
+
+        lock.unlock();
+        if (!read_new_lines(path, state, on_key)) {
+            return false;
+        }
+
+        // 读完之后再检查，避免把读取期间的增长误判为截断
+        auto identity = path_identity_and_size(path);
+        if (!identity) {
+            return true;  // 路径已被移走，保持旧句柄，等待新文件出现
+        }
+
+        if (identity->first != state.inode) {
+            // 轮转：上次读取之后旧文件可能还写入了内容，关闭前再读到末尾
+            if (!read_new_lines(path, state, on_key)) {
+                return false;
+            }
+        }
+
+        lock.lock();
+        if (identity->first != state.inode) {
+            // 改为从头跟随同一路径上的新文件；
+            // 旧文件若以新名字出现在目录中，从已读位置继续而不是重新读取
+            retired_[state.inode] = {state.inode, state.read_offset, state.read_line};
+            std::fclose(state.file);
+            state = FileState{};
+            dirty_ = true;
+            lock.unlock();
+            return follow_file(path, on_key);
+        }
+
+        if (identity->second < state.read_offset) {
+            // 截断：之前的待确认key不再对应文件内容，从头重新读取
+            for (const auto& mark : state.pending) {
+                ticket_files_.erase(mark.ticket);
+            }
+            state.pending.clear();
+            state.read_offset = state.committed_offset = 0;
+            state.read_line = state.committed_line = 1;
+            dirty_ = true;
+            lock.unlock();
+            return read_new_lines(path, state, on_key);
+        }
+
+        return true;
+    }
+
+    // 打开文件并确定起始偏移（调用方持有锁）
+    bool open_file(const std::string& path, FileState& state, uint64_t size) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        uint64_t inode = file_identity(file);
+
+        // 目录中的文件被改名时（如 app.log -> app.log.1），沿用原路径的读取状态
+        if (inode != 0) {
+            for (auto other = files_.begin(); other != files_.end(); ++other) {
+                if (other->first == path || !other->second.file || other->second.inode != inode) {
+                    continue;
+                }
+                auto other_identity = path_identity_and_size(other->first);
+                if (other_identity && other_identity->first == inode) {
+                    continue;  // 同一文件的硬链接，两条路径都还在
+                }
+
+                std::fclose(file);
+                state = std::move(other->second);
+                for (const auto& mark : state.pending) {
+                    if (mark.ticket != 0) {
+                        ticket_files_[mark.ticket] = path;
+                    }
+                }
+                files_.erase(other);
+                dirty_ = true;
+                return true;
+            }
+        }
+
+        state.file = file;
+        state.inode = inode;
+
+        // 只有同一个文件（inode一致且没有变短）才从上次确认的偏移继续
+        auto saved = saved_.find(path);
+        auto retired = retired_.find(inode);
+        if (saved != saved_.end() && saved->second.inode == inode && saved->second.offset <= size) {
+            state.read_offset = state.committed_offset = saved->second.offset;
+            state.read_line = state.committed_line = saved->second.line;
+        } else if (inode != 0 && retired != retired_.end() && retired->second.offset <= size) {
+            state.read_offset = state.committed_offset = retired->second.offset;
+            state.read_line = state.committed_line = retired->second.line;
+            retired_.erase(retired);
+            dirty_ = true;
+        }
+        return true;
+    }
+
+    // 目录模式下清理已不在目录中的文件：读完剩余内容后关闭句柄
+    bool close_removed_files(const std::vector<std::string>& listed,
+                             const std::function<bool(TailKey)>& on_key) {
+        std::vector<std::string> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [path, state] : files_) {
+                if (state.file && !std::binary_search(listed.begin(), listed.end(), path)) {
+                    removed.push_back(path);
+                }
+            }
+        }
+
+        for (const auto& path : removed) {
+            FileState& state = files_.at(path);
+            if (!read_new_lines(path, state, on_key)) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            saved_[path] = {state.inode, state.committed_offset, state.committed_line};
+            std::fclose(state.file);
+            files_.erase(path);
+            dirty_ = true;
+        }
+        return true;
+    }
+
+    bool read_new_lines(const std::string& path, FileState& state,
+                        const std::function<bool(TailKey)>& on_key) {
+        std::vector<DetectedKey> detected;
+
+        while (true) {
+            if (!seek_to(state.file, state.read_offset)) {
+                return true;
+            }
+            std::clearerr(state.file);
+
+            size_t filled = 0;
+            bool eof = false;
+            while (!eof) {
+                if (buffer_.size() < filled + options_.read_chunk) {
+                    buffer_.resize(filled + options_.read_chunk);
+                }
+                size_t n = std::fread(buffer_.data() + filled, 1, options_.read_chunk, state.file);
+                eof = n < options_.read_chunk;
+
+                // 超长行：新读入的部分还没有换行时继续读
+                std::string_view chunk(buffer_.data() + filled, n);
+                filled += n;
+                if (chunk.find('\n') != std::string_view::npos) {
+                    break;
+                }
+            }
+
+            std::string_view view(buffer_.data(), filled);
+            size_t complete = KeyScanner::complete_lines_length(view);
+            if (complete == 0) {
+                return true;  // 没有新的完整行
+            }
+            view = view.substr(0, complete);
+
+            detected.clear();
+            KeyScanner::instance().find(view, detected);
+
+            // 先在锁内登记所有推进点，再在锁外回调，避免通道背压时阻塞确认
+            std::vector<TailKey> keys;
+            keys.reserve(detected.size());
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                size_t line = state.read_line;
+                size_t counted_to = 0;
+                for (auto& item : detected) {
+                    line += static_cast<size_t>(std::count(view.begin() + counted_to,
+                                                           view.begin() + item.offset, '\n'));
+                    counted_to = item.offset;
+                    size_t line_end = view.find('\n', item.offset) + 1;
+
+                    uint64_t ticket = next_ticket_++;
+                    ticket_files_[ticket] = path;
+                    state.pending.push_back({ticket, state.read_offset + line_end, line + 1, false});
+                    keys.push_back({std::move(item.key), path + ":" + std::to_string(line), ticket});
+                }
+
+                state.read_line += static_cast<size_t>(std::count(view.begin(), view.end(), '\n'));
+                state.read_offset += complete;
+                state.pending.push_back({0, state.read_offset, state.read_line, true});
+                commit(state);
+            }
+
+            for (auto& key : keys) {
+                if (!on_key(std::move(key))) {
+                    return false;
+                }
+            }
+
+            if (eof) {
+                return true;  // 已读到文件末尾
+            }
+        }
+    }
+
+    void load_offsets() {
+        std::ifstream file(options_.offsets_file);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            SavedOffset saved;
+            std::string path;
+            if (fields >> saved.inode >> saved.offset >> saved.line && fields.get() == '\t' &&
+                std::getline(fields, path) && !path.empty()) {
+                saved_[path] = saved;
+            }
+        }
+    }
+
+    void save_offsets() {
+        std::ostringstream ss;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!dirty_) {
+                return;
+            }
+            dirty_ = false;
+
+            for (const auto& [path, state] : files_) {
+                if (state.file) {
+                    saved_[path] = {state.inode, state.committed_offset, state.committed_line};
+                }
+            }
+        }
+
+        for (const auto& [path, saved] : saved_) {
+            // 丢弃已删除文件的记录，避免记录文件无限增长
+            std::error_code ec;
+            if (!std::filesystem::exists(path, ec)) {
+                continue;
+            }
+            ss << saved.inode << '\t' << saved.offset << '\t' << saved.line << '\t' << path << '\n';
+        }
+        FileUtils::write_file_atomic(options_.offsets_file, ss.str());
+    }
+
+    void setup_watch() {
+#ifdef __linux__
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ < 0) {
+            return;
+        }
+
+        // 单个文件也监视其所在目录，才能发现轮转和重新创建
+        std::string dir = root_is_directory_ ? root_
+                                             : std::filesystem::path(root_).parent_path().string();
+        if (::inotify_add_watch(inotify_fd_, dir.c_str(),
+                                IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO) < 0) {
+            ::close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+#endif
+    }
+
+    template <typename StopFn>
+    void wait_for_change(const StopFn& stop_requested) {
+        auto deadline = std::chrono::steady_clock::now() + options_.poll_interval;
+
+        while (!stop_requested()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return;
+            }
+            auto slice = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now),
+                                  STOP_CHECK_INTERVAL);
+
+#ifdef __linux__
+            if (inotify_fd_ >= 0) {
+                pollfd pfd{inotify_fd_, POLLIN, 0};
+                if (::poll(&pfd, 1, static_cast<int>(slice.count())) > 0) {
+                    // 事件只用于唤醒，具体变化通过重新检查文件大小得到
+                    char events[4096];
+                    while (::read(inotify_fd_, events, sizeof(events)) > 0) {
+                    }
+                    return;
+                }
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(slice);
+        }
+    }
+
+    std::string root_;
+    bool root_is_directory_ = false;
+    TailOptions options_;
+
+    std::mutex mutex_;
+    std::map<std::string, FileState> files_;
+    std::unordered_map<uint64_t, std::string> ticket_files_;
+    std::map<std::string, SavedOffset> saved_;
+    std::unordered_map<uint64_t, SavedOffset> retired_;  // 轮转出去的旧文件，按inode记录已读位置
+    uint64_t next_ticket_ = 1;
+    bool dirty_ = false;
+
+    std::vector<char> buffer_;
+    std::atomic<bool> stopped_{false};
+    std::chrono::steady_clock::time_point last_save_{};
+
+#ifdef __linux__
+    int inotify_fd_ = -1;
+#endif
+};
+
+TailFollower::TailFollower(const std::string& path, TailOptions options)
+    : pImpl_(std::make_unique<Impl>(path, std::move(options))) {}
+
+TailFollower::~TailFollower() = default;
+
+bool TailFollower::run(const std::function<bool(TailKey)>& on_key,
+                       const std::function<bool()>& should_stop) {
+    return pImpl_->run(on_key, should_stop);
+}
+
+void TailFollower::acknowledge(uint64_t ticket) {
+    pImpl_->acknowledge(ticket);
+}
+
+void TailFollower::stop() {
+    pImpl_->stop();
+}
+
+const char* TailFollower::watch_backend() {
+#ifdef __linux__
+    return "inotify";
+#else
+    return "polling";
+#endif
+}
+
+} // namespace api_checker
@@ -0,0 +1,96 @@
+#include "check_session.h"
+#include "progress_journal.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace api_checker;
+
+namespace {
+
+JournalHeader make_header(size_t key_count) {
+    JournalHeader header;
+    header.session_id = "session_test";
+    for (size_t i = 0; i < key_count; ++i) {
+        header.keys.push_back("key-" + std::to_string(i));
+    }
+    header.key_count = key_count;
+    header.fingerprint = ProgressJournal::fingerprint(header.keys);
+    header.created_at = std::chrono::system_clock::now();
+    return header;
+}
+
+// 追加一条记录但不主动提交，提交由后台线程按间隔完成
+void append_uncommitted(ProgressJournal& journal, const std::string& path, std::chrono::seconds interval) {
+    JournalOptions options;
+    options.group_commit_interval = interval;
+    options.sync = false;
+    ASSERT_TRUE(journal.create(path, make_header(4), options));
+
+    JournalRecord record;
+    record.ordinal = 1;
+    record.status = KeyStatus::Valid;
+    journal.append(record);
+}
+
+size_t records_on_disk(const std::string& path) {
+    auto state = ProgressJournal::replay(path, false);
+    return state ? state->raw_records : 0;
+}
+
+} // namespace
+
+TEST(SessionOptionsTest, FromConfigReadsSaveInterval) {
+    AppConfig config;
+    config.save_interval_seconds = 7;
+    config.default_concurrent = 12;
+
+    SessionOptions options = SessionOptions::from_config(config);
+    EXPECT_EQ(options.save_interval_secs, 7u);
+    EXPECT_EQ(options.concurrent, 12u);
+}
+
+TEST(SessionOptionsTest, SessionConfiguresCheckerSaveInterval) {
+    AppConfig config;
+    config.save_interval_seconds = 1;
+
+    CheckSession session(SessionOptions::from_config(config));
+    EXPECT_EQ(session.checker().save_interval(), std::chrono::seconds(1));
+
+    SessionOptions defaults;
+    CheckSession default_session(defaults);
+    EXPECT_EQ(default_session.checker().save_interval(), std::chrono::seconds(30));
+}
+
+// 非默认的保存间隔确实改变了进度日志的提交节奏
+TEST(SessionOptionsTest, SaveIntervalControlsJournalCommitCadence) {
+    test::TempDir dir;
+
+    AppConfig config;
+    config.save_interval_seconds = 1;
+    auto short_interval = std::chrono::seconds(SessionOptions::from_config(config).save_interval_secs);
+    auto default_interval = std::chrono::seconds(SessionOptions().save_interval_secs);
+    ASSERT_LT(short_interval, default_interval);
+
+    const auto started = std::chrono::steady_clock::now();
+    ProgressJournal short_journal;
+    ProgressJournal default_journal;
+    append_uncommitted(short_journal, dir.file("short.journal"), short_interval);
+    append_uncommitted(default_journal, dir.file("default.journal"), default_interval);
+
+    // 轮询等待短间隔的日志提交，截止时间远大于间隔，负载高的机器上也不会误报
+    const auto deadline = started + short_interval * 10;
+    while (records_on_disk(dir.file("short.journal")) == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(records_on_disk(dir.file("short.journal")), 1u);
+
+    // 默认间隔还没到，记录仍在缓冲中
+    const size_t default_records = records_on_disk(dir.file("default.journal"));
+    if (std::chrono::steady_clock::now() - started < default_interval) {
+        EXPECT_EQ(default_records, 0u);
+    }
+
+    short_journal.close();
+    default_journal.close();
+}
@@ -0,0 +1,43 @@
+#include "file_utils.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <fstream>
+
+using namespace api_checker;
+
+TEST(FileUtilsTest, LoadApiKeysReadsPlainFile) {
+    test::TempDir dir;
+    const std::string key = "sk-" + std::string(48, 'a');
+    std::ofstream(dir.file("keys.txt")) << "# comment\n" << key << "\nnot a key\n";
+
+    std::string error;
+    auto keys = FileUtils::load_api_keys(dir.file("keys.txt"), &error);
+    EXPECT_TRUE(error.empty());
+    EXPECT_EQ(keys, std::vector<std::string>{key});
+}
+
+TEST(FileUtilsTest, LoadApiKeysReportsMissingFile) {
+    test::TempDir dir;
+
+    testing::internal::CaptureStderr();
+    std::string error;
+    auto keys = FileUtils::load_api_keys(dir.file("missing.txt"), &error);
+    testing::internal::GetCapturedStderr();
+    EXPECT_TRUE(keys.empty());
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(FileUtilsTest, LoadApiKeysReportsCorruptArchive) {
+    test::TempDir dir;
+    // gzip魔数之后是无法解压的数据
+    std::ofstream(dir.file("keys.txt.gz"), std::ios::binary)
+        << std::string("\x1f\x8b\x08\x00", 4) << std::string(64, '\x5a');
+
+    testing::internal::CaptureStderr();
+    std::string error;
+    auto keys = FileUtils::load_api_keys(dir.file("keys.txt.gz"), &error);
+    std::string logged = testing::internal::GetCapturedStderr();
+    EXPECT_TRUE(keys.empty());
+    EXPECT_FALSE(error.empty());
+    EXPECT_NE(logged.find("keys.txt.gz"), std::string::npos);
+}
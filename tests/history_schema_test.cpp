@@ -0,0 +1,355 @@
+#include "history_schema.h"
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using Value = std::variant<std::nullptr_t, int64_t, double, std::string>;
+
+// 在SQLite内存数据库上执行 HistorySchema 的语句
+class MemoryDatabase
+{
+public:
+    MemoryDatabase()
+    {
+        sqlite3_open(":memory:", &m_db);
+        exec("PRAGMA foreign_keys=ON");
+    }
+    ~MemoryDatabase() { sqlite3_close(m_db); }
+
+    MemoryDatabase(const MemoryDatabase &) = delete;
+    MemoryDatabase &operator=(const MemoryDatabase &) = delete;
+
+    bool exec(const std::string &sql)
+    {
+        char *error = nullptr;
+        const bool ok = sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, &error) == SQLITE_OK;
+        if (!ok) {
+            m_lastError = error ? error : "";
+        }
+        sqlite3_free(error);
+        return ok;
+    }
+
+    bool execAll(const std::vector<std::string> &statements)
+    {
+        for (const std::string &statement : statements) {
+            if (!exec(statement)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 绑定参数执行一条语句，返回全部结果行
+    std::vector<std::vector<Value>> query(const std::string &sql, const std::vector<Value> &params = {})
+    {
+        std::vector<std::vector<Value>> rows;
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            ADD_FAILURE() << sqlite3_errmsg(m_db) << "\n" << sql;
+            return rows;
+        }
+        for (size_t i = 0; i < params.size(); ++i) {
+            const int index = static_cast<int>(i) + 1;
+            if (auto integer = std::get_if<int64_t>(&params[i])) {
+                sqlite3_bind_int64(stmt, index, *integer);
+            } else if (auto real = std::get_if<double>(&params[i])) {
+                sqlite3_bind_double(stmt, index, *real);
+            } else if (auto text = std::get_if<std::string>(&params[i])) {
+                sqlite3_bind_text(stmt, index, text->c_str(), -1, SQLITE_TRANSIENT);
+            } else {
+                sqlite3_bind_null(stmt, index);
+            }
+        }
+
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            std::vector<Value> row;
+            for (int column = 0; column < sqlite3_column_count(stmt); ++column) {
+                switch (sqlite3_column_type(stmt, column)) {
+                    case SQLITE_INTEGER:
+                        row.emplace_back(static_cast<int64_t>(sqlite3_column_int64(stmt, column)));
+                        break;
+                    case SQLITE_FLOAT:
+                        row.emplace_back(sqlite3_column_double(stmt, column));
+                        break;
+                    case SQLITE_NULL:
+                        row.emplace_back(nullptr);
+                        break;
+                    default:
+                        row.emplace_back(std::string(
+                            reinterpret_cast<const char *>(sqlite3_column_text(stmt, column))));
+                        break;
+                }
+            }
+            rows.push_back(std::move(row));
+        }
+        if (rc != SQLITE_DONE) {
+            ADD_FAILURE() << sqlite3_errmsg(m_db) << "\n" << sql;
+        }
+        sqlite3_finalize(stmt);
+        return rows;
+    }
+
+    int64_t scalar(const std::string &sql, const std::vector<Value> &params = {})
+    {
+        auto rows = query(sql, params);
+        if (rows.empty() || rows[0].empty() || !std::holds_alternative<int64_t>(rows[0][0])) {
+            return -1;
+        }
+        return std::get<int64_t>(rows[0][0]);
+    }
+
+    int64_t lastInsertId() const { return sqlite3_last_insert_rowid(m_db); }
+    const std::string &lastError() const { return m_lastError; }
+
+    // 与 HistoryDatabase::open 相同的建表顺序；全文索引失败不影响其他表
+    void createSchema()
+    {
+        ASSERT_TRUE(execAll(HistorySchema::tableStatements())) << m_lastError;
+        ASSERT_TRUE(execAll(HistorySchema::aggregateStatements())) << m_lastError;
+        ASSERT_TRUE(execAll(HistorySchema::aggregateBackfillStatements())) << m_lastError;
+        ASSERT_TRUE(execAll(HistorySchema::keyLifecycleStatements())) << m_lastError;
+        m_fullText = execAll(HistorySchema::fullTextStatements());
+    }
+    bool hasFullText() const { return m_fullText; }
+
+    int64_t insertRun(const std::string &startTime, int64_t totalKeys, int64_t validKeys,
+                      const std::string &endpoint = "https://api.example.test/v1")
+    {
+        query(HistorySchema::insertRunSql(), {
+            startTime, startTime, std::string("keys.txt"), totalKeys, validKeys,
+            totalKeys - validKeys, int64_t(0), 1.5, 10.0, endpoint,
+        });
+        return lastInsertId();
+    }
+
+    void insertResult(int64_t runId, int64_t keyFp, const std::string &key, int64_t status,
+                      const std::string &message, int64_t checkedAt = 1000)
+    {
+        query(HistorySchema::resultUpsertSql(), {
+            runId, keyFp, key, status, int64_t(0), int64_t(200), int64_t(50), checkedAt, message,
+        });
+    }
+
+private:
+    sqlite3 *m_db = nullptr;
+    std::string m_lastError;
+    bool m_fullText = false;
+};
+
+// 汇总表的内容应与直接从 history 聚合的结果一致
+void expectAggregatesConsistent(MemoryDatabase &db)
+{
+    EXPECT_EQ(db.query("SELECT run_count, total_keys, valid_keys, invalid_keys, error_keys "
+                       "FROM history_summary"),
+              db.query("SELECT COUNT(*), COALESCE(SUM(total_keys), 0), COALESCE(SUM(valid_keys), 0), "
+                       "COALESCE(SUM(invalid_keys), 0), COALESCE(SUM(error_keys), 0) FROM history"));
+    EXPECT_EQ(db.query("SELECT day, run_count, total_keys, valid_keys FROM history_daily_stats ORDER BY day"),
+              db.query("SELECT substr(start_time, 1, 10), COUNT(*), SUM(total_keys), SUM(valid_keys) "
+                       "FROM history GROUP BY 1 ORDER BY 1"));
+    EXPECT_EQ(db.query("SELECT api_endpoint, run_count, total_keys, valid_keys FROM history_endpoint_stats "
+                       "ORDER BY api_endpoint"),
+              db.query("SELECT api_endpoint, COUNT(*), SUM(total_keys), SUM(valid_keys) "
+                       "FROM history GROUP BY 1 ORDER BY 1"));
+}
+
+std::vector<int64_t> expiredRuns(MemoryDatabase &db, const std::optional<std::string> &minStartTime,
+                                 std::optional<int64_t> maxRuns, std::optional<int64_t> maxResultRows)
+{
+    std::vector<Value> params;
+    if (minStartTime) {
+        params.emplace_back(*minStartTime);
+    }
+    if (maxRuns) {
+        params.emplace_back(*maxRuns);
+    }
+    if (maxResultRows) {
+        params.emplace_back(*maxResultRows);
+    }
+    std::vector<int64_t> ids;
+    for (const auto &row : db.query(HistorySchema::expiredRunsSql(minStartTime.has_value(), maxRuns.has_value(),
+                                                                  maxResultRows.has_value()), params)) {
+        ids.push_back(std::get<int64_t>(row[0]));
+    }
+    return ids;
+}
+
+} // namespace
+
+TEST(HistorySchemaTest, SchemaIsIdempotent)
+{
+    MemoryDatabase db;
+    db.createSchema();
+    // 每次打开连接都会重新执行建表语句
+    EXPECT_TRUE(db.execAll(HistorySchema::tableStatements())) << db.lastError();
+    EXPECT_TRUE(db.execAll(HistorySchema::aggregateStatements())) << db.lastError();
+    EXPECT_TRUE(db.execAll(HistorySchema::keyLifecycleStatements())) << db.lastError();
+    EXPECT_EQ(db.scalar("SELECT run_count FROM history_summary"), 0);
+}
+
+TEST(HistorySchemaTest, TriggersKeepAggregatesConsistent)
+{
+    MemoryDatabase db;
+    db.createSchema();
+
+    const int64_t first = db.insertRun("2026-10-01T08:00:00", 0, 0);
+    const int64_t second = db.insertRun("2026-10-01T09:00:00", 0, 0, "https://other.example.test");
+    const int64_t third = db.insertRun("2026-10-02T09:00:00", 0, 0);
+    expectAggregatesConsistent(db);
+
+    // 检测结束时把计数更新为最终结果
+    db.query(HistorySchema::updateRunSql(), {
+        std::string("2026-10-01T08:05:00"), int64_t(100), int64_t(60), int64_t(30), int64_t(10),
+        300.0, 0.33, first,
+    });
+    db.query(HistorySchema::updateRunSql(), {
+        std::string("2026-10-01T09:01:00"), int64_t(20), int64_t(5), int64_t(15), int64_t(0),
+        60.0, 0.33, second,
+    });
+    expectAggregatesConsistent(db);
+    EXPECT_EQ(db.scalar("SELECT total_keys FROM history_daily_stats WHERE day = '2026-10-01'"), 120);
+
+    db.query(HistorySchema::deleteRunSql(), {second});
+    db.query(HistorySchema::deleteRunSql(), {third});
+    expectAggregatesConsistent(db);
+    // 计数减到0的日期和端点行被删除
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM history_daily_stats"), 1);
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM history_endpoint_stats"), 1);
+}
+
+TEST(HistorySchemaTest, BackfillCountsExistingRuns)
+{
+    MemoryDatabase db;
+    ASSERT_TRUE(db.execAll(HistorySchema::tableStatements())) << db.lastError();
+    db.insertRun("2026-09-30T10:00:00", 40, 10);
+    db.insertRun("2026-10-01T10:00:00", 60, 50, "https://other.example.test");
+
+    ASSERT_TRUE(db.execAll(HistorySchema::aggregateStatements())) << db.lastError();
+    ASSERT_TRUE(db.execAll(HistorySchema::aggregateBackfillStatements())) << db.lastError();
+    expectAggregatesConsistent(db);
+    EXPECT_EQ(db.scalar("SELECT total_keys FROM history_summary"), 100);
+}
+
+TEST(HistorySchemaTest, KeyLifecycleMergeIgnoresWriteOrder)
+{
+    MemoryDatabase db;
+    db.createSchema();
+
+    const std::string upsert = HistorySchema::keyLifecycleUpsertSql();
+    auto record = [&](int64_t checkedAt, int64_t status) {
+        db.query(upsert, {
+            int64_t(7), std::string("sk-test"), checkedAt, checkedAt, status,
+            status == 0 ? Value(checkedAt) : Value(nullptr),
+            status == 1 ? Value(checkedAt) : Value(nullptr),
+        });
+    };
+    record(2000, 0);
+    record(3000, 1);
+    // 恢复的检测补写较早的结果，不应改变最后状态
+    record(1000, 0);
+
+    auto rows = db.query("SELECT first_seen, last_checked, last_status, last_valid, last_invalidated "
+                         "FROM key_lifecycle WHERE key_fp = 7");
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0], (std::vector<Value>{int64_t(1000), int64_t(3000), int64_t(1), int64_t(2000), int64_t(3000)}));
+}
+
+TEST(HistorySchemaTest, KeyLifecycleBackfillFromResults)
+{
+    MemoryDatabase db;
+    ASSERT_TRUE(db.execAll(HistorySchema::tableStatements())) << db.lastError();
+    const int64_t run = db.insertRun("2026-10-01T10:00:00", 2, 1);
+    db.insertResult(run, 1, "sk-a", 0, "有效", 1000);
+    db.insertResult(run, 2, "sk-b", 1, "认证失败", 1500);
+    const int64_t later = db.insertRun("2026-10-02T10:00:00", 1, 0);
+    db.insertResult(later, 1, "sk-a", 1, "认证失败", 2000);
+
+    ASSERT_TRUE(db.execAll(HistorySchema::keyLifecycleStatements())) << db.lastError();
+    ASSERT_TRUE(db.exec(HistorySchema::keyLifecycleBackfillSql())) << db.lastError();
+
+    auto rows = db.query("SELECT key_fp, first_seen, last_status, last_valid, last_invalidated "
+                         "FROM key_lifecycle ORDER BY key_fp");
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0], (std::vector<Value>{int64_t(1), int64_t(1000), int64_t(1), int64_t(1000), int64_t(2000)}));
+    EXPECT_EQ(rows[1], (std::vector<Value>{int64_t(2), int64_t(1500), int64_t(1), nullptr, int64_t(1500)}));
+}
+
+TEST(HistorySchemaTest, ResultUpsertKeepsFullTextIndexInSync)
+{
+    MemoryDatabase db;
+    db.createSchema();
+    if (!db.hasFullText()) {
+        GTEST_SKIP() << "SQLite未编译FTS5: " << db.lastError();
+    }
+
+    const int64_t run = db.insertRun("2026-10-01T10:00:00", 1, 0);
+    db.insertResult(run, 1, "sk-abcdef", 2, "连接超时");
+    // 同一次检测重复的key保留最后的结果，旧消息不能残留在索引中
+    db.insertResult(run, 1, "sk-abcdef", 1, "认证失败");
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM results"), 1);
+
+    const std::string match = "SELECT COUNT(*) FROM results_fts WHERE results_fts MATCH ?";
+    EXPECT_EQ(db.scalar(match, {std::string("\"认证失败\"")}), 1);
+    EXPECT_EQ(db.scalar(match, {std::string("\"连接超时\"")}), 0);
+    EXPECT_EQ(db.scalar(match, {std::string("\"abcd\"")}), 1);
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM history_fts WHERE history_fts MATCH ?",
+                        {std::string("\"keys.txt\"")}), 1);
+
+    // 删除检测时级联删除的结果同样从索引中移除
+    db.query(HistorySchema::deleteRunSql(), {run});
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM results"), 0);
+    EXPECT_EQ(db.scalar(match, {std::string("\"认证失败\"")}), 0);
+    EXPECT_TRUE(db.exec("INSERT INTO results_fts(results_fts) VALUES ('integrity-check')")) << db.lastError();
+}
+
+TEST(HistorySchemaTest, ChunkedDeleteRemovesOnlyOneRun)
+{
+    MemoryDatabase db;
+    db.createSchema();
+    const int64_t run = db.insertRun("2026-10-01T10:00:00", 5, 0);
+    const int64_t other = db.insertRun("2026-10-02T10:00:00", 1, 0);
+    for (int64_t fp = 0; fp < 5; ++fp) {
+        db.insertResult(run, fp, "sk-" + std::to_string(fp), 1, "认证失败");
+    }
+    db.insertResult(other, 0, "sk-0", 0, "有效");
+
+    const std::string chunk = HistorySchema::deleteResultsChunkSql();
+    db.query(chunk, {run, int64_t(2)});
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM results WHERE run_id = ?", {run}), 3);
+    db.query(chunk, {run, int64_t(2)});
+    db.query(chunk, {run, int64_t(2)});
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM results WHERE run_id = ?", {run}), 0);
+    EXPECT_EQ(db.scalar("SELECT COUNT(*) FROM results WHERE run_id = ?", {other}), 1);
+}
+
+TEST(HistorySchemaTest, RetentionSelectsExpiredRuns)
+{
+    MemoryDatabase db;
+    db.createSchema();
+    // id 1..5，开始时间递增，key数分别为 100, 200, 300, 400, 500
+    for (int64_t i = 1; i <= 5; ++i) {
+        db.insertRun("2026-10-0" + std::to_string(i) + "T10:00:00", i * 100, 0);
+    }
+
+    EXPECT_TRUE(HistorySchema::expiredRunsSql(false, false, false).empty());
+
+    EXPECT_EQ(expiredRuns(db, std::string("2026-10-03T00:00:00"), std::nullopt, std::nullopt),
+              (std::vector<int64_t>{1, 2}));
+    EXPECT_EQ(expiredRuns(db, std::nullopt, 3, std::nullopt), (std::vector<int64_t>{1, 2}));
+    EXPECT_EQ(expiredRuns(db, std::nullopt, 10, std::nullopt), std::vector<int64_t>{});
+
+    // 从最新的检测往前累计：500, 900, 1200 ...
+    EXPECT_EQ(expiredRuns(db, std::nullopt, std::nullopt, 1000), (std::vector<int64_t>{1, 2, 3}));
+    // 最新的一次检测即使超过上限也保留
+    EXPECT_EQ(expiredRuns(db, std::nullopt, std::nullopt, 100), (std::vector<int64_t>{1, 2, 3, 4}));
+
+    // 多个策略取并集，按 id 从旧到新
+    EXPECT_EQ(expiredRuns(db, std::string("2026-10-02T00:00:00"), 4, 1200), (std::vector<int64_t>{1, 2}));
+}
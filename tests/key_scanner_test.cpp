@@ -0,0 +1,383 @@
+#include "key_scanner.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace api_checker;
+
+namespace {
+
+// 单独编译的AVX2实现只能在支持AVX2的CPU上运行
+bool backend_supported() {
+#if defined(API_CHECKER_REQUIRES_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return true;
+#endif
+}
+
+class KeyScannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!backend_supported()) {
+            GTEST_SKIP() << "CPU不支持AVX2";
+        }
+    }
+};
+
+// 字符集内的确定性主体，不含任何前缀的开头两个字节组合
+std::string body(KeyCharset charset, size_t length, size_t seed = 0) {
+    static const std::string alnum = "aB3cD4eF5gH6jK7mN8pQ9rT0uV1wX2yZ";
+    static const std::string dash = "aB3-cD4_eF5gH6jK7mN8pQ9rT0uV1wX2";
+    static const std::string hex = "0123456789abcdefABCDEF";
+    const std::string& alphabet = charset == KeyCharset::Hex ? hex
+        : charset == KeyCharset::AlnumDashUnderscore ? dash : alnum;
+
+    std::string result;
+    result.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        result += alphabet[(i * 7 + seed) % alphabet.size()];
+    }
+    return result;
+}
+
+struct ProviderKey {
+    std::string provider;
+    std::string prefix;
+    std::string key;
+};
+
+// 每个内置格式一个合法的key
+std::vector<ProviderKey> provider_keys() {
+    return {
+        {"openai", "sk-proj-", "sk-proj-" + body(KeyCharset::AlnumDashUnderscore, 56)},
+        {"openai", "sk-svcacct-", "sk-svcacct-" + body(KeyCharset::AlnumDashUnderscore, 40)},
+        {"openai", "sk-admin-", "sk-admin-" + body(KeyCharset::AlnumDashUnderscore, 44)},
+        {"openai", "sk-", "sk-" + body(KeyCharset::Alnum, 48)},
+        {"anthropic", "sk-ant-api03-", "sk-ant-api03-" + body(KeyCharset::AlnumDashUnderscore, 95)},
+        {"openrouter", "sk-or-v1-", "sk-or-v1-" + body(KeyCharset::Hex, 64)},
+        {"google", "AIza", "AIza" + body(KeyCharset::AlnumDashUnderscore, 35)},
+        {"groq", "gsk_", "gsk_" + body(KeyCharset::Alnum, 52)},
+        {"xai", "xai-", "xai-" + body(KeyCharset::Alnum, 80)},
+        {"huggingface", "hf_", "hf_" + body(KeyCharset::Alnum, 34)},
+    };
+}
+
+using Match = std::tuple<std::string, size_t, std::string>;  // key, 偏移, 前缀
+
+std::vector<Match> scan(std::string_view text, bool skip_comments = true) {
+    std::vector<DetectedKey> found;
+    KeyScanner::instance().find(text, found, skip_comments);
+    std::vector<Match> matches;
+    for (const auto& item : found) {
+        matches.emplace_back(item.key, item.offset, item.pattern ? item.pattern->prefix : "");
+    }
+    return matches;
+}
+
+bool is_alnum(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// 逐个位置尝试所有格式的参考实现，用来核对自动机和向量化预过滤
+std::vector<Match> reference_scan(std::string_view text, bool skip_comments = true) {
+    const auto& patterns = KeyPatternRegistry::defaults().patterns();
+    std::vector<Match> matches;
+
+    size_t i = 0;
+    while (i < text.size()) {
+        if (i > 0 && is_alnum(text[i - 1])) {
+            ++i;
+            continue;
+        }
+
+        const KeyPattern* matched = nullptr;
+        size_t key_end = 0;
+        for (const auto& pattern : patterns) {  // 已按前缀长度降序排列
+            if (text.substr(i).substr(0, pattern.prefix.size()) != pattern.prefix) {
+                continue;
+            }
+            size_t end = i + pattern.prefix.size();
+            while (end < text.size() && KeyPatternRegistry::in_charset(text[end], pattern.charset)) {
+                ++end;
+            }
+            size_t length = end - i - pattern.prefix.size();
+            if (length < pattern.min_body || (pattern.max_body != 0 && length > pattern.max_body)) {
+                continue;
+            }
+            matched = &pattern;
+            key_end = end;
+            break;
+        }
+        if (!matched) {
+            ++i;
+            continue;
+        }
+
+        bool comment = false;
+        if (skip_comments) {
+            size_t line_begin = text.rfind('\n', i);
+            line_begin = line_begin == std::string_view::npos ? 0 : line_begin + 1;
+            while (line_begin < i && (text[line_begin] == ' ' || text[line_begin] == '\t' ||
+                                      text[line_begin] == '\r')) {
+                ++line_begin;
+            }
+            comment = text[line_begin] == '#';
+        }
+        if (!comment) {
+            matches.emplace_back(std::string(text.substr(i, key_end - i)), i, matched->prefix);
+        }
+        i = key_end;
+    }
+    return matches;
+}
+
+// 由key、前缀片段、分隔符和注释组成的随机文本
+std::string random_text(std::mt19937& rng, size_t pieces) {
+    const auto keys = provider_keys();
+    static const std::vector<std::string> noise = {
+        " ", "\n", "\r\n", "\t", ",", "\"", "=", "# ", "x", "_", "-", "sk", "sk-", "sk-proj",
+        "AIz", "gsk", "hf", "xai", "sk-or-v1-", "sk-ant-", "0123", "abcdef", "ZZ",
+    };
+
+    std::string text;
+    for (size_t i = 0; i < pieces; ++i) {
+        switch (rng() % 4) {
+            case 0: {
+                std::string key = keys[rng() % keys.size()].key;
+                // 偶尔截短或加长主体，覆盖长度上下限
+                if (rng() % 4 == 0) {
+                    key.resize(key.size() - rng() % 8);
+                } else if (rng() % 4 == 0) {
+                    key += body(KeyCharset::Alnum, rng() % 4, rng());
+                }
+                text += key;
+                break;
+            }
+            case 1:
+                text += body(static_cast<KeyCharset>(rng() % 3), rng() % 40, rng());
+                break;
+            default:
+                text += noise[rng() % noise.size()];
+                break;
+        }
+    }
+    return text;
+}
+
+} // namespace
+
+TEST_F(KeyScannerTest, BackendMatchesBuildVariant) {
+#ifdef API_CHECKER_EXPECTED_BACKEND
+    EXPECT_STREQ(KeyScanner::simd_backend(), API_CHECKER_EXPECTED_BACKEND);
+#else
+    GTEST_SKIP() << "默认构建使用 " << KeyScanner::simd_backend();
+#endif
+}
+
+TEST_F(KeyScannerTest, DetectsEveryBuiltinProvider) {
+    const auto& registry = KeyPatternRegistry::defaults();
+    for (const auto& expected : provider_keys()) {
+        SCOPED_TRACE(expected.prefix);
+        std::string text = "key: " + expected.key + "\n";
+
+        auto matches = scan(text);
+        ASSERT_EQ(matches.size(), 1u);
+        EXPECT_EQ(std::get<0>(matches[0]), expected.key);
+        EXPECT_EQ(std::get<1>(matches[0]), 5u);
+        EXPECT_EQ(std::get<2>(matches[0]), expected.prefix);
+
+        const KeyPattern* pattern = registry.classify(expected.key);
+        ASSERT_NE(pattern, nullptr);
+        EXPECT_EQ(pattern->provider, expected.provider);
+        EXPECT_EQ(pattern->prefix, expected.prefix);
+    }
+}
+
+TEST_F(KeyScannerTest, LongestPrefixWins) {
+    // sk-proj- 的主体含 - 和 _，不能被通用的 sk- 截成更短的key
+    const std::string key = "sk-proj-" + body(KeyCharset::AlnumDashUnderscore, 48);
+    auto matches = scan(key);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(std::get<0>(matches[0]), key);
+    EXPECT_EQ(std::get<2>(matches[0]), "sk-proj-");
+}
+
+TEST_F(KeyScannerTest, RejectsKeysPrecededByAlphanumeric) {
+    for (const auto& expected : provider_keys()) {
+        SCOPED_TRACE(expected.prefix);
+        EXPECT_TRUE(scan("x" + expected.key).empty());
+        EXPECT_TRUE(scan("9" + expected.key).empty());
+        // 非字母数字的字符可以紧挨着key
+        EXPECT_EQ(scan("\"" + expected.key + "\"").size(), 1u);
+        EXPECT_EQ(scan("_" + expected.key + ",").size(), 1u);
+    }
+}
+
+TEST_F(KeyScannerTest, RejectsBodiesOutsideLengthOrCharset) {
+    EXPECT_TRUE(scan("sk-" + body(KeyCharset::Alnum, 47)).empty());
+    EXPECT_TRUE(scan("sk-proj-" + body(KeyCharset::AlnumDashUnderscore, 39)).empty());
+    EXPECT_TRUE(scan("sk-ant-api03-" + body(KeyCharset::AlnumDashUnderscore, 79)).empty());
+    EXPECT_TRUE(scan("xai-" + body(KeyCharset::Alnum, 79)).empty());
+
+    // 固定长度的格式，主体更长时整个key不匹配，而不是截取一部分
+    EXPECT_TRUE(scan("AIza" + body(KeyCharset::AlnumDashUnderscore, 36)).empty());
+    EXPECT_TRUE(scan("gsk_" + body(KeyCharset::Alnum, 53)).empty());
+    EXPECT_TRUE(scan("hf_" + body(KeyCharset::Alnum, 35)).empty());
+    EXPECT_TRUE(scan("sk-or-v1-" + body(KeyCharset::Hex, 65)).empty());
+    EXPECT_TRUE(scan("hf_" + body(KeyCharset::Alnum, 33)).empty());
+
+    // openrouter 只接受十六进制主体
+    std::string openrouter = "sk-or-v1-" + body(KeyCharset::Hex, 64);
+    openrouter[20] = 'g';
+    EXPECT_TRUE(scan(openrouter).empty());
+
+    // 主体在字符集外的字符处结束
+    const std::string key = "sk-" + body(KeyCharset::Alnum, 48);
+    auto matches = scan(key + ".suffix");
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(std::get<0>(matches[0]), key);
+}
+
+TEST_F(KeyScannerTest, SkipsCommentLines) {
+    const std::string key = "sk-" + body(KeyCharset::Alnum, 48);
+    const std::string text = "# " + key + "\n  \t# " + key + "\nvalue # " + key + "\n" + key + "\n";
+
+    auto matches = scan(text);
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(std::get<1>(matches[0]), text.find("value # ") + 8);
+    EXPECT_EQ(std::get<1>(matches[1]), text.rfind(key));
+
+    EXPECT_EQ(scan(text, false).size(), 4u);
+}
+
+TEST_F(KeyScannerTest, KeysAcrossVectorBlockEdges) {
+    // key的起点、前缀和结尾落在16/32字节块的每一个位置上，包括恰好在文本末尾结束
+    for (const auto& expected : provider_keys()) {
+        SCOPED_TRACE(expected.prefix);
+        for (size_t lead = 0; lead < 70; ++lead) {
+            for (const std::string& tail : std::vector<std::string>{"", "\n", " x", std::string(33, ' ')}) {
+                const std::string text = std::string(lead, ' ') + expected.key + tail;
+                auto matches = scan(text);
+                ASSERT_EQ(matches.size(), 1u) << "lead=" << lead;
+                EXPECT_EQ(std::get<0>(matches[0]), expected.key);
+                EXPECT_EQ(std::get<1>(matches[0]), lead);
+            }
+            // 文本在前缀或主体中间结束
+            const std::string cut = std::string(lead, ' ') + expected.key.substr(0, expected.prefix.size() + 3);
+            EXPECT_TRUE(scan(cut).empty());
+        }
+    }
+}
+
+TEST_F(KeyScannerTest, MatchesReferenceImplementation) {
+    std::mt19937 rng(20261019);
+    for (int round = 0; round < 400; ++round) {
+        const std::string text = random_text(rng, 1 + rng() % 120);
+        SCOPED_TRACE(text);
+        EXPECT_EQ(scan(text), reference_scan(text));
+        EXPECT_EQ(scan(text, false), reference_scan(text, false));
+    }
+}
+
+TEST_F(KeyScannerTest, CompleteLinesLength) {
+    EXPECT_EQ(KeyScanner::complete_lines_length(""), 0u);
+    EXPECT_EQ(KeyScanner::complete_lines_length("partial"), 0u);
+    EXPECT_EQ(KeyScanner::complete_lines_length("a\nb"), 2u);
+    EXPECT_EQ(KeyScanner::complete_lines_length("a\nb\n"), 4u);
+}
+
+namespace {
+
+// 大于多个并行分块的文本，在2、3、4线程的名义切分点上各放一个横跨切分点的key，
+// 其中一个位于注释行；其余内容是带key的普通行
+std::string chunked_text(size_t total) {
+    const auto keys = provider_keys();
+    std::vector<size_t> splits;
+    for (size_t threads = 2; threads <= 4; ++threads) {
+        for (size_t i = 1; i < threads; ++i) {
+            splits.push_back(total / threads * i);
+        }
+    }
+    std::sort(splits.begin(), splits.end());
+    splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+
+    std::string text;
+    text.reserve(total);
+    size_t next_split = 0;
+    size_t line = 0;
+    while (text.size() + 400 < total) {
+        const std::string& key = keys[line % keys.size()].key;
+        if (next_split < splits.size() && text.size() + 300 >= splits[next_split]) {
+            // key从切分点之前10个字节开始
+            const size_t split = splits[next_split++];
+            const bool comment = next_split == 2;
+            std::string prefix = comment ? "# " : "";
+            text += prefix + std::string(split - 10 - text.size() - prefix.size(), ' ');
+            text += key + "\n";
+        } else {
+            text += "line " + std::to_string(line) + ": " + key + "\n";
+        }
+        ++line;
+    }
+    text += std::string(total - text.size() - 1, ' ') + "\n";
+    return text;
+}
+
+} // namespace
+
+TEST_F(KeyScannerTest, ParallelScanMatchesSingleThread) {
+    const std::string text = chunked_text(KeyScanner::MIN_PARALLEL_CHUNK * 4 + 777);
+    ASSERT_EQ(text.size(), KeyScanner::MIN_PARALLEL_CHUNK * 4 + 777);
+
+    std::vector<DetectedKey> expected;
+    KeyScanner::instance().find(text, expected);
+    ASSERT_GT(expected.size(), 100000u);
+
+    for (size_t threads : {2u, 3u, 4u, 0u}) {
+        SCOPED_TRACE(threads);
+        std::vector<DetectedKey> found;
+        EXPECT_EQ(KeyScanner::instance().find_parallel(text, found, threads), expected.size());
+        ASSERT_EQ(found.size(), expected.size());
+        for (size_t i = 0; i < found.size(); ++i) {
+            if (found[i].key != expected[i].key || found[i].offset != expected[i].offset ||
+                found[i].pattern != expected[i].pattern) {
+                ADD_FAILURE() << "第" << i << "个key不同，偏移 " << found[i].offset
+                              << " / " << expected[i].offset;
+                break;
+            }
+        }
+    }
+
+    // 横跨切分点的key都被完整识别，注释行中的除外
+    for (size_t threads = 2; threads <= 4; ++threads) {
+        for (size_t i = 1; i < threads; ++i) {
+            const size_t split = text.size() / threads * i;
+            const size_t line_begin = text.rfind('\n', split) + 1;
+            const bool comment = text[line_begin] == '#';
+            const bool spanned = std::any_of(expected.begin(), expected.end(), [&](const DetectedKey& key) {
+                return key.offset < split && key.offset + key.key.size() > split;
+            });
+            EXPECT_EQ(spanned, !comment) << "threads=" << threads << " split=" << split;
+        }
+    }
+
+    std::vector<std::string> keys;
+    std::vector<std::string> parallel_keys;
+    KeyScanner::scan(text, keys);
+    KeyScanner::scan_parallel(text, parallel_keys, 3);
+    EXPECT_EQ(parallel_keys, keys);
+}
+
+TEST_F(KeyScannerTest, SmallTextScansOnOneThread) {
+    const std::string key = "sk-" + body(KeyCharset::Alnum, 48);
+    const std::string text = key + "\n# " + key + "\n" + key;
+
+    std::vector<DetectedKey> found;
+    EXPECT_EQ(KeyScanner::instance().find_parallel(text, found, 8), 2u);
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[1].offset, text.rfind(key));
+}
@@ -0,0 +1,37 @@
+#include "progress_index.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <fstream>
+
+using namespace api_checker;
+
+namespace {
+
+void write_text(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+} // namespace
+
+// 无法解析的旧版JSON进度文件只在第一次扫描时解析和报错，文件变化后才重新解析
+TEST(ProgressIndexTest, UnreadableLegacyFileIsReportedOnce) {
+    test::TempDir dir;
+    const std::string bad = dir.file("progress_broken.json");
+    write_text(bad, "{ not json");
+
+    testing::internal::CaptureStderr();
+    auto first = ProgressIndex::refresh(dir.path().string());
+    std::string first_errors = testing::internal::GetCapturedStderr();
+    EXPECT_TRUE(first.empty());
+    EXPECT_FALSE(first_errors.empty());
+
+    testing::internal::CaptureStderr();
+    auto second = ProgressIndex::refresh(dir.path().string());
+    EXPECT_TRUE(second.empty());
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+
+    write_text(bad, "{ still not json, but longer");
+    testing::internal::CaptureStderr();
+    ProgressIndex::refresh(dir.path().string());
+    EXPECT_FALSE(testing::internal::GetCapturedStderr().empty());
+}
@@ -0,0 +1,351 @@
+#include "api_checker.h"
+#include "completion_bitmap.h"
+#include "progress_journal.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace api_checker;
+
+namespace {
+
+constexpr size_t RECORD_SIZE = 24;
+
+JournalHeader make_header(size_t key_count, const std::string& prefix = "key-") {
+    JournalHeader header;
+    header.session_id = "session_test";
+    header.input_file = "test input";
+    for (size_t i = 0; i < key_count; ++i) {
+        header.keys.push_back(prefix + std::to_string(i));
+    }
+    header.key_count = key_count;
+    header.fingerprint = ProgressJournal::fingerprint(header.keys);
+    header.concurrent = 8;
+    header.timeout = 3;
+    header.created_at = std::chrono::system_clock::time_point(std::chrono::milliseconds(1700000000000));
+    return header;
+}
+
+JournalRecord make_record(uint32_t ordinal, KeyStatus status, int64_t checked_at_ms = 1700000000000) {
+    JournalRecord record;
+    record.ordinal = ordinal;
+    record.status = status;
+    record.message_code = status == KeyStatus::Valid ? MessageCode::Valid : MessageCode::AuthFailed;
+    record.http_status = status == KeyStatus::Valid ? 200 : 401;
+    record.response_ms = 42;
+    record.checked_at_ms = checked_at_ms;
+    return record;
+}
+
+void write_journal(const std::string& path, const JournalHeader& header,
+                   const std::vector<JournalRecord>& records) {
+    JournalOptions options;
+    options.sync = false;
+    ProgressJournal journal;
+    ASSERT_TRUE(journal.create(path, header, options));
+    for (const auto& record : records) {
+        journal.append(record);
+    }
+    journal.close();
+}
+
+void append_bytes(const std::string& path, const std::string& bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::app) << bytes;
+}
+
+void flip_byte(const std::string& path, size_t offset) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    char byte = 0;
+    file.read(&byte, 1);
+    byte = static_cast<char>(byte ^ 0x5A);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(&byte, 1);
+}
+
+} // namespace
+
+TEST(CompletionBitmapTest, TracksCompletedPositions) {
+    CompletionBitmap bitmap(130);
+    EXPECT_TRUE(bitmap.set(0));
+    EXPECT_TRUE(bitmap.set(64));
+    EXPECT_TRUE(bitmap.set(129));
+    EXPECT_FALSE(bitmap.set(64));
+    EXPECT_EQ(bitmap.count(), 3u);
+    EXPECT_TRUE(bitmap.test(129));
+    EXPECT_FALSE(bitmap.test(128));
+
+    auto pending = bitmap.unset_positions();
+    EXPECT_EQ(pending.size(), 127u);
+    EXPECT_EQ(pending.front(), 1u);
+    EXPECT_EQ(pending.back(), 128u);
+
+    auto restored = CompletionBitmap::from_words(bitmap.size(), bitmap.words());
+    EXPECT_EQ(restored.count(), 3u);
+    EXPECT_TRUE(restored.test(64));
+}
+
+TEST(ProgressJournalTest, ReplayRestoresHeaderAndLatestRecords) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_a.journal");
+
+    JournalHeader header = make_header(5);
+    header.request = JournalRequest{"https://example.test/v1/models", "POST", "X-Test: 1", "{}"};
+    write_journal(path, header, {
+        make_record(0, KeyStatus::Valid),
+        make_record(3, KeyStatus::Invalid),
+        make_record(0, KeyStatus::Error),
+    });
+
+    auto state = ProgressJournal::replay(path);
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->header.session_id, "session_test");
+    EXPECT_EQ(state->header.keys, header.keys);
+    EXPECT_EQ(state->header.fingerprint, header.fingerprint);
+    EXPECT_EQ(state->header.concurrent, 8u);
+    EXPECT_EQ(state->header.created_at, header.created_at);
+    ASSERT_TRUE(state->header.request);
+    EXPECT_EQ(*state->header.request, *header.request);
+    EXPECT_EQ(state->raw_records, 3u);
+    EXPECT_EQ(state->torn_bytes, 0u);
+
+    // 同一序号以最后写入的记录为准
+    ASSERT_EQ(state->records.size(), 2u);
+    EXPECT_EQ(state->records[0].ordinal, 0u);
+    EXPECT_EQ(state->records[0].status, KeyStatus::Error);
+    EXPECT_EQ(state->records[1].ordinal, 3u);
+    EXPECT_EQ(state->records[1].http_status, 401);
+
+    auto header_only = ProgressJournal::read_header(path);
+    ASSERT_TRUE(header_only);
+    EXPECT_EQ(header_only->key_count, 5u);
+    EXPECT_TRUE(header_only->keys.empty());
+}
+
+TEST(ProgressJournalTest, JournalWithoutRequestHasNoRequest) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_b.journal");
+    write_journal(path, make_header(2), {make_record(1, KeyStatus::Valid)});
+
+    auto state = ProgressJournal::replay(path);
+    ASSERT_TRUE(state);
+    EXPECT_FALSE(state->header.request);
+}
+
+TEST(ProgressJournalTest, TornTailIsDroppedAndTruncatedOnOpen) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_torn.journal");
+    write_journal(path, make_header(4), {make_record(0, KeyStatus::Valid), make_record(1, KeyStatus::Valid)});
+    const auto intact_size = std::filesystem::file_size(path);
+
+    append_bytes(path, std::string(RECORD_SIZE / 2, '\x7f'));
+
+    auto state = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->records.size(), 2u);
+    EXPECT_EQ(state->torn_bytes, RECORD_SIZE / 2);
+    EXPECT_EQ(state->valid_bytes, intact_size);
+
+    JournalOptions options;
+    options.sync = false;
+    ProgressJournal journal;
+    ASSERT_TRUE(journal.open(path, options));
+    journal.append(make_record(2, KeyStatus::Invalid));
+    journal.close();
+
+    state = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->records.size(), 3u);
+    EXPECT_EQ(state->torn_bytes, 0u);
+}
+
+TEST(ProgressJournalTest, CorruptRecordStopsReplay) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_crc.journal");
+    write_journal(path, make_header(4), {
+        make_record(0, KeyStatus::Valid),
+        make_record(1, KeyStatus::Valid),
+        make_record(2, KeyStatus::Valid),
+    });
+
+    auto state = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(state);
+    // 破坏第二条记录的状态字节，CRC不再匹配
+    flip_byte(path, state->records_offset + RECORD_SIZE + 4);
+
+    state = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(state);
+    ASSERT_EQ(state->records.size(), 1u);
+    EXPECT_EQ(state->records[0].ordinal, 0u);
+    EXPECT_EQ(state->torn_bytes, RECORD_SIZE * 2);
+}
+
+TEST(ProgressJournalTest, CorruptHeaderIsRejected) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_header.journal");
+    write_journal(path, make_header(3), {make_record(0, KeyStatus::Valid)});
+
+    flip_byte(path, 20);
+    EXPECT_FALSE(ProgressJournal::replay(path));
+    EXPECT_FALSE(ProgressJournal::read_header(path));
+}
+
+TEST(ProgressJournalTest, OversizedHeaderLengthIsRejected) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_oversized.journal");
+    write_journal(path, make_header(3), {make_record(0, KeyStatus::Valid)});
+
+    // 元数据长度字段改为接近4GB，远超文件大小
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(12);
+    const char huge[4] = {'\xf0', '\xff', '\xff', '\xff'};
+    file.write(huge, sizeof(huge));
+    file.close();
+
+    EXPECT_FALSE(ProgressJournal::read_header(path));
+    EXPECT_FALSE(ProgressJournal::replay(path));
+}
+
+TEST(ProgressJournalTest, ReplayFromOffsetReadsOnlyLaterRecords) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_offset.journal");
+    write_journal(path, make_header(4), {make_record(0, KeyStatus::Valid), make_record(1, KeyStatus::Invalid)});
+
+    auto full = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(full);
+    auto tail = ProgressJournal::replay(path, false, full->records_offset + RECORD_SIZE);
+    ASSERT_TRUE(tail);
+    EXPECT_EQ(tail->replayed_from, full->records_offset + RECORD_SIZE);
+    ASSERT_EQ(tail->records.size(), 1u);
+    EXPECT_EQ(tail->records[0].ordinal, 1u);
+}
+
+TEST(ProgressJournalTest, CompactRemovesDuplicatesAndStaleSidecar) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress_compact.journal");
+    write_journal(path, make_header(3), {
+        make_record(0, KeyStatus::Error),
+        make_record(0, KeyStatus::Valid),
+        make_record(2, KeyStatus::Invalid),
+    });
+
+    CompletionSidecar sidecar;
+    sidecar.bitmap = CompletionBitmap(3);
+    ASSERT_TRUE(sidecar.save(ProgressJournal::sidecar_path(path)));
+
+    ASSERT_TRUE(ProgressJournal::compact(path));
+    EXPECT_FALSE(std::filesystem::exists(ProgressJournal::sidecar_path(path)));
+
+    auto state = ProgressJournal::replay(path, false);
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->raw_records, 2u);
+    EXPECT_EQ(state->records[0].status, KeyStatus::Valid);
+}
+
+TEST(CompletionSidecarTest, RoundTripsAndRejectsCorruption) {
+    test::TempDir dir;
+    const std::string path = dir.file("progress.journal.bitmap");
+
+    CompletionSidecar sidecar;
+    sidecar.bitmap = CompletionBitmap(200);
+    sidecar.bitmap.set(3);
+    sidecar.bitmap.set(199);
+    sidecar.fingerprint = 0x1234567890abcdefull;
+    sidecar.journal_bytes = 4096;
+    sidecar.valid = 1;
+    sidecar.invalid = 1;
+    ASSERT_TRUE(sidecar.save(path));
+
+    auto loaded = CompletionSidecar::load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->fingerprint, sidecar.fingerprint);
+    EXPECT_EQ(loaded->journal_bytes, 4096u);
+    EXPECT_EQ(loaded->valid, 1u);
+    EXPECT_EQ(loaded->invalid, 1u);
+    EXPECT_EQ(loaded->bitmap.size(), 200u);
+    EXPECT_EQ(loaded->bitmap.count(), 2u);
+    EXPECT_TRUE(loaded->bitmap.test(199));
+
+    flip_byte(path, 40);
+    EXPECT_FALSE(CompletionSidecar::load(path));
+}
+
+TEST(MergeProgressTest, MergesLatestResultsAndSkipsMismatchedFiles) {
+    test::TempDir dir;
+    const std::string first = dir.file("progress_1.journal");
+    const std::string second = dir.file("progress_2.journal");
+    const std::string other_input = dir.file("progress_3.journal");
+    const std::string other_request = dir.file("progress_4.journal");
+    const std::string output = dir.file("progress_merged.journal");
+
+    write_journal(first, make_header(4), {
+        make_record(0, KeyStatus::Error, 1000),
+        make_record(1, KeyStatus::Valid, 1000),
+    });
+    write_journal(second, make_header(4), {
+        make_record(0, KeyStatus::Valid, 2000),
+        make_record(2, KeyStatus::Invalid, 2000),
+    });
+    write_journal(other_input, make_header(4, "other-"), {make_record(3, KeyStatus::Valid)});
+    JournalHeader with_request = make_header(4);
+    with_request.request = JournalRequest{"https://example.test", "GET", "", ""};
+    write_journal(other_request, with_request, {make_record(3, KeyStatus::Valid)});
+
+    testing::internal::CaptureStderr();
+    auto merged = APIKeyChecker::merge_progress_files({first, second, other_input, other_request}, output);
+    std::string skipped = testing::internal::GetCapturedStderr();
+    ASSERT_TRUE(merged);
+    EXPECT_EQ(*merged, output);
+    EXPECT_NE(skipped.find("progress_3.journal"), std::string::npos);
+    EXPECT_NE(skipped.find("progress_4.journal"), std::string::npos);
+
+    auto state = ProgressJournal::replay(output);
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->header.keys, make_header(4).keys);
+    ASSERT_EQ(state->records.size(), 3u);
+    // 同一key以检测时间最新的结果为准
+    EXPECT_EQ(state->records[0].status, KeyStatus::Valid);
+    EXPECT_EQ(state->records[1].ordinal, 1u);
+    EXPECT_EQ(state->records[2].ordinal, 2u);
+
+    // 被合并的文件已删除，跳过的文件保留；同时写出与日志一致的位图侧文件
+    EXPECT_FALSE(std::filesystem::exists(first));
+    EXPECT_FALSE(std::filesystem::exists(second));
+    EXPECT_TRUE(std::filesystem::exists(other_input));
+    EXPECT_TRUE(std::filesystem::exists(other_request));
+
+    auto sidecar = CompletionSidecar::load(ProgressJournal::sidecar_path(output));
+    ASSERT_TRUE(sidecar);
+    EXPECT_EQ(sidecar->bitmap.count(), 3u);
+    EXPECT_EQ(sidecar->valid, 2u);
+    EXPECT_EQ(sidecar->journal_bytes, std::filesystem::file_size(output));
+}
+
+TEST(ProgressJournalTest, InputFileIsStoredAsAbsolutePath) {
+    test::TempDir dir;
+    const std::vector<std::string> keys = {
+        "sk-" + std::string(48, 'a'),
+        "sk-" + std::string(48, 'b'),
+    };
+    std::ofstream(dir.file("keys.txt")) << keys[0] << '\n' << keys[1] << '\n';
+
+    // 以相对路径保存，切换工作目录后仍能按日志头找到输入文件
+    const auto previous = std::filesystem::current_path();
+    std::filesystem::current_path(dir.path());
+    CheckProgress progress;
+    progress.session_id = "session_test";
+    progress.input_file = "./sub/../keys.txt";
+    progress.all_keys = keys;
+    progress.completed = CompletionBitmap(2);
+    APIKeyChecker checker;
+    const bool saved = checker.save_progress(progress, dir.file("progress_abs.journal"));
+    std::filesystem::current_path(previous);
+    ASSERT_TRUE(saved);
+
+    auto header = ProgressJournal::read_header(dir.file("progress_abs.journal"));
+    ASSERT_TRUE(header);
+    EXPECT_TRUE(std::filesystem::path(header->input_file).is_absolute());
+    EXPECT_TRUE(std::filesystem::equivalent(header->input_file, dir.file("keys.txt")));
+    EXPECT_TRUE(header->keys_external);
+}
@@ -0,0 +1,140 @@
+#include "result_store.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace api_checker;
+
+namespace {
+
+KeyResult make_result(size_t i) {
+    KeyResult result;
+    result.key = "sk-test-" + std::to_string(i);
+    result.status = static_cast<KeyStatus>(i % 3);
+    result.message_code = MessageCode::None;
+    result.http_status = static_cast<uint16_t>(200 + i % 300);
+    result.checked_at = std::chrono::system_clock::time_point(std::chrono::milliseconds(1700000000000 + i));
+    if (i % 5 != 0) {
+        result.response_time = std::chrono::milliseconds(i % 1000);
+    }
+    return result;
+}
+
+// 写入rows行并关闭
+void write_store(const std::string& path, size_t rows) {
+    ResultStoreWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    for (size_t i = 0; i < rows; ++i) {
+        writer.append(make_result(i));
+    }
+    writer.close();
+}
+
+void flip_byte(const std::string& path, size_t offset) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    char byte = 0;
+    file.read(&byte, 1);
+    byte = static_cast<char>(byte ^ 0x5A);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(&byte, 1);
+}
+
+} // namespace
+
+TEST(ResultStoreTest, RoundTripsEveryColumn) {
+    test::TempDir dir;
+    const std::string path = dir.file("results.apcr");
+    const size_t rows = ResultStoreWriter::ROWS_PER_BLOCK * 2 + 17;
+    write_store(path, rows);
+
+    ResultStoreReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.size(), rows);
+    EXPECT_EQ(reader.torn_bytes(), 0u);
+
+    for (size_t i = 0; i < rows; i += 97) {
+        KeyResult expected = make_result(i);
+        EXPECT_EQ(reader.key(i), expected.key);
+        EXPECT_EQ(reader.status(i), expected.status);
+        EXPECT_EQ(reader.http_status(i), expected.http_status);
+        EXPECT_EQ(reader.response_time(i), expected.response_time);
+        EXPECT_EQ(reader.checked_at(i), expected.checked_at);
+        EXPECT_TRUE(reader.intact(i));
+    }
+
+    size_t valid = (rows + 2) / 3;
+    EXPECT_EQ(reader.count(KeyStatus::Valid), valid);
+    EXPECT_EQ(reader.rows_with_status(KeyStatus::Valid).size(), valid);
+}
+
+TEST(ResultStoreTest, FlushedPartialBlocksAreReadable) {
+    test::TempDir dir;
+    const std::string path = dir.file("partial.apcr");
+
+    ResultStoreWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    for (size_t i = 0; i < 10; ++i) {
+        writer.append(make_result(i));
+    }
+    ASSERT_TRUE(writer.flush());
+    for (size_t i = 10; i < 25; ++i) {
+        writer.append(make_result(i));
+    }
+    writer.close();
+
+    ResultStoreReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.size(), 25u);
+    EXPECT_EQ(reader.key(9), make_result(9).key);
+    EXPECT_EQ(reader.key(10), make_result(10).key);
+    EXPECT_EQ(reader.key(24), make_result(24).key);
+}
+
+TEST(ResultStoreTest, TruncatedTailIsIgnored) {
+    test::TempDir dir;
+    const std::string path = dir.file("torn.apcr");
+    write_store(path, ResultStoreWriter::ROWS_PER_BLOCK + 100);
+
+    auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 10);
+
+    ResultStoreReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.size(), ResultStoreWriter::ROWS_PER_BLOCK);
+    EXPECT_GT(reader.torn_bytes(), 0u);
+}
+
+// 块数据在打开时不校验，第一次访问时发现损坏，只影响该块的行
+TEST(ResultStoreTest, CorruptBlockIsDetectedLazily) {
+    test::TempDir dir;
+    const std::string path = dir.file("corrupt.apcr");
+    const size_t block_rows = ResultStoreWriter::ROWS_PER_BLOCK;
+    const size_t rows = block_rows * 3;
+    write_store(path, rows);
+
+    // 文件头16字节，块头16字节，块数据为每行20字节定长列加key数据，按8字节对齐
+    size_t first_blob = 0;
+    for (size_t i = 0; i < block_rows; ++i) {
+        first_blob += make_result(i).key.size();
+    }
+    const size_t first_body = (block_rows * 20 + first_blob + 7) / 8 * 8;
+    const size_t second_body_offset = 16 + 16 + first_body + 16;
+    flip_byte(path, second_body_offset + 3);
+
+    ResultStoreReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.size(), rows);
+    EXPECT_EQ(reader.torn_bytes(), 0u);
+
+    const size_t in_second = block_rows + 5;
+    EXPECT_TRUE(reader.intact(0));
+    EXPECT_FALSE(reader.intact(in_second));
+    EXPECT_TRUE(reader.key(in_second).empty());
+    EXPECT_EQ(reader.status(in_second), KeyStatus::Pending);
+    EXPECT_TRUE(reader.intact(rows - 1));
+    EXPECT_EQ(reader.key(rows - 1), make_result(rows - 1).key);
+    EXPECT_EQ(reader.count(KeyStatus::Pending), block_rows);
+    EXPECT_EQ(reader.rows_with_status(KeyStatus::Pending).front(), block_rows);
+}
@@ -0,0 +1,238 @@
+#include "tail_follower.h"
+#include "test_support.h"
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace api_checker;
+
+namespace {
+
+constexpr auto WAIT_DEADLINE = std::chrono::seconds(10);
+// 检查"没有新key"时等待的时间，只可能漏报不会误报
+constexpr auto QUIET_PERIOD = std::chrono::milliseconds(300);
+
+std::string make_key(int i) {
+    std::string number = std::to_string(i);
+    return "sk-" + std::string(48 - number.size(), 'a') + number;
+}
+
+void append(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary | std::ios::app) << text;
+}
+
+TailOptions fast_options(const test::TempDir& dir) {
+    TailOptions options;
+    options.offsets_file = dir.file("offsets");
+    options.poll_interval = std::chrono::milliseconds(20);
+    options.save_interval = std::chrono::milliseconds(0);
+    return options;
+}
+
+// 在后台线程运行跟随器，收集回调的key；auto_ack 为true时回调中立即确认
+class FollowerRun {
+public:
+    FollowerRun(const std::string& path, TailOptions options, bool auto_ack = true)
+        : follower_(path, std::move(options)), auto_ack_(auto_ack) {
+        thread_ = std::thread([this]() {
+            follower_.run([this](TailKey key) {
+                if (auto_ack_) {
+                    follower_.acknowledge(key.ticket);
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                keys_.push_back(std::move(key));
+                cv_.notify_all();
+                return true;
+            });
+        });
+    }
+
+    ~FollowerRun() { stop(); }
+
+    FollowerRun(const FollowerRun&) = delete;
+    FollowerRun& operator=(const FollowerRun&) = delete;
+
+    // 等待累计收到count个key，超时返回false
+    bool wait_for(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, WAIT_DEADLINE, [&]() { return keys_.size() >= count; });
+    }
+
+    std::vector<TailKey> keys() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return keys_;
+    }
+
+    std::vector<std::string> key_strings() {
+        std::vector<std::string> result;
+        for (const auto& key : keys()) {
+            result.push_back(key.key);
+        }
+        return result;
+    }
+
+    void acknowledge(uint64_t ticket) { follower_.acknowledge(ticket); }
+
+    // 停止并等待run()返回；跟随器析构时保存最终的偏移
+    void stop() {
+        follower_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    TailFollower follower_;
+    bool auto_ack_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<TailKey> keys_;
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST(TailFollowerTest, ReportsAppendedCompleteLines) {
+    test::TempDir dir;
+    const std::string path = dir.file("app.log");
+    append(path, "start " + make_key(1) + "\n");
+
+    FollowerRun run(path, fast_options(dir));
+    ASSERT_TRUE(run.wait_for(1));
+    EXPECT_EQ(run.keys()[0].key, make_key(1));
+    EXPECT_EQ(run.keys()[0].source, path + ":1");
+
+    // 没有换行结尾的行等写完再处理
+    append(path, "next " + make_key(2));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    EXPECT_EQ(run.keys().size(), 1u);
+
+    append(path, " tail\n\n" + make_key(3) + "\n");
+    ASSERT_TRUE(run.wait_for(3));
+    auto keys = run.keys();
+    EXPECT_EQ(keys[1].key, make_key(2));
+    EXPECT_EQ(keys[1].source, path + ":2");
+    EXPECT_EQ(keys[2].source, path + ":4");
+}
+
+TEST(TailFollowerTest, ResumesFromAcknowledgedOffset) {
+    test::TempDir dir;
+    const std::string path = dir.file("app.log");
+    append(path, make_key(1) + "\n" + make_key(2) + "\n");
+
+    {
+        FollowerRun run(path, fast_options(dir));
+        ASSERT_TRUE(run.wait_for(2));
+    }
+
+    append(path, make_key(3) + "\n");
+    FollowerRun resumed(path, fast_options(dir));
+    ASSERT_TRUE(resumed.wait_for(1));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    auto keys = resumed.keys();
+    ASSERT_EQ(keys.size(), 1u);
+    EXPECT_EQ(keys[0].key, make_key(3));
+    EXPECT_EQ(keys[0].source, path + ":3");
+}
+
+TEST(TailFollowerTest, OffsetStopsAtFirstUnacknowledgedKey) {
+    test::TempDir dir;
+    const std::string path = dir.file("app.log");
+    append(path, make_key(1) + "\n" + make_key(2) + "\n" + make_key(3) + "\n");
+
+    {
+        // 只确认第1和第3个key：偏移停在第2个key之前
+        FollowerRun run(path, fast_options(dir), false);
+        ASSERT_TRUE(run.wait_for(3));
+        auto keys = run.keys();
+        run.acknowledge(keys[0].ticket);
+        run.acknowledge(keys[2].ticket);
+    }
+
+    FollowerRun resumed(path, fast_options(dir));
+    ASSERT_TRUE(resumed.wait_for(2));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    EXPECT_EQ(resumed.key_strings(), (std::vector<std::string>{make_key(2), make_key(3)}));
+}
+
+TEST(TailFollowerTest, RestartsFromBeginningAfterTruncation) {
+    test::TempDir dir;
+    const std::string path = dir.file("app.log");
+    append(path, "old " + make_key(1) + "\nold " + make_key(2) + "\n");
+
+    FollowerRun run(path, fast_options(dir));
+    ASSERT_TRUE(run.wait_for(2));
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << make_key(3) + "\n";
+    ASSERT_TRUE(run.wait_for(3));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    auto keys = run.keys();
+    ASSERT_EQ(keys.size(), 3u);
+    EXPECT_EQ(keys[2].key, make_key(3));
+    EXPECT_EQ(keys[2].source, path + ":1");
+}
+
+#ifndef _WIN32
+TEST(TailFollowerTest, FinishesRotatedFileThenFollowsNewOne) {
+    test::TempDir dir;
+    const std::string path = dir.file("app.log");
+    append(path, make_key(1) + "\n");
+
+    FollowerRun run(path, fast_options(dir));
+    ASSERT_TRUE(run.wait_for(1));
+
+    // 轮转前最后写入的行也要读到，新文件从头读取
+    append(path, make_key(2) + "\n");
+    std::filesystem::rename(path, dir.file("app.log.1"));
+    append(path, make_key(3) + "\n");
+
+    ASSERT_TRUE(run.wait_for(3));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    EXPECT_EQ(run.key_strings(), (std::vector<std::string>{make_key(1), make_key(2), make_key(3)}));
+    EXPECT_EQ(run.keys()[2].source, path + ":1");
+}
+
+TEST(TailFollowerTest, RenamedFileInDirectoryIsNotReread) {
+    test::TempDir dir;
+    const std::string logs = dir.file("logs");
+    std::filesystem::create_directories(logs);
+    const std::string path = logs + "/a.log";
+    const std::string renamed = logs + "/a.log.1";
+    append(path, make_key(1) + "\n");
+
+    FollowerRun run(logs, fast_options(dir));
+    ASSERT_TRUE(run.wait_for(1));
+
+    std::filesystem::rename(path, renamed);
+    append(renamed, make_key(2) + "\n");
+
+    ASSERT_TRUE(run.wait_for(2));
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    auto keys = run.keys();
+    ASSERT_EQ(keys.size(), 2u);
+    EXPECT_EQ(keys[1].key, make_key(2));
+    EXPECT_EQ(keys[1].source, renamed + ":2");
+}
+#endif
+
+TEST(TailFollowerTest, FollowsNewFilesInDirectory) {
+    test::TempDir dir;
+    const std::string logs = dir.file("logs");
+    std::filesystem::create_directories(logs);
+
+    FollowerRun run(logs, fast_options(dir));
+    append(logs + "/b.log", make_key(1) + "\n");
+    ASSERT_TRUE(run.wait_for(1));
+    EXPECT_EQ(run.keys()[0].source, logs + "/b.log:1");
+}
+
+TEST(TailFollowerTest, MissingPathFails) {
+    test::TempDir dir;
+    TailFollower follower(dir.file("missing.log"), fast_options(dir));
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(follower.run([](TailKey) { return true; }));
+    testing::internal::GetCapturedStderr();
+}